@@ -0,0 +1,56 @@
+// drv_mmio.h
+// Register access for the reference drivers (spi_drv, qspi_drv).
+//
+// The drivers never touch a device address themselves: every access goes
+// through a drv_mmio, so the same source runs on a target and against the
+// Verilator models. drv_mmio_direct() maps the callbacks to volatile
+// loads and stores at `base`; a harness installs callbacks that run APB
+// cycles on the model instead (see opencores/sim/sim_chisel_spi.cpp and
+// sim_qspi_psram.cpp).
+//
+// Offsets are byte offsets from the device base. write16 / write8 store
+// the low bits of `val` at `off` like a narrow CPU store (APB pstrb
+// selects the lanes).
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct drv_mmio {
+  uint32_t (*read32)(void *ctx, uint32_t off);
+  void (*write32)(void *ctx, uint32_t off, uint32_t val);
+  void (*write16)(void *ctx, uint32_t off, uint16_t val);
+  void (*write8)(void *ctx, uint32_t off, uint8_t val);
+  void *ctx;
+} drv_mmio;
+
+static inline uint32_t drv_direct_read32(void *ctx, uint32_t off) {
+  return *(volatile uint32_t *)((uintptr_t)ctx + off);
+}
+
+static inline void drv_direct_write32(void *ctx, uint32_t off, uint32_t val) {
+  *(volatile uint32_t *)((uintptr_t)ctx + off) = val;
+}
+
+static inline void drv_direct_write16(void *ctx, uint32_t off, uint16_t val) {
+  *(volatile uint16_t *)((uintptr_t)ctx + off) = val;
+}
+
+static inline void drv_direct_write8(void *ctx, uint32_t off, uint8_t val) {
+  *(volatile uint8_t *)((uintptr_t)ctx + off) = val;
+}
+
+// Plain memory-mapped access to a device at `base`
+static inline drv_mmio drv_mmio_direct(uintptr_t base) {
+  drv_mmio io = {drv_direct_read32, drv_direct_write32, drv_direct_write16,
+                 drv_direct_write8, (void *)base};
+  return io;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,99 @@
+// qspi_drv.c
+// Reference driver for the Chisel QSPI master, see qspi_drv.h.
+
+#include "qspi_drv.h"
+
+#define RD(d, off)      ((d)->io.read32((d)->io.ctx, (off)))
+#define WR(d, off, val) ((d)->io.write32((d)->io.ctx, (off), (val)))
+
+void qspi_init(qspi_dev *d, const drv_mmio *io, uint32_t burst, uint32_t pipe) {
+  d->io = *io;
+  d->burst = burst;
+  d->last = 0;
+  WR(d, QSPI_CSR_PIPE, pipe);
+  WR(d, QSPI_CSR_BURST, burst);
+}
+
+uint32_t qspi_read32(qspi_dev *d, uint32_t addr) { return RD(d, addr); }
+
+void qspi_write32(qspi_dev *d, uint32_t addr, uint32_t val) {
+  WR(d, addr, val);
+  d->last = addr;
+}
+
+// A read waits behind posted writes, so reading any address drains them
+void qspi_fence(qspi_dev *d) { (void)RD(d, d->last & ~3u); }
+
+// Writing BURST back to d->burst leaves a burst open until the next
+// memory access, which closes it.
+static void qspi_burst(qspi_dev *d, uint32_t on) {
+  if ((d->burst | on) != d->burst) WR(d, QSPI_CSR_BURST, d->burst | on);
+}
+
+static void qspi_burst_end(qspi_dev *d, uint32_t on) {
+  if ((d->burst | on) != d->burst) WR(d, QSPI_CSR_BURST, d->burst);
+}
+
+// ─── PSRAM → host ──────────────────────────────────────────────
+
+void qspi_memcpy_from(qspi_dev *d, void *dst, uint32_t src, size_t n) {
+  uint8_t *p = (uint8_t *)dst;
+  uint32_t addr = src & ~3u;
+  uint32_t skip = src & 3u;
+  if (!n) return;
+  qspi_burst(d, QSPI_BURST_RD);
+  while (n) {
+    uint32_t w = RD(d, addr);
+    uint32_t k;
+    for (k = skip; k < 4 && n; k++, n--) *p++ = (uint8_t)(w >> 8 * k);
+    skip = 0;
+    addr += 4;
+  }
+  qspi_burst_end(d, QSPI_BURST_RD);
+}
+
+void qspi_read_sg(qspi_dev *d, const qspi_sg *sg, size_t n) {
+  size_t i;
+  for (i = 0; i < n; i++) qspi_memcpy_from(d, sg[i].buf, sg[i].addr, sg[i].len);
+}
+
+// ─── Host → PSRAM ──────────────────────────────────────────────
+
+// Unaligned head / tail: halfwords where aligned, bytes otherwise
+static void qspi_write_narrow(qspi_dev *d, uint32_t addr, const uint8_t *p, size_t n) {
+  while (n) {
+    if (!(addr & 1) && n >= 2) {
+      d->io.write16(d->io.ctx, addr, (uint16_t)(p[0] | p[1] << 8));
+      d->last = addr;
+      addr += 2, p += 2, n -= 2;
+    } else {
+      d->io.write8(d->io.ctx, addr, p[0]);
+      d->last = addr;
+      addr += 1, p += 1, n -= 1;
+    }
+  }
+}
+
+void qspi_memcpy_to(qspi_dev *d, uint32_t dst, const void *src, size_t n) {
+  const uint8_t *p = (const uint8_t *)src;
+  size_t head = (4 - (dst & 3u)) & 3u;
+  size_t words;
+  if (head > n) head = n;
+  qspi_write_narrow(d, dst, p, head);
+  dst += (uint32_t)head, p += head, n -= head;
+
+  words = n / 4;
+  if (words) {
+    qspi_burst(d, QSPI_BURST_WR);
+    for (; words; words--, dst += 4, p += 4, n -= 4)
+      qspi_write32(d, dst, (uint32_t)p[0] | (uint32_t)p[1] << 8 |
+                               (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24);
+    qspi_burst_end(d, QSPI_BURST_WR);
+  }
+  qspi_write_narrow(d, dst, p, n);
+}
+
+void qspi_write_sg(qspi_dev *d, const qspi_sg *sg, size_t n) {
+  size_t i;
+  for (i = 0; i < n; i++) qspi_memcpy_to(d, sg[i].addr, sg[i].buf, sg[i].len);
+}
@@ -0,0 +1,83 @@
+// qspi_drv.h
+// Reference driver for the Chisel QSPI master with a QPI PSRAM behind it
+// (qspi/src/QSPI.scala).
+//
+// PSRAM is memory-mapped: every 32-, 16- or 8-bit access below
+// QSPI_CSR_BASE is one transaction, byte 0 of a word at the lowest
+// address. The copy routines switch the BURST CSR on for their aligned
+// part, so sequential words cost no command, address or dummy cycles.
+//
+//   Blocking     qspi_read32() / qspi_write32()
+//                qspi_memcpy_from() / qspi_memcpy_to()   any alignment
+//                qspi_read_sg() / qspi_write_sg()        scatter lists
+//   Queued       writes are posted when qspi_init() sets QSPI_PIPE_POST:
+//                they return as soon as the controller has taken them and
+//                qspi_fence() waits until they have reached the PSRAM
+
+#pragma once
+
+#include "drv_mmio.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ─── Register map (byte offsets) ───────────────────────────────
+#define QSPI_CSR_BASE      (1u << 24)
+#define QSPI_CSR(i)        (QSPI_CSR_BASE + ((uint32_t)(i) << 2))
+#define QSPI_CSR_INT_CTRL  QSPI_CSR(0)
+#define QSPI_CSR_INT_STAT  QSPI_CSR(1)
+#define QSPI_CSR_XFORM     QSPI_CSR(2)
+#define QSPI_CSR_BURST     QSPI_CSR(3)
+#define QSPI_CSR_PIPE      QSPI_CSR(4)
+#define QSPI_CSR_CMP_CTRL  QSPI_CSR(5)
+#define QSPI_CSR_CMP_EXP   QSPI_CSR(6)
+#define QSPI_CSR_CMP_MASK  QSPI_CSR(7)
+#define QSPI_CSR_INIT_CTRL QSPI_CSR(8)
+#define QSPI_CSR_DIV_CMD   QSPI_CSR(9)  // SCK dividers per transaction phase
+#define QSPI_CSR_DIV_ADDR  QSPI_CSR(10)
+#define QSPI_CSR_DIV_DUMMY QSPI_CSR(11)
+#define QSPI_CSR_DIV_DATA  QSPI_CSR(12)
+#define QSPI_CSR_INIT_CMD(i) QSPI_CSR(16 + 2 * (i))
+#define QSPI_CSR_INIT_ARG(i) QSPI_CSR(17 + 2 * (i))
+
+#define QSPI_BURST_RD      (1u << 0)
+#define QSPI_BURST_WR      (1u << 1)
+#define QSPI_BURST_CE_MAX(cycles) ((uint32_t)(cycles) << 16)
+#define QSPI_PIPE_CE_GAP(cycles)  ((uint32_t)(cycles) & 0xFF)
+#define QSPI_PIPE_POST     (1u << 8)
+#define QSPI_INIT_RUN      (1u << 0)
+#define QSPI_INIT_COUNT(n) ((uint32_t)(n) << 8)
+#define QSPI_INIT_QPI      (1u << 8)
+#define QSPI_INIT_NARG(n)  ((uint32_t)(n) << 9)
+#define QSPI_INIT_WAIT(cycles) ((uint32_t)(cycles) << 16)
+
+typedef struct qspi_sg {
+  uint32_t addr; // PSRAM byte address
+  void *buf;     // host buffer (read by qspi_write_sg)
+  size_t len;    // bytes
+} qspi_sg;
+
+typedef struct qspi_dev {
+  drv_mmio io;
+  uint32_t burst; // BURST value outside the copy routines
+  uint32_t last;  // address of the last write, read back by qspi_fence()
+} qspi_dev;
+
+void qspi_init(qspi_dev *d, const drv_mmio *io, uint32_t burst, uint32_t pipe);
+
+uint32_t qspi_read32(qspi_dev *d, uint32_t addr);
+void qspi_write32(qspi_dev *d, uint32_t addr, uint32_t val);
+
+void qspi_memcpy_from(qspi_dev *d, void *dst, uint32_t src, size_t n);
+void qspi_memcpy_to(qspi_dev *d, uint32_t dst, const void *src, size_t n);
+void qspi_read_sg(qspi_dev *d, const qspi_sg *sg, size_t n);
+void qspi_write_sg(qspi_dev *d, const qspi_sg *sg, size_t n);
+
+void qspi_fence(qspi_dev *d);
+
+#ifdef __cplusplus
+}
+#endif
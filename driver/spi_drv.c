@@ -0,0 +1,145 @@
+// spi_drv.c
+// Reference driver for the Chisel SPI master, see spi_drv.h.
+
+#include "spi_drv.h"
+
+#define RD(d, off)      ((d)->io.read32((d)->io.ctx, (off)))
+#define WR(d, off, val) ((d)->io.write32((d)->io.ctx, (off), (val)))
+
+// Byte k of an n-byte transfer sits at shift register bit 8 * (n - 1 - k),
+// so the first byte goes out first (MSB first, CTRL.LSB off).
+static void spi_load(spi_dev *d, const uint8_t *tx, uint32_t n) {
+  uint32_t w[4] = {0, 0, 0, 0};
+  uint32_t k;
+  if (tx)
+    for (k = 0; k < n; k++) {
+      uint32_t p = 8 * (n - 1 - k);
+      w[p >> 5] |= (uint32_t)tx[k] << (p & 31);
+    }
+  for (k = 0; k < (n + 3) / 4; k++) WR(d, SPI_REG_TX(k), w[k]);
+}
+
+static void spi_unload(spi_dev *d, uint8_t *rx, uint32_t n) {
+  uint32_t w[4];
+  uint32_t k;
+  for (k = 0; k < (n + 3) / 4; k++) w[k] = RD(d, SPI_REG_TX(k));
+  for (k = 0; k < n; k++) {
+    uint32_t p = 8 * (n - 1 - k);
+    rx[k] = (uint8_t)(w[p >> 5] >> (p & 31));
+  }
+}
+
+static void spi_go(spi_dev *d, uint32_t n) {
+  WR(d, SPI_REG_CTRL, 8 * n | SPI_CTRL_GO | d->mode);
+}
+
+static int spi_busy(spi_dev *d) { return (RD(d, SPI_REG_CTRL) & SPI_CTRL_GO) != 0; }
+
+void spi_init(spi_dev *d, const drv_mmio *io, uint16_t divider, uint32_t mode) {
+  d->io = *io;
+  d->mode = mode & (SPI_CTRL_RX_NEG | SPI_CTRL_TX_NEG | SPI_CTRL_IE);
+  d->head = d->tail = NULL;
+  d->off = 0;
+  d->chunk = 0;
+  WR(d, SPI_REG_SS, 0);
+  WR(d, SPI_REG_CTRL, 0);
+  WR(d, SPI_REG_DIVIDER, divider);
+}
+
+// ─── Blocking ──────────────────────────────────────────────────
+
+void spi_xfer(spi_dev *d, uint8_t ss, const uint8_t *tx, uint8_t *rx, size_t len) {
+  spi_seg seg;
+  seg.tx = tx;
+  seg.rx = rx;
+  seg.len = len;
+  spi_xfer_sg(d, ss, &seg, 1);
+}
+
+// One blocking transfer of `n` staged bytes; received bytes go to `dst`
+// (NULL entries are dropped, RX is not read at all when none is wanted).
+static void spi_run(spi_dev *d, const uint8_t *tx, uint8_t *const *dst, uint32_t n) {
+  uint8_t rx[SPI_MAX_BYTES];
+  uint32_t k;
+  int want = 0;
+  spi_load(d, tx, n);
+  spi_go(d, n);
+  for (k = 0; k < n; k++) want |= dst[k] != NULL;
+  while (spi_busy(d)) {}
+  if (!want) return;
+  spi_unload(d, rx, n);
+  for (k = 0; k < n; k++)
+    if (dst[k]) *dst[k] = rx[k];
+}
+
+// Bytes of consecutive segments share a transfer.
+void spi_xfer_sg(spi_dev *d, uint8_t ss, const spi_seg *segs, size_t n) {
+  uint8_t tx[SPI_MAX_BYTES];
+  uint8_t *dst[SPI_MAX_BYTES];
+  uint32_t fill = 0;
+  size_t i, j;
+
+  WR(d, SPI_REG_SS, ss);
+  for (i = 0; i < n; i++) {
+    for (j = 0; j < segs[i].len; j++) {
+      tx[fill] = segs[i].tx ? segs[i].tx[j] : 0;
+      dst[fill] = segs[i].rx ? &segs[i].rx[j] : NULL;
+      if (++fill == SPI_MAX_BYTES) {
+        spi_run(d, tx, dst, fill);
+        fill = 0;
+      }
+    }
+  }
+  if (fill) spi_run(d, tx, dst, fill);
+  WR(d, SPI_REG_SS, 0);
+}
+
+// ─── Queued ────────────────────────────────────────────────────
+
+void spi_submit(spi_dev *d, spi_req *r) {
+  r->next = NULL;
+  r->done = 0;
+  if (!r->seg.len) {
+    r->done = 1;
+    return;
+  }
+  if (d->tail)
+    d->tail->next = r;
+  else
+    d->head = r;
+  d->tail = r;
+  spi_poll(d);
+}
+
+int spi_poll(spi_dev *d) {
+  spi_req *r = d->head;
+  uint32_t n;
+  if (!r) return 0;
+
+  if (d->chunk) {
+    if (spi_busy(d)) return 1;
+    if (r->seg.rx) spi_unload(d, r->seg.rx + d->off, d->chunk);
+    d->off += d->chunk;
+    d->chunk = 0;
+    if (d->off == r->seg.len) {
+      WR(d, SPI_REG_SS, 0);
+      d->head = r->next;
+      if (!d->head) d->tail = NULL;
+      d->off = 0;
+      r->done = 1;
+      r = d->head;
+      if (!r) return 0;
+    }
+  }
+
+  if (!d->off) WR(d, SPI_REG_SS, r->ss);
+  n = r->seg.len - d->off < SPI_MAX_BYTES ? (uint32_t)(r->seg.len - d->off) : SPI_MAX_BYTES;
+  spi_load(d, r->seg.tx ? r->seg.tx + d->off : NULL, n);
+  spi_go(d, n);
+  d->chunk = n;
+  return 1;
+}
+
+void spi_wait(spi_dev *d, spi_req *r) {
+  while (!r->done) spi_poll(d);
+}
@@ -0,0 +1,81 @@
+// spi_drv.h
+// Reference driver for the Chisel SPI master (spi/src/SPI.scala).
+//
+// Byte-stream transfers, MSB of the first byte on the wire first. A
+// stream is cut into transfers of at most SPI_MAX_BYTES; SS is driven by
+// the driver (CTRL.ASS off), so it stays asserted across all the
+// transfers of one stream or scatter list.
+//
+//   Blocking     spi_xfer()     one buffer
+//                spi_xfer_sg()  scatter list in one SS frame; segments
+//                               are packed into shared transfers
+//   Queued       spi_submit()   append a request, returns at once
+//                spi_poll()     advance the queue without waiting (call it
+//                               from the main loop or the intO handler)
+//                spi_wait()     poll until a request is done
+//
+// Only register accesses that are legal during a transfer are made while
+// one runs (CTRL is read to see GO clear), so the queue never stalls APB.
+
+#pragma once
+
+#include "drv_mmio.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ─── Register map (byte offsets) ───────────────────────────────
+#define SPI_REG_TX(i)     ((uint32_t)(i) << 2) // TX_i / RX_i
+#define SPI_REG_CTRL      0x10u
+#define SPI_REG_DIVIDER   0x14u
+#define SPI_REG_SS        0x18u
+#define SPI_REG_INT_CTRL  0x1Cu
+#define SPI_REG_INT_STAT  0x20u
+#define SPI_REG_XFORM     0x24u
+
+#define SPI_CTRL_GO       (1u << 8)
+#define SPI_CTRL_RX_NEG   (1u << 9)
+#define SPI_CTRL_TX_NEG   (1u << 10)
+#define SPI_CTRL_LSB      (1u << 11)
+#define SPI_CTRL_IE       (1u << 12)
+#define SPI_CTRL_ASS      (1u << 13)
+
+// CHAR_LEN is 7 bits and 0 means no transfer, so 120 bits per transfer
+#define SPI_MAX_BYTES     15u
+
+typedef struct spi_seg {
+  const uint8_t *tx; // NULL: send zeros
+  uint8_t *rx;       // NULL: discard
+  size_t len;        // bytes
+} spi_seg;
+
+typedef struct spi_req {
+  spi_seg seg;
+  uint8_t ss;            // SS register value for this request
+  volatile int done;     // set by spi_poll()
+  struct spi_req *next;  // queue link, owned by the driver
+} spi_req;
+
+typedef struct spi_dev {
+  drv_mmio io;
+  uint32_t mode;         // CTRL bits added to every transfer (RX_NEG, TX_NEG, IE)
+  spi_req *head, *tail;  // queued requests, head in flight
+  size_t off;            // bytes of head already done
+  uint32_t chunk;        // bytes of the running transfer, 0 when idle
+} spi_dev;
+
+void spi_init(spi_dev *d, const drv_mmio *io, uint16_t divider, uint32_t mode);
+
+void spi_xfer(spi_dev *d, uint8_t ss, const uint8_t *tx, uint8_t *rx, size_t len);
+void spi_xfer_sg(spi_dev *d, uint8_t ss, const spi_seg *segs, size_t n);
+
+void spi_submit(spi_dev *d, spi_req *r);
+int spi_poll(spi_dev *d); // nonzero while requests are pending
+void spi_wait(spi_dev *d, spi_req *r);
+
+#ifdef __cplusplus
+}
+#endif
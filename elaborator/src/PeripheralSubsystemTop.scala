@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: Unlicense
+package org.chipsalliance.spi.elaborator
+
+import mainargs._
+import org.chipsalliance.qspi.{PSRAMParameter, QSPIPSRAMTopParameter, QSPIParameter}
+import org.chipsalliance.soc.{APBMemSlaveParameter, PeripheralSubsystemTop, PeripheralSubsystemTopParameter}
+import org.chipsalliance.spi.SPIParameter
+import chisel3.experimental.util.SerializableModuleElaborator
+
+object PeripheralSubsystemTopMain extends SerializableModuleElaborator {
+  val topName = "PeripheralSubsystemTop"
+
+  implicit object PathRead extends TokensReader.Simple[os.Path] {
+    def shortName = "path"
+    def read(strs: Seq[String]) = Right(os.Path(strs.head, os.pwd))
+  }
+
+  @main
+  case class PeripheralSubsystemTopParameterMain(
+    @arg(name = "dividerLen") dividerLen: Int = 16,
+    @arg(name = "maxChar") maxChar: Int = 128,
+    @arg(name = "ssNb") ssNb: Int = 8,
+    @arg(name = "useAsyncReset") useAsyncReset: Boolean = false,
+    @arg(name = "psramBackend") psramBackend: String = "sram",
+    @arg(name = "psramSizeBytes") psramSizeBytes: Int = 1 << 20,
+    @arg(name = "psramInitFile") psramInitFile: String = "",
+    @arg(name = "slaveWords") slaveWords: Int = 256,
+    @arg(name = "slaveWaitStates") slaveWaitStates: Int = 2
+  ) {
+    def convert: PeripheralSubsystemTopParameter = PeripheralSubsystemTopParameter(
+      SPIParameter(dividerLen, maxChar, ssNb, useAsyncReset),
+      QSPIPSRAMTopParameter(
+        QSPIParameter(dividerLen, maxChar, ssNb, useAsyncReset, useTriState = false),
+        PSRAMParameter(psramBackend, psramSizeBytes, psramInitFile, oversample = true)
+      ),
+      APBMemSlaveParameter(slaveWords, slaveWaitStates)
+    )
+  }
+
+  implicit def PeripheralSubsystemTopParameterMainParser: ParserForClass[PeripheralSubsystemTopParameterMain] =
+    ParserForClass[PeripheralSubsystemTopParameterMain]
+
+  @main
+  def config(
+    @arg(name = "parameter") parameter: PeripheralSubsystemTopParameterMain,
+    @arg(name = "target-dir") targetDir: os.Path = os.pwd
+  ) =
+    os.write.over(targetDir / s"${topName}.json", configImpl(parameter.convert))
+
+  @main
+  def design(
+    @arg(name = "parameter") parameter: os.Path,
+    @arg(name = "target-dir") targetDir: os.Path = os.pwd
+  ) = {
+    val (firrtl, annos) =
+      designImpl[PeripheralSubsystemTop, PeripheralSubsystemTopParameter](os.read.stream(parameter))
+    os.write.over(targetDir / s"${topName}.fir", firrtl)
+    os.write.over(targetDir / s"${topName}.anno.json", annos)
+  }
+
+  def main(args: Array[String]): Unit = ParserForMethods(this).runOrExit(args.toIndexedSeq)
+}
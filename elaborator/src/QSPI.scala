@@ -18,9 +18,10 @@ object QSPIMain extends SerializableModuleElaborator {
     @arg(name = "dividerLen") dividerLen: Int = 16,
     @arg(name = "maxChar") maxChar: Int = 128,
     @arg(name = "ssNb") ssNb: Int = 8,
-    @arg(name = "useAsyncReset") useAsyncReset: Boolean = false
+    @arg(name = "useAsyncReset") useAsyncReset: Boolean = false,
+    @arg(name = "useTriState") useTriState: Boolean = true
   ) {
-    def convert: QSPIParameter = QSPIParameter(dividerLen, maxChar, ssNb, useAsyncReset)
+    def convert: QSPIParameter = QSPIParameter(dividerLen, maxChar, ssNb, useAsyncReset, useTriState)
   }
 
   implicit def QSPIParameterMainParser: ParserForClass[QSPIParameterMain] =
@@ -0,0 +1,61 @@
+// SPDX-License-Identifier: Unlicense
+package org.chipsalliance.spi.elaborator
+
+import mainargs._
+import org.chipsalliance.qspi.{FlashParameter, QSPIFlashTop, QSPIFlashTopParameter, QSPIParameter}
+import chisel3.experimental.util.SerializableModuleElaborator
+
+object QSPIFlashTopMain extends SerializableModuleElaborator {
+  val topName = "QSPIFlashTop"
+
+  implicit object PathRead extends TokensReader.Simple[os.Path] {
+    def shortName = "path"
+    def read(strs: Seq[String]) = Right(os.Path(strs.head, os.pwd))
+  }
+
+  @main
+  case class QSPIFlashTopParameterMain(
+    @arg(name = "dividerLen") dividerLen: Int = 16,
+    @arg(name = "maxChar") maxChar: Int = 128,
+    @arg(name = "ssNb") ssNb: Int = 8,
+    @arg(name = "useAsyncReset") useAsyncReset: Boolean = false,
+    @arg(name = "flashSizeBytes") flashSizeBytes: Int = 1 << 24,
+    @arg(name = "programCycles") programCycles: Int = 1000,
+    @arg(name = "sectorEraseCycles") sectorEraseCycles: Int = 8000,
+    @arg(name = "blockEraseCycles") blockEraseCycles: Int = 32000,
+    @arg(name = "chipEraseCycles") chipEraseCycles: Int = 64000
+  ) {
+    def convert: QSPIFlashTopParameter = QSPIFlashTopParameter(
+      QSPIParameter(dividerLen, maxChar, ssNb, useAsyncReset, useTriState = false),
+      FlashParameter(
+        sizeBytes = flashSizeBytes,
+        programCycles = programCycles,
+        sectorEraseCycles = sectorEraseCycles,
+        blockEraseCycles = blockEraseCycles,
+        chipEraseCycles = chipEraseCycles
+      )
+    )
+  }
+
+  implicit def QSPIFlashTopParameterMainParser: ParserForClass[QSPIFlashTopParameterMain] =
+    ParserForClass[QSPIFlashTopParameterMain]
+
+  @main
+  def config(
+    @arg(name = "parameter") parameter: QSPIFlashTopParameterMain,
+    @arg(name = "target-dir") targetDir: os.Path = os.pwd
+  ) =
+    os.write.over(targetDir / s"${topName}.json", configImpl(parameter.convert))
+
+  @main
+  def design(
+    @arg(name = "parameter") parameter: os.Path,
+    @arg(name = "target-dir") targetDir: os.Path = os.pwd
+  ) = {
+    val (firrtl, annos) = designImpl[QSPIFlashTop, QSPIFlashTopParameter](os.read.stream(parameter))
+    os.write.over(targetDir / s"${topName}.fir", firrtl)
+    os.write.over(targetDir / s"${topName}.anno.json", annos)
+  }
+
+  def main(args: Array[String]): Unit = ParserForMethods(this).runOrExit(args.toIndexedSeq)
+}
@@ -2,7 +2,7 @@
 package org.chipsalliance.spi.elaborator
 
 import mainargs._
-import org.chipsalliance.qspi.{QSPIPSRAMTop, QSPIParameter}
+import org.chipsalliance.qspi.{PSRAMParameter, QSPIPSRAMTop, QSPIPSRAMTopParameter, QSPIParameter}
 import chisel3.experimental.util.SerializableModuleElaborator
 
 object QSPIPSRAMTopMain extends SerializableModuleElaborator {
@@ -14,21 +14,28 @@ object QSPIPSRAMTopMain extends SerializableModuleElaborator {
   }
 
   @main
-  case class QSPIParameterMain(
+  case class QSPIPSRAMTopParameterMain(
     @arg(name = "dividerLen") dividerLen: Int = 16,
     @arg(name = "maxChar") maxChar: Int = 128,
     @arg(name = "ssNb") ssNb: Int = 8,
-    @arg(name = "useAsyncReset") useAsyncReset: Boolean = false
+    @arg(name = "useAsyncReset") useAsyncReset: Boolean = false,
+    @arg(name = "psramBackend") psramBackend: String = "dpi",
+    @arg(name = "psramSizeBytes") psramSizeBytes: Int = 1 << 20,
+    @arg(name = "psramInitFile") psramInitFile: String = "",
+    @arg(name = "psramOversample") psramOversample: Boolean = false
   ) {
-    def convert: QSPIParameter = QSPIParameter(dividerLen, maxChar, ssNb, useAsyncReset)
+    def convert: QSPIPSRAMTopParameter = QSPIPSRAMTopParameter(
+      QSPIParameter(dividerLen, maxChar, ssNb, useAsyncReset, useTriState = !psramOversample),
+      PSRAMParameter(psramBackend, psramSizeBytes, psramInitFile, psramOversample)
+    )
   }
 
-  implicit def QSPIParameterMainParser: ParserForClass[QSPIParameterMain] =
-    ParserForClass[QSPIParameterMain]
+  implicit def QSPIPSRAMTopParameterMainParser: ParserForClass[QSPIPSRAMTopParameterMain] =
+    ParserForClass[QSPIPSRAMTopParameterMain]
 
   @main
   def config(
-    @arg(name = "parameter") parameter: QSPIParameterMain,
+    @arg(name = "parameter") parameter: QSPIPSRAMTopParameterMain,
     @arg(name = "target-dir") targetDir: os.Path = os.pwd
   ) =
     os.write.over(targetDir / s"${topName}.json", configImpl(parameter.convert))
@@ -38,7 +45,7 @@ object QSPIPSRAMTopMain extends SerializableModuleElaborator {
     @arg(name = "parameter") parameter: os.Path,
     @arg(name = "target-dir") targetDir: os.Path = os.pwd
   ) = {
-    val (firrtl, annos) = designImpl[QSPIPSRAMTop, QSPIParameter](os.read.stream(parameter))
+    val (firrtl, annos) = designImpl[QSPIPSRAMTop, QSPIPSRAMTopParameter](os.read.stream(parameter))
     os.write.over(targetDir / s"${topName}.fir", firrtl)
     os.write.over(targetDir / s"${topName}.anno.json", annos)
   }
@@ -18,9 +18,14 @@ object SPIMain extends SerializableModuleElaborator {
     @arg(name = "dividerLen") dividerLen: Int = 16,
     @arg(name = "maxChar") maxChar: Int = 128,
     @arg(name = "ssNb") ssNb: Int = 8,
-    @arg(name = "useAsyncReset") useAsyncReset: Boolean = false
+    @arg(name = "useAsyncReset") useAsyncReset: Boolean = false,
+    @arg(name = "fixedCharLen") fixedCharLen: Option[Int] = None,
+    @arg(name = "fixedMode") fixedMode: Option[Int] = None,
+    @arg(name = "fixedLsb") fixedLsb: Option[Boolean] = None,
+    @arg(name = "fixedDivider") fixedDivider: Option[Int] = None
   ) {
-    def convert: SPIParameter = SPIParameter(dividerLen, maxChar, ssNb, useAsyncReset)
+    def convert: SPIParameter =
+      SPIParameter(dividerLen, maxChar, ssNb, useAsyncReset, fixedCharLen, fixedMode, fixedLsb, fixedDivider)
   }
 
   implicit def SPIParameterMainParser: ParserForClass[SPIParameterMain] =
@@ -2,7 +2,7 @@
 package org.chipsalliance.spi.elaborator
 
 import mainargs._
-import org.chipsalliance.spi.{SPIBitRevTop, SPIParameter}
+import org.chipsalliance.spi.{SPIBitRevTop, SPIBitRevTopParameter, SPIParameter}
 import chisel3.experimental.util.SerializableModuleElaborator
 
 object SPIBitRevTopMain extends SerializableModuleElaborator {
@@ -14,21 +14,23 @@ object SPIBitRevTopMain extends SerializableModuleElaborator {
   }
 
   @main
-  case class SPIParameterMain(
+  case class SPIBitRevTopParameterMain(
     @arg(name = "dividerLen") dividerLen: Int = 16,
     @arg(name = "maxChar") maxChar: Int = 128,
     @arg(name = "ssNb") ssNb: Int = 8,
-    @arg(name = "useAsyncReset") useAsyncReset: Boolean = false
+    @arg(name = "useAsyncReset") useAsyncReset: Boolean = false,
+    @arg(name = "oversample") oversample: Boolean = false
   ) {
-    def convert: SPIParameter = SPIParameter(dividerLen, maxChar, ssNb, useAsyncReset)
+    def convert: SPIBitRevTopParameter =
+      SPIBitRevTopParameter(SPIParameter(dividerLen, maxChar, ssNb, useAsyncReset), oversample)
   }
 
-  implicit def SPIParameterMainParser: ParserForClass[SPIParameterMain] =
-    ParserForClass[SPIParameterMain]
+  implicit def SPIBitRevTopParameterMainParser: ParserForClass[SPIBitRevTopParameterMain] =
+    ParserForClass[SPIBitRevTopParameterMain]
 
   @main
   def config(
-    @arg(name = "parameter") parameter: SPIParameterMain,
+    @arg(name = "parameter") parameter: SPIBitRevTopParameterMain,
     @arg(name = "target-dir") targetDir: os.Path = os.pwd
   ) =
     os.write.over(targetDir / s"${topName}.json", configImpl(parameter.convert))
@@ -38,7 +40,7 @@ object SPIBitRevTopMain extends SerializableModuleElaborator {
     @arg(name = "parameter") parameter: os.Path,
     @arg(name = "target-dir") targetDir: os.Path = os.pwd
   ) = {
-    val (firrtl, annos) = designImpl[SPIBitRevTop, SPIParameter](os.read.stream(parameter))
+    val (firrtl, annos) = designImpl[SPIBitRevTop, SPIBitRevTopParameter](os.read.stream(parameter))
     os.write.over(targetDir / s"${topName}.fir", firrtl)
     os.write.over(targetDir / s"${topName}.anno.json", annos)
   }
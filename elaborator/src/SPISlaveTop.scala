@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: Unlicense
+package org.chipsalliance.spi.elaborator
+
+import mainargs._
+import org.chipsalliance.spi.{SPIParameter, SPISlaveTop, SPISlaveTopParameter}
+import chisel3.experimental.util.SerializableModuleElaborator
+
+object SPISlaveTopMain extends SerializableModuleElaborator {
+  val topName = "SPISlaveTop"
+
+  implicit object PathRead extends TokensReader.Simple[os.Path] {
+    def shortName = "path"
+    def read(strs: Seq[String]) = Right(os.Path(strs.head, os.pwd))
+  }
+
+  @main
+  case class SPISlaveTopParameterMain(
+    @arg(name = "dividerLen") dividerLen: Int = 16,
+    @arg(name = "maxChar") maxChar: Int = 128,
+    @arg(name = "ssNb") ssNb: Int = 8,
+    @arg(name = "useAsyncReset") useAsyncReset: Boolean = false,
+    @arg(name = "fifoDepth") fifoDepth: Int = 16
+  ) {
+    def convert: SPISlaveTopParameter =
+      SPISlaveTopParameter(SPIParameter(dividerLen, maxChar, ssNb, useAsyncReset), fifoDepth)
+  }
+
+  implicit def SPISlaveTopParameterMainParser: ParserForClass[SPISlaveTopParameterMain] =
+    ParserForClass[SPISlaveTopParameterMain]
+
+  @main
+  def config(
+    @arg(name = "parameter") parameter: SPISlaveTopParameterMain,
+    @arg(name = "target-dir") targetDir: os.Path = os.pwd
+  ) =
+    os.write.over(targetDir / s"${topName}.json", configImpl(parameter.convert))
+
+  @main
+  def design(
+    @arg(name = "parameter") parameter: os.Path,
+    @arg(name = "target-dir") targetDir: os.Path = os.pwd
+  ) = {
+    val (firrtl, annos) = designImpl[SPISlaveTop, SPISlaveTopParameter](os.read.stream(parameter))
+    os.write.over(targetDir / s"${topName}.fir", firrtl)
+    os.write.over(targetDir / s"${topName}.anno.json", annos)
+  }
+
+  def main(args: Array[String]): Unit = ParserForMethods(this).runOrExit(args.toIndexedSeq)
+}
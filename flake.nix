@@ -74,6 +74,7 @@
                   nixd
                   nvfetcher
                   verilator
+                  yosys
                   python3
                   clang-tools
                   gtkwave
@@ -39,6 +39,9 @@ let
         fileset = unions [
           ./../../build.mill
           ./../../common.mill
+          ./../../shared
+          ./../../qspi
+          ./../../soc
           ./../../spi
           ./../../elaborator
         ];
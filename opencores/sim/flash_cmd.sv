@@ -0,0 +1,27 @@
+import "DPI-C" function void flash_read(input int addr, output byte data);
+import "DPI-C" function void flash_program(input int addr, input byte data);
+import "DPI-C" function void flash_erase(input int addr, input int len);
+
+// op: 0 read, 1 program (AND), 2 erase (to 0xFF)
+module flash_cmd(
+  input             clock,
+  input             valid,
+  input       [1:0] op,
+  input      [31:0] addr,
+  input       [7:0] wdata,
+  input      [31:0] len,
+  output reg  [7:0] rdata
+);
+  always@(posedge clock) begin
+    if (valid)
+      case (op)
+        2'd0: flash_read(addr, rdata);
+        2'd1: flash_program(addr, wdata);
+        2'd2: flash_erase(addr, len);
+        default: begin
+          $fwrite(32'h80000002, "Assertion failed: Unsupported flash op `%d`\n", op);
+          $fatal;
+        end
+      endcase
+  end
+endmodule
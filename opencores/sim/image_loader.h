@@ -0,0 +1,184 @@
+// image_loader.h
+// Backdoor preload of memory images into a device model's backing store.
+//
+// Accepts either a raw binary or a little-endian ELF file (32- or 64-bit).
+// For ELF, every PT_LOAD segment is copied by its physical address;
+// `.bss` (p_memsz > p_filesz) is zeroed. Program headers are checked against
+// the file and the store before anything is copied.
+// If a load address is given, the lowest segment is placed there and the
+// others keep their relative offsets, which lets a binary linked for the
+// SoC's XIP window (e.g. 0x30000000) land at the start of the model.
+//
+// Usage from a harness:
+//   std::vector<ImageSegment> segs;
+//   if (!load_image("fw.elf", IMAGE_BASE_AUTO, mem, sizeof(mem), &segs)) ...
+//
+// Models without a C++ backing store (e.g. a SyncReadMem initialised by
+// $readmemh) get the same image through image_write_readmemh().
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <elf.h>
+#include <string>
+#include <vector>
+
+struct ImageSegment {
+  uint32_t addr; // offset inside the backing store
+  uint32_t size; // bytes (file part + zero fill)
+};
+
+// Raw binaries load at 0, ELF segments at their physical address.
+static constexpr uint64_t IMAGE_BASE_AUTO = ~0ull;
+
+static inline bool image_read_file(const char *path, std::vector<uint8_t> &buf) {
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    printf("  image: cannot open %s\n", path);
+    return false;
+  }
+  fseek(f, 0, SEEK_END);
+  long len = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  buf.resize(len > 0 ? (size_t)len : 0);
+  size_t got = buf.empty() ? 0 : fread(buf.data(), 1, buf.size(), f);
+  fclose(f);
+  if (got != buf.size()) {
+    printf("  image: short read on %s\n", path);
+    return false;
+  }
+  return true;
+}
+
+// Copies [src, src+filesz) to mem[addr] and zero-fills up to memsz.
+// The caller has checked that `src` holds filesz bytes; the bounds here
+// are written so that huge values from a corrupt header cannot wrap.
+static inline bool image_place(uint8_t *mem, size_t mem_size, uint64_t addr,
+                               const uint8_t *src, uint64_t filesz,
+                               uint64_t memsz,
+                               std::vector<ImageSegment> *segs) {
+  if (filesz > memsz) {
+    printf("  image: segment file size 0x%llx exceeds its memory size 0x%llx\n",
+           (unsigned long long)filesz, (unsigned long long)memsz);
+    return false;
+  }
+  if (addr > mem_size || memsz > mem_size - addr) {
+    printf("  image: segment 0x%llx+0x%llx exceeds %zu-byte store\n",
+           (unsigned long long)addr, (unsigned long long)memsz, mem_size);
+    return false;
+  }
+  memcpy(mem + addr, src, filesz);
+  memset(mem + addr + filesz, 0, memsz - filesz);
+  if (segs) segs->push_back({(uint32_t)addr, (uint32_t)memsz});
+  return true;
+}
+
+template <class Ehdr, class Phdr>
+static inline bool image_load_elf(const std::vector<uint8_t> &buf,
+                                  uint64_t base, uint8_t *mem,
+                                  size_t mem_size,
+                                  std::vector<ImageSegment> *segs) {
+  if (buf.size() < sizeof(Ehdr)) return false;
+  Ehdr eh;
+  memcpy(&eh, buf.data(), sizeof(eh));
+  if (eh.e_phnum > 0 && eh.e_phentsize != sizeof(Phdr)) {
+    printf("  image: ELF program header size %u, expected %zu\n",
+           (unsigned)eh.e_phentsize, sizeof(Phdr));
+    return false;
+  }
+  if (eh.e_phoff > buf.size() ||
+      (uint64_t)eh.e_phnum * sizeof(Phdr) > buf.size() - eh.e_phoff) {
+    printf("  image: truncated ELF program headers\n");
+    return false;
+  }
+
+  std::vector<Phdr> loads;
+  for (unsigned i = 0; i < eh.e_phnum; i++) {
+    Phdr ph;
+    memcpy(&ph, buf.data() + eh.e_phoff + i * sizeof(Phdr), sizeof(ph));
+    if (ph.p_type == PT_LOAD && ph.p_memsz > 0) loads.push_back(ph);
+  }
+  if (loads.empty()) {
+    printf("  image: ELF has no PT_LOAD segments\n");
+    return false;
+  }
+
+  uint64_t lowest = loads[0].p_paddr;
+  for (const Phdr &ph : loads) lowest = std::min<uint64_t>(lowest, ph.p_paddr);
+
+  for (const Phdr &ph : loads) {
+    if (ph.p_offset > buf.size() || ph.p_filesz > buf.size() - ph.p_offset) {
+      printf("  image: ELF segment at 0x%llx (0x%llx bytes at file offset 0x%llx) "
+             "runs past the end of the file\n",
+             (unsigned long long)ph.p_paddr, (unsigned long long)ph.p_filesz,
+             (unsigned long long)ph.p_offset);
+      return false;
+    }
+    uint64_t addr = base == IMAGE_BASE_AUTO ? ph.p_paddr % mem_size
+                                            : base + (ph.p_paddr - lowest);
+    if (!image_place(mem, mem_size, addr, buf.data() + ph.p_offset,
+                     ph.p_filesz, ph.p_memsz, segs))
+      return false;
+  }
+  return true;
+}
+
+// Loads `path` into `mem`; returns false (after printing why) on error.
+static inline bool load_image(const char *path, uint64_t base, uint8_t *mem,
+                              size_t mem_size,
+                              std::vector<ImageSegment> *segs) {
+  std::vector<uint8_t> buf;
+  if (!image_read_file(path, buf)) return false;
+
+  bool is_elf = buf.size() >= EI_NIDENT && memcmp(buf.data(), ELFMAG, SELFMAG) == 0;
+  if (!is_elf) {
+    uint64_t addr = base == IMAGE_BASE_AUTO ? 0 : base;
+    return image_place(mem, mem_size, addr, buf.data(), buf.size(), buf.size(), segs);
+  }
+  if (buf[EI_DATA] != ELFDATA2LSB) {
+    printf("  image: big-endian ELF not supported\n");
+    return false;
+  }
+  if (buf[EI_CLASS] == ELFCLASS32)
+    return image_load_elf<Elf32_Ehdr, Elf32_Phdr>(buf, base, mem, mem_size, segs);
+  if (buf[EI_CLASS] == ELFCLASS64)
+    return image_load_elf<Elf64_Ehdr, Elf64_Phdr>(buf, base, mem, mem_size, segs);
+  printf("  image: unknown ELF class %u\n", buf[EI_CLASS]);
+  return false;
+}
+
+// Parses "<path>[@<addr>]" as given to +load=.
+static inline void image_parse_spec(const std::string &spec, std::string &path,
+                                    uint64_t &base) {
+  size_t at = spec.rfind('@');
+  if (at == std::string::npos) {
+    path = spec;
+    base = IMAGE_BASE_AUTO;
+  } else {
+    path = spec.substr(0, at);
+    base = strtoull(spec.c_str() + at + 1, nullptr, 0);
+  }
+}
+
+// Writes the loaded segments of `mem` as a $readmemh file (one byte per
+// line, an @address before each segment). With no segments a single zero
+// byte is written so the file always exists.
+static inline bool image_write_readmemh(const char *path, const uint8_t *mem,
+                                        const std::vector<ImageSegment> &segs) {
+  FILE *f = fopen(path, "w");
+  if (!f) {
+    printf("  image: cannot create %s\n", path);
+    return false;
+  }
+  if (segs.empty()) fprintf(f, "00\n");
+  for (const ImageSegment &seg : segs) {
+    fprintf(f, "@%x\n", seg.addr);
+    for (uint32_t i = 0; i < seg.size; i++) fprintf(f, "%02x\n", mem[seg.addr + i]);
+  }
+  fclose(f);
+  return true;
+}
@@ -0,0 +1,178 @@
+// link_monitor.h
+// Serial-link efficiency, measured on the pins.
+//
+// sample() is called once per system clock with CS#, SCK and the data
+// lines. Every CS# low window is one transaction: the data lines are
+// captured at each SCK rising edge and, when CS# rises, a protocol
+// classifier (supplied by the harness) names the transaction and splits
+// its SCK cycles into command / address / dummy / turnaround / data.
+// What is left of the window is CS overhead: CS# low without SCK (setup,
+// hold, stalls) plus the CS# high gap before it, capped at the shortest
+// gap seen so far, i.e. the deselect time the link needs between
+// back-to-back transactions. Longer gaps are host idle and only lower
+// the aggregate utilization.
+//
+// Everything is counted in bit-times, SCK periods times the link width,
+// so a 4-byte quad read reports 32 payload bits of roughly 112. The SCK
+// period is the shortest rising-edge spacing of each transaction.
+//
+// Usage from a harness:
+//   static LinkMonitor link(4, qspi_classify);
+//   tick():  link.sample(ce_n, sck, dio);
+//   end:     link.report("QSPI");
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+enum LinkPhase { LINK_CMD, LINK_ADDR, LINK_DUMMY, LINK_TURN, LINK_DATA, LINK_PHASES };
+
+// One CS# low window as seen on the pins
+struct LinkXfer {
+  std::vector<uint8_t> dio; // data lines at each SCK rising edge
+  uint64_t low_cycles = 0;  // system cycles with CS# low
+  uint64_t gap_cycles = 0;  // CS# high cycles before it
+};
+
+// What the classifier makes of a LinkXfer
+struct LinkClass {
+  std::string type;                // empty: not counted
+  uint32_t sck[LINK_PHASES] = {};  // SCK cycles per phase, summing to dio.size()
+  uint32_t payload_bits = 0;
+};
+
+using LinkClassifier = LinkClass (*)(const LinkXfer &);
+
+struct LinkStats {
+  uint64_t count = 0;
+  uint64_t payload_bits = 0;
+  double bits[LINK_PHASES] = {}; // bit-times per phase
+  double cs_bits = 0;            // bit-times of CS overhead
+
+  double total() const {
+    double t = cs_bits;
+    for (double b : bits) t += b;
+    return t;
+  }
+  double efficiency() const { return total() > 0 ? payload_bits / total() : 0.0; }
+};
+
+class LinkMonitor {
+public:
+  LinkMonitor(int lanes, LinkClassifier classify) : lanes_(lanes), classify_(classify) {}
+
+  void sample(bool cs_n, bool sck, uint8_t dio) {
+    cycle_++;
+    if (!cs_n) {
+      if (cs_prev_) { // CS# fell
+        cur_ = LinkXfer();
+        cur_.gap_cycles = gap_;
+        rise_prev_ = 0;
+        rise_min_ = ~0ull;
+        if (!first_) first_ = cycle_;
+      }
+      cur_.low_cycles++;
+      if (sck && !sck_prev_) {
+        cur_.dio.push_back(dio);
+        if (rise_prev_) rise_min_ = std::min(rise_min_, cycle_ - rise_prev_);
+        rise_prev_ = cycle_;
+      }
+    } else {
+      if (!cs_prev_) { // CS# rose
+        close();
+        gap_ = 0;
+      }
+      gap_++;
+    }
+    cs_prev_ = cs_n;
+    sck_prev_ = sck;
+  }
+
+  // Drops the statistics gathered so far (the pin state is kept)
+  void clear() {
+    types_.clear();
+    all_ = LinkStats();
+    first_ = last_ = 0;
+  }
+
+  const LinkStats *stats(const std::string &type) const {
+    auto it = types_.find(type);
+    return it == types_.end() ? nullptr : &it->second;
+  }
+  const LinkStats &aggregate() const { return all_; }
+  const LinkClass &last() const { return last_class_; }
+
+  // Bit-times from the first CS# fall to the last CS# rise counted
+  double span() const {
+    return last_ > first_ ? (double)(last_ - first_ + 1) * lanes_ / period_ : 0.0;
+  }
+
+  // Payload bits over span(), host idle included
+  double utilization() const { return span() > 0 ? all_.payload_bits / span() : 0.0; }
+
+  void report(const char *title) const {
+    if (!all_.count) return;
+    printf("  Link (%s, %d lane%s, SCK = %.0f cycles):\n", title, lanes_,
+           lanes_ > 1 ? "s" : "", period_);
+    printf("    %-18s %8s %8s %10s %6s   per transaction: cmd/addr/dummy/turn/data/cs\n",
+           "type", "count", "payload", "bit-times", "eff");
+    for (const auto &kv : types_) print_row(kv.first.c_str(), kv.second);
+    print_row("all", all_);
+    printf("    link utilization: %.1f%% (payload over %.0f bit-times incl. idle)\n",
+           100.0 * utilization(), span());
+  }
+
+private:
+  void close() {
+    if (cur_.dio.empty()) return;
+    if (rise_min_ != ~0ull) period_ = (double)rise_min_;
+    // The gap before the first transaction is reset time, not deselect
+    bool back = seen_;
+    if (back) min_gap_ = std::min(min_gap_, cur_.gap_cycles);
+    seen_ = true;
+
+    LinkClass c = classify_(cur_);
+    last_class_ = c;
+    if (c.type.empty()) return;
+
+    double sck_cycles = (double)cur_.dio.size() * period_;
+    double idle = std::max(0.0, (double)cur_.low_cycles - sck_cycles) +
+                  (back ? (double)std::min(cur_.gap_cycles, min_gap_) : 0.0);
+    for (LinkStats *s : {&types_[c.type], &all_}) {
+      s->count++;
+      s->payload_bits += c.payload_bits;
+      for (int p = 0; p < LINK_PHASES; p++) s->bits[p] += (double)c.sck[p] * lanes_;
+      s->cs_bits += idle * lanes_ / period_;
+    }
+    last_ = cycle_ - 1;
+  }
+
+  void print_row(const char *name, const LinkStats &s) const {
+    double n = (double)s.count;
+    printf("    %-18s %8llu %8.0f %10.1f %5.1f%%  ", name, (unsigned long long)s.count,
+           s.payload_bits / n, s.total() / n, 100.0 * s.efficiency());
+    for (int p = 0; p < LINK_PHASES; p++) printf(" %.1f", s.bits[p] / n);
+    printf(" %.1f\n", s.cs_bits / n);
+  }
+
+  int lanes_;
+  LinkClassifier classify_;
+  LinkXfer cur_;
+  LinkClass last_class_;
+  std::map<std::string, LinkStats> types_;
+  LinkStats all_;
+  uint64_t cycle_ = 0;
+  uint64_t first_ = 0, last_ = 0; // first CS# fall / last CS# rise counted
+  uint64_t gap_ = 0;
+  uint64_t min_gap_ = ~0ull;
+  uint64_t rise_prev_ = 0, rise_min_ = ~0ull;
+  double period_ = 2.0;
+  bool seen_ = false;
+  bool cs_prev_ = true;
+  bool sck_prev_ = false;
+};
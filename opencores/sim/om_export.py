@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+# om_export.py
+# Pulls the Object Model of one class out of an elaborated .fir and turns
+# it into what the harnesses consume, so their expected timing comes from
+# the same Scala values as the RTL instead of hand-copied literals.
+#
+#   om_export.py json   <design.fir> <Class>  > Class.json
+#   om_export.py header <Class.json>           > Class.h
+#   om_export.py param  <config.json> <field> <PREFIX> > header.h
+#
+# The header has one `static constexpr` per property, named OM_ plus the
+# property name in upper snake case (goLatency -> OM_GO_LATENCY). Integer
+# lists become arrays. `param` does the same for one nested parameter of
+# an elaborator config (e.g. the "flash" field of QSPIFlashTop.json), for
+# values the design does not export through an OM class.
+
+import json
+import re
+import sys
+
+PROP = re.compile(r"^\s+propassign\s+(\w+)\s*,\s*(.+?)\s*$")
+INT = re.compile(r"Integer\((-?\d+)\)")
+BOOL = re.compile(r"^Bool\((true|false)\)$")
+
+
+def parse_value(text):
+    if text.startswith("List<"):
+        return [int(v) for v in INT.findall(text)]
+    m = BOOL.match(text)
+    if m:
+        return m.group(1) == "true"
+    m = INT.fullmatch(text)
+    if m:
+        return int(m.group(1))
+    return None  # strings, paths, object references: not needed by C++
+
+
+def extract(fir, cls):
+    props, inside, found = {}, False, False
+    for line in fir.splitlines():
+        if re.match(r"^\s*class\s+" + re.escape(cls) + r"\s*:", line):
+            inside = found = True
+            indent = len(line) - len(line.lstrip())
+            continue
+        if inside:
+            if line.strip() and len(line) - len(line.lstrip()) <= indent:
+                break
+            m = PROP.match(line)
+            if m:
+                value = parse_value(m.group(2))
+                if value is not None:
+                    props[m.group(1)] = value
+    if not found:
+        sys.exit(f"om_export: class {cls} not found")
+    return props
+
+
+def snake(name):
+    return re.sub(r"(?<=[a-z0-9])([A-Z])", r"_\1", name).upper()
+
+
+def header(props, source, prefix="OM"):
+    out = [f"// Generated by om_export.py from {source}, do not edit", "#pragma once", ""]
+    for name, value in props.items():
+        ident = f"{prefix}_{snake(name)}"
+        if isinstance(value, bool):
+            out.append(f"static constexpr bool {ident} = {str(value).lower()};")
+        elif isinstance(value, list):
+            items = ", ".join(str(v) for v in value)
+            out.append(f"static constexpr int {ident}[] = {{{items}}};")
+        elif isinstance(value, int):
+            out.append(f"static constexpr int {ident} = {value};")
+    return "\n".join(out) + "\n"
+
+
+def main(argv):
+    if len(argv) == 4 and argv[1] == "json":
+        with open(argv[2]) as f:
+            props = extract(f.read(), argv[3])
+        json.dump(props, sys.stdout, indent=2)
+        sys.stdout.write("\n")
+    elif len(argv) == 3 and argv[1] == "header":
+        with open(argv[2]) as f:
+            sys.stdout.write(header(json.load(f), argv[2].split("/")[-1]))
+    elif len(argv) == 5 and argv[1] == "param":
+        with open(argv[2]) as f:
+            config = json.load(f)
+        if argv[3] not in config:
+            sys.exit(f"om_export: no field {argv[3]} in {argv[2]}")
+        sys.stdout.write(header(config[argv[3]], argv[2].split("/")[-1], argv[4]))
+    else:
+        sys.exit("usage: om_export.py json <design.fir> <Class> | header <Class.json> | "
+                 "param <config.json> <field> <PREFIX>")
+
+
+if __name__ == "__main__":
+    main(sys.argv)
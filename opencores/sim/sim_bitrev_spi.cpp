@@ -3,10 +3,16 @@
 // Wiring done in Chisel (SPIBitRevTop). C++ only drives APB.
 // 16-bit SPI transfer: upper 8 bits to slave, lower 8 bits reversed back
 // SPI Mode 0: CPOL=0, CPHA=0 (tx_neg=1, rx_neg=0)
+// The last test lets the master's RX transform (XFORM.RX BITREV) undo the
+// slave's reversal, so software sees the byte it sent.
+//
+// Plusargs:
+//   +workload=N   after the tests, run N bit-reverse transfers
+//                 (used by `make bench_profiles`)
 
 #include "VSPIBitRevTop.h"
+#include "sim_common.h"
 #include "verilated.h"
-#include "verilated_vcd_c.h"
 #include <cstdio>
 #include <cstdlib>
 #include <cstdint>
@@ -15,13 +21,16 @@ static constexpr uint8_t ADDR_TX0    = 0 << 2;
 static constexpr uint8_t ADDR_CTRL   = 4 << 2; // 16
 static constexpr uint8_t ADDR_DIVIDE = 5 << 2;
 static constexpr uint8_t ADDR_SS     = 6 << 2;
+static constexpr uint8_t ADDR_XFORM  = 9 << 2;
+
+static constexpr uint32_t XFORM_BITREV = 1 << 2; // DataTransform field
 
 static constexpr uint32_t CTRL_GO     = 1 << 8;
 static constexpr uint32_t CTRL_TX_NEG = 1 << 10;
 static constexpr uint32_t CTRL_ASS    = 1 << 13;
 
 static VSPIBitRevTop* dut = nullptr;
-static VerilatedVcdC* tfp = nullptr;
+static SimTrace<VSPIBitRevTop> trace;
 static uint64_t       sim_time = 0;
 static int            test_pass = 0;
 static int            test_fail = 0;
@@ -29,10 +38,10 @@ static int            test_fail = 0;
 static void tick() {
     dut->clock = 1;
     dut->eval();
-    if (tfp) tfp->dump(sim_time++);
+    trace.dump(sim_time++);
     dut->clock = 0;
     dut->eval();
-    if (tfp) tfp->dump(sim_time++);
+    trace.dump(sim_time++);
 }
 
 static void do_reset() {
@@ -119,15 +128,28 @@ static uint8_t bitrev_transfer(uint8_t tx_byte, uint32_t divider) {
     return (uint8_t)(rx & 0xFF);
 }
 
+static void run_workload(uint64_t n) {
+    int errors = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        uint8_t tx = (uint8_t)(i * 37 + 11);
+        uint8_t rx = bitrev_transfer(tx, 4);
+        if (rx != bit_reverse(tx) && errors++ < 8)
+            printf("  FAIL workload #%llu: bitrev(0x%02X) = 0x%02X\n",
+                   (unsigned long long)i, tx, rx);
+    }
+    if (errors) test_fail++; else test_pass++;
+    printf("  workload: %llu transfers, %d mismatches\n",
+           (unsigned long long)n, errors);
+}
+
 int main(int argc, char** argv) {
     VerilatedContext* contextp = new VerilatedContext;
     contextp->commandArgs(argc, argv);
     contextp->traceEverOn(true);
 
     dut = new VSPIBitRevTop{contextp};
-    tfp = new VerilatedVcdC;
-    dut->trace(tfp, 99);
-    tfp->open("build/bitrev_spi.vcd");
+    trace.open(dut, "build/bitrev_spi.vcd");
+    SimPerf perf;
 
     printf("====================================================\n");
     printf("  SPI Master + BitRev Slave (Chisel wiring)\n");
@@ -168,15 +190,36 @@ int main(int argc, char** argv) {
         printf("\n");
     }
 
+    {
+        printf("-- Test: RX transform undoes the reversal --\n");
+        apb_write(ADDR_XFORM, XFORM_BITREV << 8);
+        for (uint8_t tx : {0x53, 0x01, 0xF0}) {
+            uint8_t rx = bitrev_transfer(tx, 4);
+            char name[48];
+            snprintf(name, sizeof(name), "XFORM.RX=BITREV (0x%02X)", tx);
+            check(name, tx, rx, 0xFF);
+        }
+        apb_write(ADDR_XFORM, 0);
+        printf("\n");
+    }
+
+    if (uint64_t n = plusarg_u64(contextp, "workload", 0)) {
+        printf("-- Workload: %llu transfers --\n", (unsigned long long)n);
+        run_workload(n);
+        printf("\n");
+    }
+
     for (int i = 0; i < 20; i++) tick();
 
     printf("====================================================\n");
     printf("  Results: %d passed, %d failed\n", test_pass, test_fail);
-    printf("  Waveform: build/bitrev_spi.vcd\n");
+    printf("  Waveform: %s\n", trace.path());
+    perf.report(sim_time / 2);
+    sim_coverage(contextp, "build/bitrev_spi_coverage.dat");
     printf("====================================================\n");
 
-    tfp->close();
-    delete tfp;
+    trace.close();
+    dut->final();
     delete dut;
     delete contextp;
     return test_fail > 0 ? 1 : 0;
@@ -13,21 +13,59 @@
 //   2. 16-bit SPI loopback
 //   3. 32-bit SPI loopback
 //   4. Register read/write verification
+//   5. Transfer cycles vs. the timing model published by SPIOM
+//   6. Interrupt moderation: interrupts per MB at several INT_CTRL settings
+//   7. TX / RX data transforms (XFORM) over a 64-bit loopback
+//   8. CTRL/DIVIDER/SS shadow registers: commit at GO, at completion,
+//      and AUTO_GO chaining
+//   9. Triggered transfers: period timer jitter, trigI latency, RX_BUF,
+//      MISS / OVF flags
+//  10. RX compare: matching passes stay silent, the first mismatch is
+//      reported with its transfer index and bit offset on intO
+//  11. Link efficiency: SCK cycles and SS overhead per transfer length,
+//      measured on the pins (link_monitor.h)
+//  12. Reference driver (driver/spi_drv.c) over the APB helpers: blocking
+//      buffer, scatter list and queued requests; cycles per API call
+//
+// Plusargs:
+//   +workload=N   after the tests, run N 32-bit loopback transfers
+//                 (used by `make bench_profiles`)
+//   +irq_xfers=N  transfers per setting in test 6 (default 250)
+//
+// With +workload the run ends with the link efficiency report of the
+// workload transfers.
 ///////////////////////////////////////////////////////////////////////////////
 
+#include "SPIOM.h"
 #include "VSPI.h"
+#include "link_monitor.h"
+#include "sim_common.h"
+#include "spi_drv.h"
 #include "verilated.h"
-#include "verilated_vcd_c.h"
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <memory>
-
-// ─── Register addresses (byte address, paddr[4:2] selects register) ─────
-static constexpr uint8_t ADDR_TX0    = 0 << 2;  // 0x00
-static constexpr uint8_t ADDR_TX1    = 1 << 2;  // 0x04
-static constexpr uint8_t ADDR_CTRL   = 4 << 2;  // 0x10
-static constexpr uint8_t ADDR_DIVIDE = 5 << 2;  // 0x14
-static constexpr uint8_t ADDR_SS     = 6 << 2;  // 0x18
+#include <vector>
+
+// ─── Register addresses (byte address, paddr[6:2] selects register) ─────
+static constexpr uint8_t ADDR_TX0        = 0 << 2;  // 0x00
+static constexpr uint8_t ADDR_TX1        = 1 << 2;  // 0x04
+static constexpr uint8_t ADDR_CTRL       = 4 << 2;  // 0x10
+static constexpr uint8_t ADDR_DIVIDE     = 5 << 2;  // 0x14
+static constexpr uint8_t ADDR_SS         = 6 << 2;  // 0x18
+static constexpr uint8_t ADDR_INT_CTRL   = 7 << 2;  // 0x1C
+static constexpr uint8_t ADDR_INT_STATUS = 8 << 2;  // 0x20
+static constexpr uint8_t ADDR_XFORM      = 9 << 2;  // 0x24
+static constexpr uint8_t ADDR_SHADOW     = 10 << 2; // 0x28
+static constexpr uint8_t ADDR_TRIG_CTRL  = 11 << 2; // 0x2C
+static constexpr uint8_t ADDR_TRIG_PER   = 12 << 2; // 0x30
+static constexpr uint8_t ADDR_TRIG_TX    = 13 << 2; // 0x34
+static constexpr uint8_t ADDR_RX_BUF     = 14 << 2; // 0x38
+static constexpr uint8_t ADDR_CMP_CTRL   = 15 << 2; // 0x3C
+static constexpr uint8_t ADDR_CMP_EXP    = 16 << 2; // 0x40
+static constexpr uint8_t ADDR_CMP_MASK   = 17 << 2; // 0x44
+static constexpr uint8_t ADDR_CMP_STAT   = 18 << 2; // 0x48
 
 // ─── Control register bits ──────────────────────────────────────────────
 static constexpr uint32_t CTRL_GO     = 1 << 8;
@@ -37,12 +75,90 @@ static constexpr uint32_t CTRL_LSB    = 1 << 11;
 static constexpr uint32_t CTRL_IE     = 1 << 12;
 static constexpr uint32_t CTRL_ASS    = 1 << 13;
 
+// ─── INT_STATUS bits ────────────────────────────────────────────────────
+static constexpr uint32_t INT_CNT = 1 << 0;
+static constexpr uint32_t INT_TMO = 1 << 1;
+
+// ─── SHADOW bits ────────────────────────────────────────────────────────
+static constexpr uint32_t SHADOW_EN      = 1 << 0;
+static constexpr uint32_t SHADOW_AUTO_GO = 1 << 1;
+static constexpr uint32_t SHADOW_PENDING = 1 << 8;
+
+// ─── TRIG_CTRL bits ─────────────────────────────────────────────────────
+static constexpr uint32_t TRIG_TIMER_EN = 1 << 0;
+static constexpr uint32_t TRIG_EXT_EN   = 1 << 1;
+static constexpr uint32_t TRIG_MISS     = 1 << 8;
+static constexpr uint32_t TRIG_OVF      = 1 << 9;
+
+// ─── CMP_CTRL bits ──────────────────────────────────────────────────────
+static constexpr uint32_t CMP_EN   = 1 << 0;
+static constexpr uint32_t CMP_FAIL = 1 << 1;
+
+static uint32_t trig_level(uint32_t trig_ctrl) { return trig_ctrl >> 16 & 0xFF; }
+
+// ─── XFORM fields (DataTransform, shared/src/DataTransform.scala) ───────
+static constexpr uint32_t XF_BSWAP16 = 1;
+static constexpr uint32_t XF_BSWAP32 = 2;
+static constexpr uint32_t XF_BSWAP64 = 3;
+static constexpr uint32_t XF_BITREV  = 1 << 2;
+static constexpr uint32_t XF_NIBSWAP = 1 << 3;
+
+// Reference model: byte swap within groups, then per-byte bit reverse,
+// then per-byte nibble swap.
+static void xform_ref(uint8_t* b, int n, uint32_t x) {
+    static const int group[4] = {1, 2, 4, 8};
+    int g = group[x & 3] < n ? group[x & 3] : n;
+    uint8_t t[16];
+    for (int i = 0; i < n; i++) {
+        int base = i / g * g;
+        t[i] = b[base + g - 1 - (i - base)];
+    }
+    for (int i = 0; i < n; i++) {
+        uint8_t v = t[i];
+        if (x & XF_BITREV) {
+            uint8_t r = 0;
+            for (int k = 0; k < 8; k++) r |= ((v >> k) & 1) << (7 - k);
+            v = r;
+        }
+        if (x & XF_NIBSWAP) v = (uint8_t)(v << 4 | v >> 4);
+        b[i] = v;
+    }
+}
+
+// ─── Timing model published by SPIOM (spi/src/SPI.scala) ───────────────
+// OM_* come from SPIOM.h, generated from the elaborated SPI.fir
+// (om_export.py), so they always match the RTL that is simulated.
+// cycles(divider, bits) = goLatency + (halfPeriodsPerBit * bits + tailHalfPeriods) * (divider + 1)
+static int om_transfer_cycles(int divider, int bits) {
+    return OM_GO_LATENCY +
+           (OM_HALF_PERIODS_PER_BIT * bits + OM_TAIL_HALF_PERIODS) * (divider + 1);
+}
+
+// ─── Link phases ────────────────────────────────────────────────────────
+// A plain SPI transfer has no command or address of its own: every SCK
+// carries one payload bit on MOSI, SS_PAD_O[0] frames it.
+static LinkClass spi_classify(const LinkXfer& x) {
+    LinkClass c;
+    uint32_t n = (uint32_t)x.dio.size();
+    c.type = std::to_string(n) + "-bit";
+    c.sck[LINK_DATA] = n;
+    c.payload_bits = n;
+    return c;
+}
+
 // ─── Globals ────────────────────────────────────────────────────────────
 static VSPI*           dut = nullptr;
-static VerilatedVcdC*  tfp = nullptr;
+static SimTrace<VSPI>  trace;
 static uint64_t        sim_time = 0;
 static int             test_pass = 0;
 static int             test_fail = 0;
+static uint64_t        irq_edges = 0;   // rising edges of intO
+static bool            int_prev  = false;
+static uint64_t        sck_rises = 0;   // rising edges of sclkPadO
+static bool            sck_prev  = false;
+static bool            ss0_prev  = true;
+static std::vector<uint64_t> xfer_starts; // cycle of each ss_pad_o[0] fall
+static LinkMonitor     link_mon(1, spi_classify);
 
 // ─── Clock tick ─────────────────────────────────────────────────────────
 // One full system clock cycle (falling edge → rising edge)
@@ -52,13 +168,21 @@ static void tick() {
     dut->clock = 1;
     dut->misoPadI = dut->mosiPadO;  // loopback
     dut->eval();
-    if (tfp) tfp->dump(sim_time++);
+    trace.dump(sim_time++);
+    if (dut->intO && !int_prev) irq_edges++;
+    int_prev = dut->intO;
+    if (dut->sclkPadO && !sck_prev) sck_rises++;
+    sck_prev = dut->sclkPadO;
+    bool ss0 = dut->ssPadO & 1;
+    if (!ss0 && ss0_prev) xfer_starts.push_back(sim_time / 2);
+    ss0_prev = ss0;
+    link_mon.sample(ss0, dut->sclkPadO, dut->mosiPadO);
 
     // Falling edge
     dut->clock = 0;
     dut->misoPadI = dut->mosiPadO;  // loopback
     dut->eval();
-    if (tfp) tfp->dump(sim_time++);
+    trace.dump(sim_time++);
 }
 
 // ─── Reset ──────────────────────────────────────────────────────────────
@@ -72,6 +196,7 @@ static void do_reset() {
     dut->paddr    = 0;
     dut->pwdata   = 0;
     dut->misoPadI = 0;
+    dut->trigI    = 0;
 
     for (int i = 0; i < 10; i++) tick();
 
@@ -111,11 +236,14 @@ static uint32_t apb_read(uint8_t addr) {
     dut->penable = 0;
     tick();
 
-    // ACCESS phase: PENABLE=1, wait for PREADY
+    // ACCESS phase: PENABLE=1, wait for PREADY. prdata is sampled before
+    // the completing edge, as a real APB master does: registers with read
+    // side effects (RX_BUF pops) change on that edge
     dut->penable = 1;
-    do { tick(); } while (!dut->pready);
-
+    dut->eval();
+    while (!dut->pready) tick();
     uint32_t data = dut->prdata;
+    tick();
 
     // IDLE phase: PSEL=0, PENABLE=0
     dut->psel    = 0;
@@ -154,6 +282,90 @@ static uint32_t spi_transfer(uint32_t tx_data, uint32_t char_len,
     return apb_read(ADDR_TX0);
 }
 
+// ─── Driver MMIO ────────────────────────────────────────────────────────
+// driver/spi_drv.c runs on the APB helpers; the SPI registers are 32-bit
+// only, so the narrow stores are never used.
+static uint32_t drv_read32(void*, uint32_t off) { return apb_read((uint8_t)off); }
+static void drv_write32(void*, uint32_t off, uint32_t val) { apb_write((uint8_t)off, val); }
+static const drv_mmio drv_io = {drv_read32, drv_write32, nullptr, nullptr, nullptr};
+
+static void drv_cost(const char* api, size_t bytes, uint64_t cycles) {
+    printf("  %-26s %5zu B %7llu cycles %7.2f cycles/B\n", api, bytes,
+           (unsigned long long)cycles, bytes ? (double)cycles / bytes : 0.0);
+}
+
+// ─── Measured transfer length ───────────────────────────────────────────
+// Counts cycles from the CTRL write that sets GO (the APB access edge) to
+// the edge that raises intO, which is the edge ending the transfer.
+static int measure_transfer_cycles(uint32_t char_len, uint32_t divider) {
+    apb_write(ADDR_DIVIDE, divider);
+    apb_write(ADDR_SS, 0x01);
+    apb_write(ADDR_TX0, 0xA5A5A5A5);
+    // apb_write returns after its IDLE tick, one cycle past the access edge
+    apb_write(ADDR_CTRL, char_len | CTRL_GO | CTRL_IE | CTRL_ASS | CTRL_TX_NEG);
+    int cycles = 1;
+    while (!dut->intO) {
+        tick();
+        if (++cycles > 1000000) break;
+    }
+    apb_read(ADDR_TX0); // any APB access clears intO
+    return cycles;
+}
+
+// ─── Workload (benchmark) ───────────────────────────────────────────────
+static void run_workload(uint64_t n) {
+    uint32_t lcg    = 0xC0FFEE11;
+    int      errors = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        lcg = lcg * 1664525u + 1013904223u;
+        uint32_t rx = spi_transfer(lcg, 32, 4);
+        if (rx != lcg && errors++ < 8)
+            printf("  FAIL workload #%llu: expected 0x%08X, got 0x%08X\n",
+                   (unsigned long long)i, lcg, rx);
+    }
+    if (errors) test_fail++; else test_pass++;
+    printf("  workload: %llu transfers, %d mismatches\n",
+           (unsigned long long)n, errors);
+}
+
+// ─── Interrupt moderation ───────────────────────────────────────────────
+// Streams `n` 64-bit transfers at divider 0 the way a driver would: load
+// TX, set GO, poll CTRL.GO until the shift register is free again. An
+// "ISR" runs whenever intO is high between transfers and acknowledges
+// both causes. With THRESH = 0 (original behaviour) the polling read
+// itself clears intO. Returns the interrupts raised (rising edges).
+static uint64_t run_moderated(uint32_t thresh, uint32_t timeout, int n,
+                              uint64_t* cycles) {
+    apb_write(ADDR_INT_CTRL, timeout << 16 | thresh);
+    apb_write(ADDR_INT_STATUS, INT_CNT | INT_TMO); // start an empty batch
+    apb_write(ADDR_DIVIDE, 0);
+    apb_write(ADDR_SS, 0x01);
+
+    auto service = [&] {
+        if (thresh && dut->intO) {
+            uint32_t st = apb_read(ADDR_INT_STATUS);
+            apb_write(ADDR_INT_STATUS, st & (INT_CNT | INT_TMO));
+        }
+    };
+
+    uint64_t irq0 = irq_edges, t0 = sim_time;
+    for (int i = 0; i < n; i++) {
+        apb_write(ADDR_TX0, 0x5A5A0000u | i);
+        apb_write(ADDR_TX1, ~0x5A5A0000u ^ i);
+        apb_write(ADDR_CTRL, 64 | CTRL_GO | CTRL_IE | CTRL_ASS | CTRL_TX_NEG);
+        while (apb_read(ADDR_CTRL) & CTRL_GO) {}
+        service();
+    }
+    // Let the timer flush a partial batch
+    for (uint32_t c = 0; c < timeout + 2; c++) tick();
+    service();
+    *cycles = (sim_time - t0) / 2;
+
+    apb_write(ADDR_INT_CTRL, 0);
+    apb_write(ADDR_CTRL, 0);
+    return irq_edges - irq0;
+}
+
 // ═══════════════════════════════════════════════════════════════════════════
 int main(int argc, char** argv) {
     VerilatedContext* contextp = new VerilatedContext;
@@ -161,9 +373,8 @@ int main(int argc, char** argv) {
     contextp->traceEverOn(true);
 
     dut = new VSPI{contextp};
-    tfp = new VerilatedVcdC;
-    dut->trace(tfp, 99);
-    tfp->open("build/chisel_spi.vcd");
+    trace.open(dut, "build/chisel_spi.vcd");
+    SimPerf perf;
 
     printf("════════════════════════════════════════════════════\n");
     printf("  Chisel SPI Master (APB) - Verilator Simulation\n");
@@ -223,17 +434,376 @@ int main(int argc, char** argv) {
         printf("\n");
     }
 
+    // ─── Test 5: Timing vs. object model ────────────────
+    {
+        printf("── Test 5: Transfer cycles vs. SPIOM timing model ──\n");
+        // CHAR_LEN = 0 means no transfer, so the longest one is maxPayloadBits
+        struct { uint32_t div, bits; } cases[] = {
+            {0, 8}, {1, 8}, {4, 16}, {3, 32}, {2, OM_MAX_PAYLOAD_BITS}};
+        for (const auto& c : cases) {
+            char name[64];
+            snprintf(name, sizeof(name), "cycles(div=%u, bits=%u)", c.div, c.bits);
+            check(name, om_transfer_cycles(c.div, c.bits),
+                  measure_transfer_cycles(c.bits, c.div));
+        }
+        check("minCyclesPerTransfer", OM_MIN_CYCLES_PER_TRANSFER,
+              measure_transfer_cycles(OM_MAX_PAYLOAD_BITS, 0));
+        printf("\n");
+    }
+
+    // ─── Test 6: Interrupt moderation ───────────────────
+    {
+        int n = (int)plusarg_u64(contextp, "irq_xfers", 250);
+        printf("── Test 6: Interrupt moderation (%d x 64-bit transfers, div=0) ──\n", n);
+
+        apb_write(ADDR_INT_CTRL, 0x12340010);
+        check("INT_CTRL register", 0x12340010, apb_read(ADDR_INT_CTRL));
+
+        // TIMEOUT covers a full 16-transfer batch, so it only flushes the tail
+        struct { uint32_t thresh, timeout; int expected; } cases[] = {
+            {0,  0,    n},
+            {1,  0,    n},
+            {4,  0,    n / 4},
+            {16, 0,    n / 16},
+            {16, 8192, (n + 15) / 16},
+            {255, 2048, -1},
+        };
+        double mb = n * 8.0 / (1 << 20);
+        for (const auto& c : cases) {
+            uint64_t cycles = 0;
+            uint64_t irqs = run_moderated(c.thresh, c.timeout, n, &cycles);
+            printf("  THRESH=%3u TIMEOUT=%5u: %5llu irqs, %9.1f irqs/MB, %llu cycles\n",
+                   c.thresh, c.timeout, (unsigned long long)irqs, irqs / mb,
+                   (unsigned long long)cycles);
+            if (c.expected >= 0) {
+                char name[64];
+                snprintf(name, sizeof(name), "irqs(THRESH=%u, TIMEOUT=%u)", c.thresh, c.timeout);
+                check(name, c.expected, (uint32_t)irqs);
+            }
+        }
+        printf("\n");
+    }
+
+    // ─── Test 7: Data transforms ────────────────────────
+    {
+        printf("── Test 7: XFORM over a 64-bit loopback (div=4) ──\n");
+        struct { uint32_t tx, rx; const char* name; } cases[] = {
+            {XF_BSWAP32, 0, "TX bswap32"},
+            {XF_BSWAP16 | XF_NIBSWAP, 0, "TX bswap16+nibswap"},
+            {XF_BITREV, 0, "TX bitrev"},
+            {0, XF_BSWAP64, "RX bswap64"},
+            {XF_BSWAP64, XF_BSWAP64, "TX/RX bswap64"},
+            {XF_BSWAP32 | XF_BITREV | XF_NIBSWAP, XF_BSWAP32 | XF_BITREV | XF_NIBSWAP, "TX/RX all"},
+        };
+        const uint32_t w0 = 0x33221100, w1 = 0x77665544;
+        apb_write(ADDR_DIVIDE, 4);
+        apb_write(ADDR_SS, 0x01);
+        for (const auto& c : cases) {
+            uint8_t b[8];
+            for (int i = 0; i < 4; i++) {
+                b[i]     = (uint8_t)(w0 >> (8 * i));
+                b[4 + i] = (uint8_t)(w1 >> (8 * i));
+            }
+            xform_ref(b, 8, c.tx); // shifted out, looped back
+            xform_ref(b, 8, c.rx); // applied on read
+            uint32_t e0 = b[0] | b[1] << 8 | b[2] << 16 | (uint32_t)b[3] << 24;
+            uint32_t e1 = b[4] | b[5] << 8 | b[6] << 16 | (uint32_t)b[7] << 24;
+
+            apb_write(ADDR_XFORM, c.rx << 8 | c.tx);
+            apb_write(ADDR_TX0, w0);
+            apb_write(ADDR_TX1, w1);
+            apb_write(ADDR_CTRL, 64 | CTRL_GO | CTRL_ASS | CTRL_TX_NEG);
+            uint32_t r0 = apb_read(ADDR_TX0);
+            uint32_t r1 = apb_read(ADDR_TX1);
+            char name[64];
+            snprintf(name, sizeof(name), "%s RX_0", c.name);
+            check(name, e0, r0);
+            snprintf(name, sizeof(name), "%s RX_1", c.name);
+            check(name, e1, r1);
+        }
+        apb_write(ADDR_XFORM, 0);
+        printf("\n");
+    }
+
+    // ─── Test 8: Shadow registers ───────────────────────
+    {
+        printf("── Test 8: CTRL/DIVIDER/SS shadow registers ──\n");
+        apb_write(ADDR_SHADOW, SHADOW_EN);
+        check("SHADOW register", SHADOW_EN, apb_read(ADDR_SHADOW));
+
+        // Idle: staged values stay invisible until the next GO
+        apb_write(ADDR_DIVIDE, 2);
+        check("DIVIDER before GO", 4, apb_read(ADDR_DIVIDE));
+        check("PENDING before GO", SHADOW_EN | SHADOW_PENDING, apb_read(ADDR_SHADOW));
+        check("cycles(div=2 via shadow, bits=32)", om_transfer_cycles(2, 32),
+              measure_transfer_cycles(32, 2));
+        check("DIVIDER after GO", 2, apb_read(ADDR_DIVIDE));
+
+        // During a transfer: writes complete at once, commit at the end
+        apb_write(ADDR_TX0, 0x0F0F0F0F);
+        apb_write(ADDR_CTRL, 64 | CTRL_GO | CTRL_ASS | CTRL_TX_NEG);
+        uint64_t t0 = sim_time;
+        apb_write(ADDR_DIVIDE, 1);
+        apb_write(ADDR_SS, 0x02);
+        uint64_t staged_cycles = (sim_time - t0) / 2;
+        printf("  two staged writes during a transfer: %llu cycles\n",
+               (unsigned long long)staged_cycles);
+        check("staged writes do not stall", 1, staged_cycles < 10);
+        check("DIVIDER during transfer", 2, apb_read(ADDR_DIVIDE));
+        check("PENDING during transfer", SHADOW_EN | SHADOW_PENDING, apb_read(ADDR_SHADOW));
+        while (apb_read(ADDR_CTRL) & CTRL_GO) {}
+        check("DIVIDER after completion", 1, apb_read(ADDR_DIVIDE));
+        check("SS after completion", 0x02, apb_read(ADDR_SS));
+        check("PENDING after completion", SHADOW_EN, apb_read(ADDR_SHADOW));
+
+        // AUTO_GO: a GO staged during a transfer starts the next one, which
+        // shifts the looped-back data out again
+        apb_write(ADDR_SHADOW, SHADOW_EN | SHADOW_AUTO_GO);
+        apb_write(ADDR_SS, 0x01);
+        apb_write(ADDR_TX0, 0xC0DEFACE);
+        apb_write(ADDR_CTRL, 32 | CTRL_GO | CTRL_ASS | CTRL_TX_NEG);
+        uint64_t sck0 = sck_rises;
+        apb_write(ADDR_DIVIDE, 0);
+        apb_write(ADDR_CTRL, 32 | CTRL_GO | CTRL_ASS | CTRL_TX_NEG);
+        while (apb_read(ADDR_CTRL) & CTRL_GO) {}
+        check("SCK pulses for two transfers", 64, (uint32_t)(sck_rises - sck0));
+        check("RX after AUTO_GO", 0xC0DEFACE, apb_read(ADDR_TX0));
+        check("DIVIDER after AUTO_GO", 0, apb_read(ADDR_DIVIDE));
+
+        apb_write(ADDR_SHADOW, 0);
+        apb_write(ADDR_CTRL, 0);
+        printf("\n");
+    }
+
+    // ─── Test 9: Triggered transfers ────────────────────
+    {
+        printf("── Test 9: Timer / trigI started transfers into RX_BUF ──\n");
+        const uint32_t period = 200, tx = 0x5AC3E10F;
+        // Distinct TX word per triggered transfer, so RX_BUF order is checked
+        auto sample = [&](size_t i) { return tx ^ (uint32_t)(i * 0x01010101u); };
+        apb_write(ADDR_DIVIDE, 0);
+        apb_write(ADDR_SS, 0x01);
+        apb_write(ADDR_CTRL, 32 | CTRL_ASS | CTRL_TX_NEG); // no GO
+        apb_write(ADDR_TRIG_PER, period);
+        apb_write(ADDR_TRIG_TX, sample(0));
+        check("TRIG_PERIOD register", period, apb_read(ADDR_TRIG_PER));
+
+        // Period timer: the CPU stays idle, samples land in RX_BUF
+        const int n = OM_RX_BUF_DEPTH + 2;
+        xfer_starts.clear();
+        apb_write(ADDR_TRIG_CTRL, TRIG_TIMER_EN);
+        // TRIG_TX is taken when a transfer starts; stage the next word
+        // as soon as SS drops
+        const uint64_t end = sim_time / 2 + n * period + period / 2;
+        size_t staged = 0;
+        while (sim_time / 2 < end) {
+            tick();
+            if (xfer_starts.size() > staged) {
+                staged = xfer_starts.size();
+                apb_write(ADDR_TRIG_TX, sample(staged));
+            }
+        }
+        apb_write(ADDR_TRIG_CTRL, 0);
+        check("timer transfers", n, (uint32_t)xfer_starts.size());
+        uint64_t jitter = 0;
+        for (size_t i = 1; i < xfer_starts.size(); i++) {
+            uint64_t d = xfer_starts[i] - xfer_starts[i - 1];
+            jitter = std::max(jitter, d > period ? d - period : period - d);
+        }
+        printf("  %zu transfers, max deviation from %u-cycle period: %llu cycles\n",
+               xfer_starts.size(), period, (unsigned long long)jitter);
+        check("timer jitter", 0, (uint32_t)jitter);
+
+        uint32_t st = apb_read(ADDR_TRIG_CTRL);
+        check("RX_LEVEL full", OM_RX_BUF_DEPTH, trig_level(st));
+        check("OVF after overrun", TRIG_OVF, st & (TRIG_OVF | TRIG_MISS));
+        int errors = 0;
+        for (int i = 0; i < OM_RX_BUF_DEPTH; i++) errors += apb_read(ADDR_RX_BUF) != sample(i);
+        check("RX_BUF samples in order", 0, errors);
+        check("RX_BUF empty", 0, apb_read(ADDR_RX_BUF));
+        apb_write(ADDR_TRIG_CTRL, TRIG_OVF);
+        check("OVF cleared", 0, apb_read(ADDR_TRIG_CTRL));
+
+        // External trigger: fixed latency from the trigI edge to tip
+        const uint32_t tx_a = 0x13579BDF, tx_b = 0x2468ACE0;
+        apb_write(ADDR_TRIG_TX, tx_a);
+        apb_write(ADDR_TRIG_CTRL, TRIG_EXT_EN);
+        dut->trigI = 1;
+        int lat = 0;
+        do { tick(); lat++; } while ((dut->ssPadO & 1) && lat < 100);
+        check("trigI -> tip latency", OM_TRIG_LATENCY, lat);
+        for (int c = 0; c < 100; c++) tick();
+        dut->trigI = 0;
+        tick();
+
+        // A second edge during a transfer is dropped and flagged
+        apb_write(ADDR_DIVIDE, 4);
+        apb_write(ADDR_TRIG_TX, tx_b);
+        for (int k = 0; k < 2; k++) {
+            dut->trigI = 1;
+            for (int c = 0; c < 8; c++) tick();
+            dut->trigI = 0;
+            for (int c = 0; c < 8; c++) tick();
+        }
+        while (apb_read(ADDR_CTRL) & CTRL_GO) {}
+        st = apb_read(ADDR_TRIG_CTRL);
+        check("MISS on busy trigger", TRIG_MISS, st & (TRIG_OVF | TRIG_MISS));
+        check("RX_LEVEL after trigI", 2, trig_level(st));
+        check("RX_BUF trigI sample", tx_a, apb_read(ADDR_RX_BUF));
+        check("RX_BUF trigI sample 2", tx_b, apb_read(ADDR_RX_BUF));
+
+        apb_write(ADDR_TRIG_CTRL, TRIG_MISS);
+        apb_write(ADDR_CTRL, 0);
+        printf("\n");
+    }
+
+    // ─── Test 10: RX compare ────────────────────────────
+    {
+        printf("── Test 10: RX compare over 64-bit loopback transfers ──\n");
+        const uint32_t exp = 0xA5A55A5A;
+        apb_write(ADDR_DIVIDE, 0);
+        apb_write(ADDR_SS, 0x01);
+        apb_write(ADDR_CMP_EXP, exp);
+        apb_write(ADDR_CMP_MASK, 0xFFFFFFFF);
+        apb_write(ADDR_CMP_CTRL, CMP_EN);
+        check("CMP_CTRL register", CMP_EN, apb_read(ADDR_CMP_CTRL));
+
+        // Five verify transfers, the fourth carries a flipped bit 37.
+        // IE is set, but only the failure may interrupt.
+        uint64_t irq0 = irq_edges;
+        for (int i = 0; i < 5; i++) {
+            apb_write(ADDR_TX0, exp);
+            apb_write(ADDR_TX1, i == 3 ? exp ^ 1u << 5 : exp);
+            apb_write(ADDR_CTRL, 64 | CTRL_GO | CTRL_IE | CTRL_ASS | CTRL_TX_NEG);
+            while (apb_read(ADDR_CTRL) & CTRL_GO) {}
+            if (i == 2) check("no intO while matching", 0, (uint32_t)(irq_edges - irq0));
+        }
+        check("FAIL after mismatch", CMP_EN | CMP_FAIL, apb_read(ADDR_CMP_CTRL));
+        check("intO on failure", 1, dut->intO);
+        check("CMP_STAT (xfer 3, bit 37)", 3u << 16 | 37, apb_read(ADDR_CMP_STAT));
+        apb_write(ADDR_CMP_CTRL, CMP_EN | CMP_FAIL);
+        check("intO after clear", 0, dut->intO);
+
+        // The masked bit is ignored
+        apb_write(ADDR_CMP_MASK, ~(1u << 5));
+        apb_write(ADDR_TX1, exp ^ 1u << 5);
+        apb_write(ADDR_CTRL, 64 | CTRL_GO | CTRL_ASS | CTRL_TX_NEG);
+        while (apb_read(ADDR_CTRL) & CTRL_GO) {}
+        check("masked bit ignored", CMP_EN, apb_read(ADDR_CMP_CTRL));
+
+        // CMP_EXP written during a transfer applies to the next one
+        apb_write(ADDR_CMP_MASK, 0xFFFFFFFF);
+        apb_write(ADDR_TX1, exp);
+        apb_write(ADDR_CTRL, 64 | CTRL_GO | CTRL_ASS | CTRL_TX_NEG);
+        apb_write(ADDR_CMP_EXP, ~exp);
+        while (apb_read(ADDR_CTRL) & CTRL_GO) {}
+        check("CMP_EXP taken at start", CMP_EN, apb_read(ADDR_CMP_CTRL));
+        apb_write(ADDR_TX0, ~exp);
+        apb_write(ADDR_TX1, ~exp);
+        apb_write(ADDR_CTRL, 64 | CTRL_GO | CTRL_ASS | CTRL_TX_NEG);
+        while (apb_read(ADDR_CTRL) & CTRL_GO) {}
+        check("next transfer uses new CMP_EXP", CMP_EN, apb_read(ADDR_CMP_CTRL));
+
+        apb_write(ADDR_CMP_CTRL, 0);
+        apb_write(ADDR_CTRL, 0);
+        printf("\n");
+    }
+
+    // ─── Test 11: Link efficiency ───────────────────────
+    {
+        printf("── Test 11: Link efficiency from the pins (div=0) ──\n");
+        const int n = 8;
+        apb_write(ADDR_DIVIDE, 0);
+        apb_write(ADDR_SS, 0x01);
+        link_mon.clear();
+        for (uint32_t len : {8u, 64u}) {
+            for (int i = 0; i < n; i++) {
+                apb_write(ADDR_TX0, 0x5A5A5A5A);
+                apb_write(ADDR_TX1, 0x5A5A5A5A);
+                apb_write(ADDR_CTRL, (len & 0x7F) | CTRL_GO | CTRL_ASS | CTRL_TX_NEG);
+                while (apb_read(ADDR_CTRL) & CTRL_GO) {}
+            }
+            check("data SCK cycles", len, link_mon.last().sck[LINK_DATA]);
+        }
+        link_mon.report("SPI");
+        const LinkStats* s8  = link_mon.stats("8-bit");
+        const LinkStats* s64 = link_mon.stats("64-bit");
+        check("transfers seen", 2 * n, (uint32_t)link_mon.aggregate().count);
+        check("64-bit beats 8-bit efficiency", 1,
+              s8 && s64 && s64->efficiency() > s8->efficiency());
+        apb_write(ADDR_CTRL, 0);
+        link_mon.clear();
+        printf("\n");
+    }
+
+    // ─── Test 12: Reference driver ──────────────────────
+    {
+        printf("── Test 12: Reference driver (driver/spi_drv.c, div=0) ──\n");
+        const size_t len = 64;
+        uint8_t tx[len], rx[len];
+        uint32_t lcg = 0x5EED5u;
+        for (size_t i = 0; i < len; i++) {
+            lcg = lcg * 1664525u + 1013904223u;
+            tx[i] = (uint8_t)(lcg >> 24);
+        }
+        spi_dev sd;
+        spi_init(&sd, &drv_io, 0, SPI_CTRL_TX_NEG);
+
+        std::fill(rx, rx + len, 0);
+        uint64_t c0 = sim_time / 2;
+        spi_xfer(&sd, 0x01, tx, rx, len);
+        drv_cost("spi_xfer", len, sim_time / 2 - c0);
+        check("spi_xfer loopback", 1, std::equal(tx, tx + len, rx));
+
+        // Command + address + data in one SS frame, address not read back
+        spi_seg sg[3] = {{tx, rx, 1}, {tx + 1, nullptr, 3}, {tx + 4, rx + 4, 16}};
+        std::fill(rx, rx + len, 0);
+        c0 = sim_time / 2;
+        spi_xfer_sg(&sd, 0x01, sg, 3);
+        drv_cost("spi_xfer_sg (3 segments)", 20, sim_time / 2 - c0);
+        check("scatter list loopback", 1,
+              rx[0] == tx[0] && rx[1] == 0 && std::equal(tx + 4, tx + 20, rx + 4));
+
+        // Two queued requests, polled the way a main loop would
+        spi_req r[2] = {{{tx, rx, 40}, 0x01, 0, nullptr}, {{tx + 40, rx + 40, 24}, 0x01, 0, nullptr}};
+        std::fill(rx, rx + len, 0);
+        c0 = sim_time / 2;
+        spi_submit(&sd, &r[0]);
+        spi_submit(&sd, &r[1]);
+        drv_cost("spi_submit x2", 0, sim_time / 2 - c0);
+        int polls = 0;
+        c0 = sim_time / 2;
+        while (spi_poll(&sd)) polls++;
+        drv_cost("spi_poll until idle", len, sim_time / 2 - c0);
+        printf("  %d polls\n", polls);
+        check("queued requests done", 1, r[0].done && r[1].done);
+        check("queued loopback", 1, std::equal(tx, tx + len, rx));
+
+        apb_write(ADDR_CTRL, 0);
+        printf("\n");
+    }
+
+    // ─── Workload (optional) ────────────────────────────
+    if (uint64_t n = plusarg_u64(contextp, "workload", 0)) {
+        printf("── Workload: %llu transfers ──\n", (unsigned long long)n);
+        run_workload(n);
+        printf("\n");
+    }
+
     // Extra cycles for waveform completeness
     for (int i = 0; i < 20; i++) tick();
 
     // ─── Summary ────────────────────────────────────────
     printf("════════════════════════════════════════════════════\n");
     printf("  Results: %d passed, %d failed\n", test_pass, test_fail);
-    printf("  Waveform: build/chisel_spi.vcd\n");
+    printf("  Waveform: %s\n", trace.path());
+    link_mon.report("SPI");
+    perf.report(sim_time / 2);
+    sim_coverage(contextp, "build/chisel_spi_coverage.dat");
     printf("════════════════════════════════════════════════════\n");
 
-    tfp->close();
-    delete tfp;
+    trace.close();
+    dut->final();
     delete dut;
     delete contextp;
 
@@ -0,0 +1,268 @@
+// sim_common.h
+// Helpers shared by the Verilator testbenches.
+//
+// The Makefile builds every harness under one of several profiles
+// (PROFILE=debug / fast-sim / sign-off). Waveform and coverage support
+// only exist when Verilator was invoked with --trace / --coverage, so the
+// harnesses go through these wrappers instead of touching VerilatedVcdC
+// or the coverage database directly.
+//
+//   SimTrace<Top>  - waveform writer, compiled out when VM_TRACE is 0
+//   sim_coverage() - writes coverage.dat when VM_COVERAGE is 1
+//   SimPerf        - wall-clock throughput report (cycles/s)
+//   plusarg_u64()  - numeric +name=value lookup
+//   sim_save() / sim_restore()
+//                  - model + harness checkpoints, only with SAVABLE=1
+//                    (--savable, SIM_SAVABLE)
+
+#pragma once
+
+#include "verilated.h"
+#if VM_TRACE_FST
+#include "verilated_fst_c.h"
+#elif VM_TRACE
+#include "verilated_vcd_c.h"
+#endif
+#if VM_COVERAGE
+#include "verilated_cov.h"
+#endif
+#if SIM_SAVABLE
+#include "verilated_save.h"
+#endif
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// ─── Waveform ──────────────────────────────────────────────────
+// TRACE=vcd writes the VCD on the simulation thread. TRACE=fst builds with
+// --trace-fst --trace-threads 2: dump() only copies the changed signals
+// into a bounded buffer that a writer thread compresses into the FST, and
+// blocks while that buffer is full. Harnesses pass a .vcd path; under FST
+// the extension is swapped.
+#if VM_TRACE_FST
+using SimTraceFile = VerilatedFstC;
+#elif VM_TRACE
+using SimTraceFile = VerilatedVcdC;
+#endif
+
+template <class Top> class SimTrace {
+public:
+  void open(Top *dut, const char *path) {
+#if VM_TRACE
+    file_ = path;
+#if VM_TRACE_FST
+    size_t dot = file_.rfind(".vcd");
+    if (dot != std::string::npos) file_.replace(dot, 4, ".fst");
+#endif
+    tfp_ = new SimTraceFile;
+    dut->trace(tfp_, 99);
+    tfp_->open(file_.c_str());
+    path_ = file_.c_str();
+#else
+    (void)dut;
+    (void)path;
+#endif
+  }
+
+  void dump(uint64_t time) {
+#if VM_TRACE
+    if (tfp_) tfp_->dump(time);
+#else
+    (void)time;
+#endif
+  }
+
+  void close() {
+#if VM_TRACE
+    if (tfp_) {
+      tfp_->close();
+      delete tfp_;
+      tfp_ = nullptr;
+    }
+#endif
+  }
+
+  // Path of the open waveform, or a note that tracing is compiled out.
+  const char *path() const { return path_; }
+
+private:
+#if VM_TRACE
+  SimTraceFile *tfp_ = nullptr;
+  std::string file_;
+#endif
+  const char *path_ = "(disabled by build profile)";
+};
+
+// ─── Coverage ──────────────────────────────────────────────────
+static inline void sim_coverage(VerilatedContext *contextp, const char *path) {
+#if VM_COVERAGE
+  contextp->coveragep()->write(path);
+  printf("  Coverage: %s\n", path);
+#else
+  (void)contextp;
+  (void)path;
+#endif
+}
+
+// ─── Plusargs ──────────────────────────────────────────────────
+// Returns the numeric value of +name=value, or `def` if absent.
+static inline uint64_t plusarg_u64(VerilatedContext *contextp, const char *name,
+                                   uint64_t def) {
+  std::string prefix = std::string("+") + name + "=";
+  std::string match = contextp->commandArgsPlusMatch(prefix.c_str() + 1);
+  if (match.compare(0, prefix.size(), prefix) != 0) return def;
+  return strtoull(match.c_str() + prefix.size(), nullptr, 0);
+}
+
+// ─── Throughput ────────────────────────────────────────────────
+// `make bench_profiles` greps the "Perf:" line, keep its format stable.
+class SimPerf {
+public:
+  double seconds() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0_)
+        .count();
+  }
+
+  void report(uint64_t cycles) const {
+    double s = seconds();
+    printf("  Perf: %llu cycles in %.3f s (%.0f cycles/s)\n",
+           (unsigned long long)cycles, s, s > 0 ? cycles / s : 0.0);
+  }
+
+private:
+  std::chrono::steady_clock::time_point t0_ = std::chrono::steady_clock::now();
+};
+
+// ─── Checkpoints ───────────────────────────────────────────────
+// A checkpoint is the model (VerilatedSave) followed by the harness state.
+// The harness describes its state once, as a function that visits every
+// variable through SimCkpt::io(); the same visit saves, restores, or
+// captures the state into a byte blob. A segmented run checks its end
+// state, model included, against the next checkpoint with sim_ckpt_match().
+class SimCkpt {
+public:
+  template <class T> void io(T &v) { bytes(&v, sizeof(v)); }
+
+  void bytes(void *p, size_t n) {
+#if SIM_SAVABLE
+    if (os_) {
+      os_->write(p, n);
+      return;
+    }
+    if (is_) {
+      is_->read(p, n);
+      return;
+    }
+#endif
+    const uint8_t *b = static_cast<const uint8_t *>(p);
+    blob_.insert(blob_.end(), b, b + n);
+  }
+
+  const std::vector<uint8_t> &blob() const { return blob_; }
+
+#if SIM_SAVABLE
+  VerilatedSerialize *os_ = nullptr;
+  VerilatedDeserialize *is_ = nullptr;
+#endif
+
+private:
+  std::vector<uint8_t> blob_;
+};
+
+static inline bool sim_read_file(const char *path, std::vector<uint8_t> &buf) {
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    printf("  checkpoint: cannot open %s\n", path);
+    return false;
+  }
+  buf.clear();
+  uint8_t chunk[65536];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) buf.insert(buf.end(), chunk, chunk + n);
+  fclose(f);
+  return true;
+}
+
+template <class State> static inline std::vector<uint8_t> sim_state_blob(State &&state) {
+  SimCkpt c;
+  state(c);
+  return c.blob();
+}
+
+template <class Top, class State>
+static inline bool sim_save(Top *dut, const char *path, State &&state) {
+#if SIM_SAVABLE
+  VerilatedSave os;
+  os.open(path);
+  if (!os.isOpen()) {
+    printf("  checkpoint: cannot create %s\n", path);
+    return false;
+  }
+  os << *dut;
+  SimCkpt c;
+  c.os_ = &os;
+  state(c);
+  os.close();
+  return true;
+#else
+  (void)dut;
+  (void)state;
+  printf("  checkpoint: %s not written, build with SAVABLE=1\n", path);
+  return false;
+#endif
+}
+
+template <class Top, class State>
+static inline bool sim_restore(Top *dut, const char *path, State &&state) {
+#if SIM_SAVABLE
+  VerilatedRestore is;
+  is.open(path);
+  if (!is.isOpen()) {
+    printf("  checkpoint: cannot open %s\n", path);
+    return false;
+  }
+  is >> *dut;
+  SimCkpt c;
+  c.is_ = &is;
+  state(c);
+  is.close();
+  return true;
+#else
+  (void)dut;
+  (void)state;
+  printf("  checkpoint: %s not restored, build with SAVABLE=1\n", path);
+  return false;
+#endif
+}
+
+// Saves the current model and harness state to `scratch` and compares it
+// byte for byte with the checkpoint at `path`, so RTL registers and
+// memories are checked as well as the harness. eval() first: it sets the
+// model's trace-activity flag, which is part of the saved state, to what
+// an untraced first pass left in it. The harness part is the last
+// `state` blob's worth of bytes, which tells the two kinds of mismatch
+// apart in the message.
+template <class Top, class State>
+static inline bool sim_ckpt_match(Top *dut, const char *path, const char *scratch,
+                                  State &&state) {
+  dut->eval();
+  if (!sim_save(dut, scratch, state)) return false;
+  std::vector<uint8_t> ref, mine;
+  if (!sim_read_file(path, ref) || !sim_read_file(scratch, mine)) return false;
+  size_t harness = sim_state_blob(state).size();
+  if (ref.size() != mine.size()) {
+    printf("  checkpoint: %s is %zu bytes, %s is %zu\n", scratch, mine.size(), path,
+           ref.size());
+    return false;
+  }
+  auto diff = std::mismatch(mine.begin(), mine.end(), ref.begin());
+  if (diff.first == mine.end()) return true;
+  size_t at = diff.first - mine.begin();
+  printf("  checkpoint: %s state differs from %s at byte %zu\n",
+         at + harness >= mine.size() ? "harness" : "model", path, at);
+  return false;
+}
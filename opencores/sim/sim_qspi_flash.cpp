@@ -0,0 +1,601 @@
+// sim_qspi_flash.cpp
+// QSPI Master + quad NOR flash test (Verilator)
+// Wiring done in Chisel (QSPIFlashTop). C++ drives APB and the flash's
+// programming header, and implements the DPI-C array (flash_cmd.sv).
+//
+// The array is an image file mapped with mmap(MAP_SHARED): a large image
+// is usable as soon as it is mapped, and everything programmed or erased
+// during the run is in the file afterwards. A new file is created erased
+// (all 0xFF); a shorter one is extended with erased bytes, a longer one is
+// rejected. Array size, ID and busy times come from the "flash" field of
+// configs/QSPIFlashTop.json (FlashParameter.h, generated by om_export.py).
+//
+// The master only issues QPI 0xEB reads and 0x38 programs, so the other
+// commands (status, ID, SFDP, erase, SPI-mode reads) go through the
+// programming header, which bit-bangs the flash pins while the master
+// sees an idle bus; this is also how an external programmer would reach
+// the part on a board.
+//
+// Test plan:
+//   1. Boot: the reset INIT table leaves the flash in QPI (QPI JEDEC ID)
+//   2. SPI mode: JEDEC ID, SFDP signature, density and fast-read opcodes
+//   3. Erase / program through the header: program without WREN is
+//      ignored, sector erase and page program busy times (status WIP /
+//      WEL), program only clears bits, commands other than RDSR ignored
+//      while busy
+//   4. XIP through the master matches the image, including what test 3
+//      programmed
+//   5. Programs through the master: write enable from the INIT table,
+//      word write, busy, AND semantics
+//   6. Persistence: a run counter in the image (one more cleared bit per
+//      run)
+//
+// Runs with +xip end with an XIP benchmark in the same format as
+// sim_qspi_psram (`make bench_xip` runs both on the same image).
+//
+// Plusargs:
+//   +flash=<file> image file (default build/flash.img)
+//   +erase        start from an erased image
+//   +load=<file>[@<addr>]
+//                 copy a raw binary or ELF image into the file, then run
+//                 the XIP benchmark
+//   +xip[=N]      run the XIP benchmark with N fetches in the fetch-like
+//                 pass (default: one per image word); without +load a
+//                 16 KiB pseudo-random image at 0x8000 is used
+
+#include "FlashParameter.h"
+#include "VQSPIFlashTop.h"
+#include "image_loader.h"
+#include "sim_common.h"
+#include "verilated.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ─── Flash array (DPI-C implementation, mmap'd image) ──────────
+static constexpr uint32_t FLASH_SIZE = FLASH_SIZE_BYTES;
+static uint8_t *flash_mem = nullptr;
+static int flash_fd = -1;
+
+extern "C" void flash_read(int addr, char *data) { *data = (char)flash_mem[(uint32_t)addr % FLASH_SIZE]; }
+
+extern "C" void flash_program(int addr, char data) { flash_mem[(uint32_t)addr % FLASH_SIZE] &= (uint8_t)data; }
+
+extern "C" void flash_erase(int addr, int len) {
+  memset(flash_mem + (uint32_t)addr % FLASH_SIZE, 0xFF, (uint32_t)len);
+}
+
+static bool flash_map(const char *path, bool erase) {
+  flash_fd = open(path, O_RDWR | O_CREAT, 0644);
+  struct stat st;
+  if (flash_fd < 0 || fstat(flash_fd, &st) != 0) {
+    printf("flash: cannot open %s\n", path);
+    return false;
+  }
+  // Never drop or overwrite existing contents: a longer image belongs to
+  // another part, a shorter one only gets erased bytes appended
+  uint64_t old_size = (uint64_t)st.st_size;
+  if (old_size > FLASH_SIZE) {
+    printf("flash: %s is %llu bytes, larger than the %u-byte array\n", path,
+           (unsigned long long)old_size, FLASH_SIZE);
+    return false;
+  }
+  if (old_size < FLASH_SIZE && ftruncate(flash_fd, FLASH_SIZE) != 0) {
+    printf("flash: cannot size %s\n", path);
+    return false;
+  }
+  void *p = mmap(nullptr, FLASH_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, flash_fd, 0);
+  if (p == MAP_FAILED) {
+    printf("flash: cannot map %s\n", path);
+    return false;
+  }
+  flash_mem = (uint8_t *)p;
+  uint64_t keep = erase ? 0 : old_size;
+  memset(flash_mem + keep, 0xFF, FLASH_SIZE - keep);
+  printf("flash: %s (%s, %u KiB)\n", path,
+         erase ? "erased" : old_size == 0 ? "new" : old_size < FLASH_SIZE ? "extended" : "existing",
+         FLASH_SIZE >> 10);
+  return true;
+}
+
+static void flash_unmap() {
+  if (!flash_mem) return;
+  msync(flash_mem, FLASH_SIZE, MS_SYNC);
+  munmap(flash_mem, FLASH_SIZE);
+  close(flash_fd);
+}
+
+// ─── Simulation globals ────────────────────────────────────────
+static VQSPIFlashTop *dut = nullptr;
+static SimTrace<VQSPIFlashTop> trace;
+static uint64_t sim_time = 0;
+static int test_pass = 0;
+static int test_fail = 0;
+
+static constexpr int MAX_CYCLES = 500000;
+
+// ─── Register map / flash parameters ───────────────────────────
+static constexpr uint32_t CSR_BASE      = 1u << 24;
+static constexpr uint32_t CSR_INIT_CTRL = CSR_BASE + (8 << 2);
+static constexpr uint32_t CSR_INIT_CMD(int i) { return CSR_BASE + ((16 + 2 * i) << 2); }
+static constexpr uint32_t INIT_RUN = 1 << 0;
+static constexpr uint32_t INIT_QPI = 1 << 8;
+static constexpr uint32_t init_count(uint32_t n) { return n << 8; }
+
+static constexpr int PROGRAM_CYCLES      = FLASH_PROGRAM_CYCLES;
+static constexpr int SECTOR_ERASE_CYCLES = FLASH_SECTOR_ERASE_CYCLES;
+static constexpr uint8_t log2_ceil(uint64_t n) { return n <= 1 ? 0 : 1 + log2_ceil((n + 1) / 2); }
+// FlashParameter.jedecId: manufacturer, memory type, address bits
+static const uint8_t JEDEC_ID[3] = {FLASH_MANUFACTURER, FLASH_MEMORY_TYPE, log2_ceil(FLASH_SIZE)};
+
+static constexpr uint8_t SR_WIP = 1 << 0;
+static constexpr uint8_t SR_WEL = 1 << 1;
+static constexpr uint8_t SR_QE  = 1 << 6;
+
+static constexpr uint32_t SCRATCH  = 0xFF0000; // sector erased by test 3
+static constexpr uint32_t RUN_WORD = 0xFFF000; // run counter (test 6)
+
+// ─── Clock tick ────────────────────────────────────────────────
+static void tick() {
+  dut->clock = 1;
+  dut->eval();
+  trace.dump(sim_time++);
+  dut->clock = 0;
+  dut->eval();
+  trace.dump(sim_time++);
+}
+
+// ─── Reset ─────────────────────────────────────────────────────
+static void do_reset() {
+  dut->reset = 0;
+  dut->clock = 0;
+  dut->psel = 0;
+  dut->penable = 0;
+  dut->pwrite = 0;
+  dut->pstrb = 0;
+  dut->paddr = 0;
+  dut->pwdata = 0;
+  dut->prog_en = 0;
+  dut->prog_sck = 0;
+  dut->prog_ce_n = 1;
+  dut->prog_dout = 0;
+  dut->eval();
+  dut->reset = 1;
+  for (int i = 0; i < 10; i++) tick();
+  dut->reset = 0;
+  tick();
+}
+
+// ─── APB write / read (wait for pready) ────────────────────────
+// Same phases as sim_qspi_psram.cpp: SETUP, ACCESS until pready, one
+// more cycle with penable held, IDLE.
+static void apb_write(uint32_t addr, uint32_t data, uint8_t strb = 0xF) {
+  dut->paddr = addr;
+  dut->pwdata = data;
+  dut->pstrb = strb;
+  dut->pwrite = 1;
+  dut->psel = 1;
+  dut->penable = 0;
+  tick();
+  dut->penable = 1;
+  int cycles = 0;
+  do {
+    tick();
+    if (++cycles > MAX_CYCLES) {
+      printf("  TIMEOUT: apb_write(0x%08X) did not complete\n", addr);
+      break;
+    }
+  } while (!dut->pready);
+  tick();
+  dut->psel = 0;
+  dut->penable = 0;
+  dut->pwrite = 0;
+  tick();
+}
+
+static uint32_t apb_read(uint32_t addr) {
+  dut->paddr = addr;
+  dut->pwrite = 0;
+  dut->pstrb = 0xF;
+  dut->psel = 1;
+  dut->penable = 0;
+  tick();
+  dut->penable = 1;
+  int cycles = 0;
+  do {
+    tick();
+    if (++cycles > MAX_CYCLES) {
+      printf("  TIMEOUT: apb_read(0x%08X) did not complete\n", addr);
+      return 0xDEADBEEF;
+    }
+  } while (!dut->pready);
+  uint32_t val = dut->prdata;
+  tick();
+  dut->psel = 0;
+  dut->penable = 0;
+  tick();
+  return val;
+}
+
+// ─── Check helper ──────────────────────────────────────────────
+static void check(const char *name, uint32_t expected, uint32_t actual,
+                  uint32_t mask = 0xFFFFFFFF) {
+  actual &= mask;
+  expected &= mask;
+  if (actual == expected) {
+    printf("  PASS %s: expected 0x%08X, got 0x%08X\n", name, expected, actual);
+    test_pass++;
+  } else {
+    printf("  FAIL %s: expected 0x%08X, got 0x%08X\n", name, expected, actual);
+    test_fail++;
+  }
+}
+
+static uint32_t mem_word(uint32_t addr) {
+  uint32_t w = 0;
+  for (int i = 3; i >= 0; i--)
+    w = w << 8 | flash_mem[(addr + i) % FLASH_SIZE];
+  return w;
+}
+
+// ─── Programming header ────────────────────────────────────────
+// SPI mode 0, two system cycles per SCK phase. In SPI mode the flash
+// drives DIO[1]; in QPI (and the quad phases) all four lanes. A bit is
+// sampled at the end of the low phase before the rising edge it belongs to.
+static void prog_begin() {
+  dut->prog_en = 1;
+  dut->prog_sck = 0;
+  dut->prog_ce_n = 1;
+  tick();
+  tick();
+  dut->prog_ce_n = 0;
+  tick();
+  tick();
+}
+
+static void prog_end() {
+  dut->prog_sck = 0;
+  tick();
+  tick();
+  dut->prog_ce_n = 1;
+  tick();
+  tick();
+  dut->prog_en = 0;
+  tick();
+}
+
+static uint8_t prog_byte(uint8_t out, bool quad) {
+  uint8_t in = 0;
+  for (int k = 0; k < (quad ? 2 : 8); k++) {
+    dut->prog_dout = quad ? (out >> (4 - 4 * k)) & 0xF : (out >> (7 - k)) & 1;
+    dut->prog_sck = 0;
+    tick();
+    tick();
+    in = quad ? (uint8_t)(in << 4 | (dut->qspi_dio & 0xF)) : (uint8_t)(in << 1 | (dut->qspi_dio >> 1 & 1));
+    dut->prog_sck = 1;
+    tick();
+    tick();
+  }
+  return in;
+}
+
+// One command: opcode, optional 24-bit address, `dummy` clocks, then
+// `n` bytes out of `tx` (program) or into `rx` (read).
+static void prog_cmd(bool qpi, uint8_t cmd, int64_t addr = -1, int dummy = 0,
+                     const uint8_t *tx = nullptr, uint8_t *rx = nullptr, int n = 0) {
+  prog_begin();
+  prog_byte(cmd, qpi);
+  if (addr >= 0)
+    for (int s = 16; s >= 0; s -= 8) prog_byte((uint8_t)(addr >> s), qpi);
+  for (int i = 0; i < dummy; i++) { // single clocks
+    dut->prog_sck = 0;
+    tick();
+    tick();
+    dut->prog_sck = 1;
+    tick();
+    tick();
+  }
+  for (int i = 0; i < n; i++) {
+    uint8_t b = prog_byte(tx ? tx[i] : 0, qpi);
+    if (rx) rx[i] = b;
+  }
+  prog_end();
+}
+
+static uint8_t prog_status(bool qpi) {
+  uint8_t sr;
+  prog_cmd(qpi, 0x05, -1, 0, nullptr, &sr, 1);
+  return sr;
+}
+
+// Cycles until WIP clears, from the status port; the first poll is an
+// RDSR through the header, which must agree.
+static int wait_ready(bool qpi) {
+  uint64_t t0 = sim_time;
+  if (dut->flash_status & SR_WIP)
+    check("RDSR WIP while busy", SR_WIP, prog_status(qpi) & SR_WIP);
+  while (dut->flash_status & SR_WIP) {
+    tick();
+    if ((sim_time - t0) / 2 > MAX_CYCLES) {
+      printf("  TIMEOUT: flash stays busy\n");
+      test_fail++;
+      break;
+    }
+  }
+  return (int)((sim_time - t0) / 2);
+}
+
+// ─── XIP benchmark ─────────────────────────────────────────────
+static void xip_report(const char *name, uint64_t bytes, uint64_t cycles) {
+  printf("  %-10s %8llu bytes in %9llu cycles: %.4f bytes/cycle\n", name,
+         (unsigned long long)bytes, (unsigned long long)cycles,
+         cycles ? (double)bytes / cycles : 0.0);
+}
+
+static void run_xip(const std::vector<ImageSegment> &segs, uint64_t fetches) {
+  int errors = 0;
+  uint64_t words = 0;
+  auto verify = [&](uint32_t addr) {
+    uint32_t rd = apb_read(addr);
+    if (rd != mem_word(addr) && errors++ < 8)
+      printf("  FAIL xip @0x%06X: expected 0x%08X, got 0x%08X\n", addr, mem_word(addr), rd);
+  };
+
+  // Sequential
+  uint64_t t0 = sim_time;
+  for (const ImageSegment &seg : segs) {
+    for (uint32_t a = seg.addr & ~3u; a < seg.addr + seg.size; a += 4) {
+      verify(a);
+      words++;
+    }
+  }
+  xip_report("sequential", words * 4, (sim_time - t0) / 2);
+
+  // Fetch-like
+  if (fetches == 0) fetches = words;
+  uint32_t lcg = 0x2545F491;
+  uint64_t done = 0;
+  t0 = sim_time;
+  while (done < fetches) {
+    lcg = lcg * 1664525u + 1013904223u;
+    const ImageSegment &seg = segs[(lcg >> 8) % segs.size()];
+    uint32_t nwords = seg.size / 4 ? seg.size / 4 : 1;
+    uint32_t pc = (seg.addr & ~3u) + 4 * ((lcg >> 12) % nwords);
+    uint32_t run = 1 + (lcg >> 28);
+    for (uint32_t i = 0; i < run && done < fetches; i++, done++) {
+      verify(pc);
+      pc += 4;
+      if (pc >= seg.addr + seg.size) pc = seg.addr & ~3u;
+    }
+  }
+  xip_report("fetch", done * 4, (sim_time - t0) / 2);
+
+  if (errors) test_fail++; else test_pass++;
+  printf("  xip: %d mismatches\n", errors);
+}
+
+int main(int argc, char **argv) {
+  VerilatedContext *contextp = new VerilatedContext;
+  contextp->commandArgs(argc, argv);
+  contextp->traceEverOn(true);
+
+  std::string path = contextp->commandArgsPlusMatch("flash=");
+  path = path.empty() ? "build/flash.img" : path.substr(strlen("+flash="));
+  if (!flash_map(path.c_str(), contextp->commandArgsPlusMatch("erase")[0]))
+    return 1;
+
+  // ─── Image (written into the mapped file) ───────────────
+  std::vector<ImageSegment> image;
+  std::string load_spec = contextp->commandArgsPlusMatch("load=");
+  bool xip = !load_spec.empty() || contextp->commandArgsPlusMatch("xip")[0];
+  if (!load_spec.empty()) {
+    std::string file;
+    uint64_t base;
+    image_parse_spec(load_spec.substr(strlen("+load=")), file, base);
+    if (!load_image(file.c_str(), base, flash_mem, FLASH_SIZE, &image))
+      return 1;
+    for (const ImageSegment &seg : image)
+      printf("image: %s -> 0x%06X..0x%06X\n", file.c_str(), seg.addr, seg.addr + seg.size);
+  } else if (xip) { // same synthetic image as sim_qspi_psram
+    uint32_t lcg = 0xB007B007;
+    for (uint32_t a = 0x8000; a < 0xC000; a++) {
+      lcg = lcg * 1664525u + 1013904223u;
+      flash_mem[a] = (uint8_t)(lcg >> 24);
+    }
+    image.push_back({0x8000, 0x4000});
+    printf("image: synthetic 16 KiB -> 0x08000..0x0C000\n");
+  }
+
+  dut = new VQSPIFlashTop{contextp};
+  trace.open(dut, "build/qspi_flash.vcd");
+  SimPerf perf;
+
+  printf("====================================================\n");
+  printf("  QSPI Master + NOR Flash Simulation\n");
+  printf("  XIP, erase / program and SFDP on an mmap'd image\n");
+  printf("====================================================\n\n");
+
+  do_reset();
+  printf("[time %5lu] reset done\n\n", (unsigned long)sim_time);
+
+  // ─── Test 1: Boot into QPI ──────────────────────────────
+  {
+    printf("-- Test 1: INIT table leaves the flash in QPI --\n");
+    // The first memory access waits for the boot sequence
+    check("XIP read after boot", mem_word(0x100), apb_read(0x100));
+    uint8_t id[3];
+    prog_cmd(true, 0xAF, -1, 0, nullptr, id, 3);
+    for (int i = 0; i < 3; i++) {
+      char name[32];
+      snprintf(name, sizeof(name), "QPI ID byte %d", i);
+      check(name, JEDEC_ID[i], id[i]);
+    }
+    check("status QE", SR_QE, dut->flash_status & SR_QE);
+    printf("\n");
+  }
+
+  // ─── Test 2: SPI mode ID / SFDP ─────────────────────────
+  {
+    printf("-- Test 2: JEDEC ID and SFDP in SPI mode --\n");
+    prog_cmd(true, 0xF5); // exit QPI
+    uint8_t id[3];
+    prog_cmd(false, 0x9F, -1, 0, nullptr, id, 3);
+    check("SPI JEDEC ID", 0xC22018, (uint32_t)(id[0] << 16 | id[1] << 8 | id[2]));
+
+    uint8_t sfdp[16];
+    prog_cmd(false, 0x5A, 0, 8, nullptr, sfdp, 16);
+    check("SFDP signature", 0x50444653, (uint32_t)(sfdp[0] | sfdp[1] << 8 | sfdp[2] << 16 | sfdp[3] << 24));
+    uint32_t ptp = sfdp[12] | sfdp[13] << 8 | sfdp[14] << 16;
+    check("BFPT pointer", 0x30, ptp);
+    check("BFPT length (DWORDs)", 9, sfdp[11]);
+    uint8_t bfpt[36];
+    prog_cmd(false, 0x5A, ptp, 8, nullptr, bfpt, 36);
+    auto dw = [&](int i) { return (uint32_t)(bfpt[4 * i] | bfpt[4 * i + 1] << 8 | bfpt[4 * i + 2] << 16 | bfpt[4 * i + 3] << 24); };
+    check("BFPT density", FLASH_SIZE * 8 - 1, dw(1));
+    check("BFPT 4 KiB erase opcode", 0x20, dw(0) >> 8 & 0xFF);
+    check("BFPT 1-4-4 read opcode", 0xEB, dw(2) >> 8 & 0xFF);
+    check("BFPT 1-4-4 dummy + mode clocks", 6, (dw(2) & 0x1F) + (dw(2) >> 5 & 7));
+    check("BFPT 64 KiB erase opcode", 0xD8, dw(7) >> 24);
+    printf("\n");
+  }
+
+  // ─── Test 3: Erase / program through the header ─────────
+  {
+    printf("-- Test 3: erase and program (SPI mode) --\n");
+    uint8_t pat[16], rd[16];
+    for (int i = 0; i < 16; i++) pat[i] = (uint8_t)(0xF0 ^ i * 0x11);
+
+    uint8_t before = flash_mem[SCRATCH];
+    prog_cmd(false, 0x02, SCRATCH, 0, pat, nullptr, 1);
+    check("program without WREN ignored", before, flash_mem[SCRATCH]);
+    check("no busy without WREN", 0, dut->flash_status & SR_WIP);
+
+    uint8_t below = flash_mem[SCRATCH - 1], above = flash_mem[SCRATCH + 4096];
+    prog_cmd(false, 0x06);
+    check("WEL after WREN", SR_WEL, prog_status(false) & SR_WEL);
+    prog_cmd(false, 0x20, SCRATCH + 0x123);
+    int busy = wait_ready(false);
+    printf("  sector erase busy: %d cycles (model %d)\n", busy, SECTOR_ERASE_CYCLES);
+    check("sector erase busy time", 1, busy >= SECTOR_ERASE_CYCLES - 16 && busy <= SECTOR_ERASE_CYCLES);
+    check("WEL cleared by erase", 0, prog_status(false) & SR_WEL);
+    bool erased = true;
+    for (uint32_t a = SCRATCH; a < SCRATCH + 4096; a++) erased = erased && flash_mem[a] == 0xFF;
+    check("sector erased in the image", 1, erased);
+    check("neighbours untouched", below << 8 | above, flash_mem[SCRATCH - 1] << 8 | flash_mem[SCRATCH + 4096]);
+
+    prog_cmd(false, 0x06);
+    prog_cmd(false, 0x02, SCRATCH, 0, pat, nullptr, 16);
+    uint64_t t0 = sim_time;
+    prog_cmd(false, 0x03, SCRATCH, 0, nullptr, rd, 4); // ignored while busy: nobody drives
+    check("read ignored while busy", 0, (uint32_t)(rd[0] | rd[1] | rd[2] | rd[3]));
+    wait_ready(false);
+    busy = (int)((sim_time - t0) / 2);
+    printf("  page program busy: %d cycles (model %d)\n", busy, PROGRAM_CYCLES);
+    check("page program busy time", 1, busy >= PROGRAM_CYCLES - 16 && busy <= PROGRAM_CYCLES);
+    prog_cmd(false, 0x03, SCRATCH, 0, nullptr, rd, 16);
+    check("SPI read after program", 0, (uint32_t)memcmp(rd, pat, 16));
+
+    // Programming only clears bits
+    uint8_t over = 0x0F;
+    prog_cmd(false, 0x06);
+    prog_cmd(false, 0x02, SCRATCH, 0, &over, nullptr, 1);
+    wait_ready(false);
+    check("program ANDs into the byte", pat[0] & 0x0F, flash_mem[SCRATCH]);
+
+    // Page wrap: 4 bytes from the last two of a page
+    uint8_t wrap[4] = {0x00, 0x00, 0x00, 0x00};
+    prog_cmd(false, 0x06);
+    prog_cmd(false, 0x02, SCRATCH + 0x2FE, 0, wrap, nullptr, 4);
+    wait_ready(false);
+    check("page end programmed", 0, flash_mem[SCRATCH + 0x2FE] | flash_mem[SCRATCH + 0x2FF]);
+    check("page wraps to its start", 0, flash_mem[SCRATCH + 0x200] | flash_mem[SCRATCH + 0x201]);
+    check("next page untouched", 0xFF, flash_mem[SCRATCH + 0x300]);
+
+    prog_cmd(false, 0x35); // back to QPI for the master
+    printf("\n");
+  }
+
+  // ─── Test 4: XIP reads through the master ───────────────
+  {
+    printf("-- Test 4: XIP through the master --\n");
+    int errors = 0;
+    for (uint32_t a = SCRATCH; a < SCRATCH + 0x400; a += 4)
+      if (apb_read(a) != mem_word(a)) errors++;
+    check("XIP over the programmed sector", 0, errors);
+    check("XIP word", mem_word(SCRATCH), apb_read(SCRATCH));
+    printf("\n");
+  }
+
+  // ─── Test 5: Programs through the master ────────────────
+  {
+    printf("-- Test 5: page program through the master (0x38) --\n");
+    uint32_t a = SCRATCH + 0x800;
+    apb_write(a, 0x12345678); // no WREN: ignored
+    wait_ready(true);
+    check("master write without WREN ignored", 0xFFFFFFFF, mem_word(a));
+
+    // WREN as a one-entry INIT table, then the write
+    apb_write(CSR_INIT_CMD(0), INIT_QPI | 0x06);
+    apb_write(CSR_INIT_CTRL, init_count(1) | INIT_RUN);
+    apb_write(a, 0x12345678);
+    int busy = wait_ready(true);
+    printf("  page program busy: %d cycles\n", busy);
+    check("master write programs", 0x12345678, mem_word(a));
+    check("XIP read back", 0x12345678, apb_read(a));
+
+    apb_write(CSR_INIT_CTRL, init_count(1) | INIT_RUN);
+    apb_write(a, 0xFF00FF0F);
+    wait_ready(true);
+    check("master write ANDs", 0x12345678 & 0xFF00FF0F, apb_read(a));
+    printf("\n");
+  }
+
+  // ─── Test 6: Persistence ────────────────────────────────
+  {
+    printf("-- Test 6: run counter in the image --\n");
+    uint32_t w = mem_word(RUN_WORD);
+    int runs = 32 - __builtin_popcount(w);
+    if (runs == 32) { // full: erase its sector
+      prog_cmd(true, 0x06);
+      prog_cmd(true, 0x20, RUN_WORD);
+      wait_ready(true);
+      w = mem_word(RUN_WORD);
+      runs = 0;
+    }
+    printf("  previous runs on this image: %d\n", runs);
+    apb_write(CSR_INIT_CTRL, init_count(1) | INIT_RUN);
+    apb_write(RUN_WORD, w & ~(1u << runs)); // clear one more bit
+    wait_ready(true);
+    check("run counter", w & ~(1u << runs), apb_read(RUN_WORD));
+    printf("\n");
+  }
+
+  // ─── XIP benchmark (optional) ───────────────────────────
+  if (xip) {
+    printf("-- XIP benchmark --\n");
+    run_xip(image, plusarg_u64(contextp, "xip", 0));
+    printf("\n");
+  }
+
+  for (int i = 0; i < 20; i++)
+    tick();
+
+  printf("====================================================\n");
+  printf("  Results: %d passed, %d failed\n", test_pass, test_fail);
+  printf("  Waveform: %s\n", trace.path());
+  perf.report(sim_time / 2);
+  sim_coverage(contextp, "build/qspi_flash_coverage.dat");
+  printf("====================================================\n");
+
+  trace.close();
+  dut->final();
+  delete dut;
+  delete contextp;
+  flash_unmap();
+  return test_fail > 0 ? 1 : 0;
+}
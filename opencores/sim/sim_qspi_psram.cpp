@@ -2,15 +2,70 @@
 // QSPI Master + PSRAM Slave interaction test (Verilator)
 // Wiring done in Chisel (QSPIPSRAMTop). C++ drives APB and implements DPI-C.
 //
+// Built with -DPSRAM_SRAM for the SyncReadMem backend
+// (configs/QSPIPSRAMTop-sram.json): there is no DPI traffic, psram_mem is
+// only the harness's reference copy and images reach the model through
+// the $readmemh file named in the config, written before the model is
+// constructed.
+//
 // Test plan:
 //   1. Write individual bytes via APB, read back and verify
 //   2. Write full 32-bit words via APB, read back and verify
 //   3. Write half-words via APB, read back and verify
 //   4. Write a pattern, read back to test data integrity
+//   5-6. Overwrite, zero / all-ones
+//   7. Access cycles vs. the timing model published by QSPIOM
+//   8. Interrupt moderation (CSR window): interrupts per MB of writes
+//   9. TX / RX data transforms (XFORM CSR)
+//  10. Read / write bursts (BURST CSR): CE stays low and SCK pauses while
+//      the CPU is slow; page crossing, closing and CE_MAX
+//  11. Pipelined transactions (PIPE CSR): posted random-address writes
+//      and the CE# high gap between transactions
+//  12. RX compare (CMP CSR): a verify pass over memory reads, mismatch
+//      address and intO, masked byte lane
+//  13. Link efficiency: SCK cycles of a single read split into command,
+//      address, turnaround, dummy and data from the pins; a read burst
+//      carries more payload per bit-time than single reads
+//  14. Reference driver (driver/qspi_drv.c) over the APB helpers: word
+//      access, unaligned memcpy both ways, scatter lists, posted writes
+//      and fence; cycles per API call
+//  15. Boot microcode (INIT CSRs): reset table, replaying it with the
+//      PSRAM in QPI mode, a reprogrammed table with argument bytes and
+//      WAIT, an empty table
+//  16. SCK phase dividers (DIV CSRs): slow command / address / dummy
+//      with fast data, access cycles vs. the per-phase timing model,
+//      a read burst at the data rate
+//
+// Runs with +workload or +xip end with the link efficiency report
+// (link_monitor.h) of that traffic.
+//
+// Plusargs:
+//   +workload=N   after the tests, run N rounds of 64 word write/read-back
+//                 pairs (used by `make bench_profiles`)
+//   +load=<file>[@<addr>]
+//                 preload a raw binary or ELF image into psram_mem through
+//                 the backdoor (no APB writes), then run the XIP benchmark
+//   +xip[=N]      run the XIP benchmark with N fetches in the fetch-like
+//                 pass (default: one per image word); without +load a
+//                 16 KiB pseudo-random image at 0x8000 is used
+//   +irq_writes=N word writes per setting in test 8 (default 200)
+//   +burst=V      BURST CSR value for the workload and XIP runs
+//                 (1: read bursts, 3: read and write bursts)
+//   +ckpt_every=N save a checkpoint (build/ckpt/qspi_psram_<k>.bin) at the
+//                 first workload round boundary after every N cycles and at
+//                 the end; no waveform is written (needs SAVABLE=1)
+//   +segment=K    resume the workload from checkpoint K with tracing, stop
+//                 at checkpoint K+1 and check that the model and harness
+//                 state there match it byte for byte (`make sim_qspi_psram_segments` runs all of them)
 
+#include "QSPIOM.h"
 #include "VQSPIPSRAMTop.h"
+#include "image_loader.h"
+#include "link_monitor.h"
+#include "qspi_drv.h"
+#include "sim_common.h"
 #include "verilated.h"
-#include "verilated_vcd_c.h"
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
@@ -18,6 +73,10 @@
 
 // ─── PSRAM memory model (DPI-C implementation) ─────────────────
 static uint8_t psram_mem[1 << 20]; // 1 MB PSRAM
+#ifdef PSRAM_SRAM
+static const char *PSRAM_INIT_HEX = "build/psram_sram.hex"; // psram.initFile
+#endif
+static bool psram_verbose = true;  // log every DPI write (off for workloads)
 
 extern "C" void psram_read(int addr, char *data) {
   uint32_t a = (uint32_t)addr & 0xFFFFF;
@@ -27,26 +86,204 @@ extern "C" void psram_read(int addr, char *data) {
 extern "C" void psram_write(int addr, char data) {
   uint32_t a = (uint32_t)addr & 0xFFFFF;
   psram_mem[a] = (uint8_t)data;
-  printf("write@0x%03X: %02X\n", a, psram_mem[a]);
+  if (psram_verbose) printf("write@0x%03X: %02X\n", a, psram_mem[a]);
 }
 
 // ─── Simulation globals ────────────────────────────────────────
 static VQSPIPSRAMTop *dut = nullptr;
-static VerilatedVcdC *tfp = nullptr;
+static SimTrace<VQSPIPSRAMTop> trace;
 static uint64_t sim_time = 0;
 static int test_pass = 0;
 static int test_fail = 0;
+static uint64_t irq_edges = 0; // rising edges of intO
+static bool int_prev = false;
+static uint64_t ce_rises = 0;  // transactions ended (qspi_ce_n rising)
+static bool ce_prev = true;
+static uint64_t ce_high_run = 0; // current run of qspi_ce_n high cycles
+static uint64_t ce_gap_min = ~0ull; // shortest completed run
 
 static constexpr int MAX_CYCLES = 500000;
 
+// ─── Link phases ───────────────────────────────────────────────
+// The boot sequence (INIT table) sends single commands: in SPI mode one
+// bit per SCK on DIO[0] (8 SCK, e.g. 0x35 switches the PSRAM to QPI), in
+// QPI mode a nibble per SCK (2 SCK plus 2 per argument byte). Memory
+// accesses are QPI: command (2), address (6), then for 0xEB reads 6 wait
+// cycles, the first of which hands DIO over to the PSRAM, and 2 per data
+// byte in either direction.
+static LinkClass qspi_classify(const LinkXfer &x) {
+  LinkClass c;
+  uint32_t n = (uint32_t)x.dio.size();
+  uint8_t spi_cmd = 0;
+  bool spi = n == 8;
+  for (uint32_t i = 0; i < n && i < 8; i++) {
+    spi_cmd = (uint8_t)(spi_cmd << 1 | (x.dio[i] & 1));
+    spi = spi && !(x.dio[i] & 0xE);
+  }
+  char name[32];
+  if (spi) {
+    snprintf(name, sizeof(name), "SPI 0x%02X", spi_cmd);
+    c.type = spi_cmd == 0x35 ? "enter QPI (0x35)" : name;
+    c.sck[LINK_CMD] = 8;
+    return c;
+  }
+  uint8_t cmd = (uint8_t)((x.dio[0] & 0xF) << 4 | (n > 1 ? x.dio[1] & 0xF : 0));
+  if (n < 8) {
+    int len = snprintf(name, sizeof(name), "QPI 0x%02X", cmd);
+    for (uint32_t i = 2; i + 1 < n; i += 2) // argument bytes
+      len += snprintf(name + len, sizeof(name) - len, " %02X", (x.dio[i] & 0xF) << 4 | (x.dio[i + 1] & 0xF));
+    c.type = n % 2 ? "aborted" : name;
+    c.sck[LINK_CMD] = n;
+    return c;
+  }
+  c.sck[LINK_CMD] = 2;
+  c.sck[LINK_ADDR] = 6;
+  uint32_t data = n - 8;
+  if (cmd == 0xEB && n >= 14) {
+    c.sck[LINK_TURN] = 1;
+    c.sck[LINK_DUMMY] = 5;
+    data = n - 14;
+  }
+  c.sck[LINK_DATA] = data;
+  c.payload_bits = 4 * data;
+  if (cmd == 0xEB)
+    snprintf(name, sizeof(name), "read %uB", data / 2);
+  else if (cmd == 0x38)
+    snprintf(name, sizeof(name), "write %uB", data / 2);
+  else
+    snprintf(name, sizeof(name), "cmd 0x%02X", cmd);
+  c.type = name;
+  return c;
+}
+
+static LinkMonitor link_mon(4, qspi_classify);
+
+// ─── CSR window (paddr[24] set, QSPIParameter.csrAddrBit) ─────
+static constexpr uint32_t CSR_BASE       = 1u << 24;
+static constexpr uint32_t CSR_INT_CTRL   = CSR_BASE + (0 << 2);
+static constexpr uint32_t CSR_INT_STATUS = CSR_BASE + (1 << 2);
+static constexpr uint32_t CSR_XFORM      = CSR_BASE + (2 << 2);
+static constexpr uint32_t CSR_BURST      = CSR_BASE + (3 << 2);
+static constexpr uint32_t CSR_PIPE       = CSR_BASE + (4 << 2);
+static constexpr uint32_t CSR_CMP_CTRL   = CSR_BASE + (5 << 2);
+static constexpr uint32_t CSR_CMP_EXP    = CSR_BASE + (6 << 2);
+static constexpr uint32_t CSR_CMP_MASK   = CSR_BASE + (7 << 2);
+static constexpr uint32_t CSR_INIT_CTRL  = CSR_BASE + (8 << 2);
+static constexpr uint32_t CSR_DIV_CMD    = CSR_BASE + (9 << 2);
+static constexpr uint32_t CSR_DIV_ADDR   = CSR_BASE + (10 << 2);
+static constexpr uint32_t CSR_DIV_DUMMY  = CSR_BASE + (11 << 2);
+static constexpr uint32_t CSR_DIV_DATA   = CSR_BASE + (12 << 2);
+static constexpr uint32_t CSR_INIT_CMD(int i) { return CSR_BASE + ((16 + 2 * i) << 2); }
+static constexpr uint32_t CSR_INIT_ARG(int i) { return CSR_BASE + ((17 + 2 * i) << 2); }
+static constexpr uint32_t INT_CNT = 1 << 0;
+static constexpr uint32_t INT_TMO = 1 << 1;
+static constexpr uint32_t XF_BSWAP16 = 1;      // DataTransform fields
+static constexpr uint32_t XF_BSWAP32 = 2;
+static constexpr uint32_t XF_BITREV = 1 << 2;
+static constexpr uint32_t XF_NIBSWAP = 1 << 3;
+static constexpr uint32_t BURST_RD = 1 << 0;
+static constexpr uint32_t BURST_WR = 1 << 1;
+static constexpr uint32_t PIPE_POST = 1 << 8;
+static constexpr uint32_t CMP_EN   = 1 << 0;
+static constexpr uint32_t CMP_FAIL = 1 << 1;
+static constexpr uint32_t INIT_RUN = 1 << 0;
+static constexpr uint32_t INIT_QPI = 1 << 8;
+static constexpr uint32_t init_count(uint32_t n) { return n << 8; }
+static constexpr uint32_t init_narg(uint32_t n) { return n << 9; }
+static constexpr uint32_t init_wait(uint32_t cycles) { return cycles << 16; }
+
+// Cycles from the first psel cycle to the first pready cycle of the last
+// APB access (SETUP cycle included).
+static int last_access_cycles = 0;
+
+// ─── Timing model published by QSPIOM (qspi/src/QSPI.scala) ────
+// OM_* come from QSPIOM.h, generated from the elaborated .fir
+// (om_export.py). The formulas below take any divider; Test 7 checks
+// them against the cycle counts QSPIOM computes at the reset divider.
+// cycles(nibbles, divider) = accessOverhead + (2 * nibbles + 1) * (divider + 1)
+
+static int om_access_cycles(int nibbles, int divider) {
+  return OM_ACCESS_OVERHEAD + (2 * nibbles + 1) * (divider + 1);
+}
+static int om_read_cycles(int divider) {
+  return om_access_cycles(OM_CMD_NIBBLES + OM_ADDR_NIBBLES + OM_READ_DUMMY_NIBBLES +
+                              2 * OM_MAX_PAYLOAD_BYTES, divider);
+}
+static int om_write_cycles(int bytes, int divider) {
+  return om_access_cycles(OM_CMD_NIBBLES + OM_ADDR_NIBBLES + 2 * bytes, divider);
+}
+// One divider per SCK phase (QSPIParameter.phaseAccessCycles): command,
+// address, dummy, data; the closing half period runs at the last phase's
+static int om_phase_cycles(const int nibbles[4], const int div[4]) {
+  int c = OM_ACCESS_OVERHEAD, last = -1;
+  for (int p = 0; p < 4; p++) {
+    c += 2 * nibbles[p] * (div[p] + 1);
+    if (nibbles[p]) last = p;
+  }
+  return c + (last < 0 ? 1 : div[last] + 1);
+}
+// Extra wait of an access behind a posted word write and the CE# gap
+static int om_posted_drain_cycles(int divider, int ce_gap) {
+  return om_write_cycles(OM_MAX_PAYLOAD_BYTES, divider) + (ce_gap > 1 ? ce_gap : 1);
+}
+// Extra wait of an access that has to close an open burst first
+static int om_burst_close_cycles(int divider) {
+  return OM_ACCESS_OVERHEAD + (4 * OM_BURST_WORD_NIBBLES + 1) * (divider + 1);
+}
+
+// ─── Latency guard ─────────────────────────────────────────────
+// Mirrors the psel→pready bound asserted in QSPI's Verification layer, so
+// builds without that layer (PROFILE=fast-sim) still flag regressions.
+// The first access after reset or INIT_CTRL.RUN also waits for the boot
+// sequence (INIT table) and is not checked.
+static bool latency_guard_armed = false;
+static int latency_violations = 0;
+static bool burst_open = false; // a burst may be open, see set_burst()
+static int pipe_slack = 0;      // CE# gap / posted write wait, see set_pipe()
+static int div_slack = 0;       // slower SCK phases, see set_dividers()
+
+static void latency_guard(const char *kind, uint32_t addr, int allowed) {
+  if (!latency_guard_armed) {
+    latency_guard_armed = true;
+    return;
+  }
+  if (burst_open) allowed += om_burst_close_cycles(OM_RESET_DIVIDER);
+  allowed += pipe_slack + div_slack;
+  if (last_access_cycles > allowed) {
+    printf("  LATENCY VIOLATION %s @0x%06X: measured %d cycles, allowed %d\n",
+           kind, addr, last_access_cycles, allowed);
+    latency_violations++;
+  }
+}
+
+static int strb_bytes(uint8_t strb) {
+  switch (strb) {
+  case 0x1: case 0x2: case 0x4: case 0x8: return 1;
+  case 0x3: case 0xC: return 2;
+  case 0xF: return 4;
+  default: return -1; // unsupported, no transaction
+  }
+}
+
 // ─── Clock tick ────────────────────────────────────────────────
 static void tick() {
   dut->clock = 1;
   dut->eval();
-  if (tfp) tfp->dump(sim_time++);
+  trace.dump(sim_time++);
+  if (dut->intO && !int_prev) irq_edges++;
+  int_prev = dut->intO;
+  if (dut->qspi_ce_n && !ce_prev) ce_rises++;
+  ce_prev = dut->qspi_ce_n;
+  if (dut->qspi_ce_n) {
+    ce_high_run++;
+  } else {
+    if (ce_high_run && ce_high_run < ce_gap_min) ce_gap_min = ce_high_run;
+    ce_high_run = 0;
+  }
+  link_mon.sample(dut->qspi_ce_n, dut->qspi_sck, dut->qspi_dio);
   dut->clock = 0;
   dut->eval();
-  if (tfp) tfp->dump(sim_time++);
+  trace.dump(sim_time++);
 }
 
 // ─── Reset ─────────────────────────────────────────────────────
@@ -100,6 +337,10 @@ static void apb_write(uint32_t addr, uint32_t data, uint8_t strb = 0xF) {
       break;
     }
   } while (!dut->pready);
+  last_access_cycles = 1 + cycles;
+  int bytes = strb_bytes(strb);
+  latency_guard("write", addr, bytes > 0 ? om_write_cycles(bytes, OM_RESET_DIVIDER)
+                                         : om_access_cycles(0, OM_RESET_DIVIDER));
   // pready sampled high; hold penable one more cycle for done→idle
   tick();
   // IDLE phase
@@ -128,6 +369,8 @@ static uint32_t apb_read(uint32_t addr) {
       return 0xDEADBEEF;
     }
   } while (!dut->pready);
+  last_access_cycles = 1 + cycles;
+  latency_guard("read", addr, om_read_cycles(OM_RESET_DIVIDER));
   uint32_t val = dut->prdata;
   // pready sampled high; hold penable one more cycle for done→idle
   tick();
@@ -152,6 +395,297 @@ static void check(const char *name, uint32_t expected, uint32_t actual,
   }
 }
 
+// ─── Burst control ─────────────────────────────────────────────
+// Writing 0 leaves an open burst in place until the next memory access,
+// so a read of address 0 closes it before the latency guard is narrowed.
+static void set_burst(uint32_t value) {
+  apb_write(CSR_BURST, value);
+  if (value & (BURST_RD | BURST_WR)) {
+    burst_open = true;
+  } else if (burst_open) {
+    apb_read(0);
+    burst_open = false;
+  }
+}
+
+// ─── SCK phase dividers ────────────────────────────────────────
+// The latency guard allows for every phase at the slowest divider.
+static void set_dividers(int cmd, int addr, int dummy, int data) {
+  apb_write(CSR_DIV_CMD, cmd);
+  apb_write(CSR_DIV_ADDR, addr);
+  apb_write(CSR_DIV_DUMMY, dummy);
+  apb_write(CSR_DIV_DATA, data);
+  int slowest = std::max(std::max(cmd, addr), std::max(dummy, data));
+  div_slack = std::max(0, om_read_cycles(slowest) - om_read_cycles(OM_RESET_DIVIDER)) +
+              std::max(0, om_burst_close_cycles(slowest) - om_burst_close_cycles(OM_RESET_DIVIDER));
+}
+
+// ─── Pipeline control ──────────────────────────────────────────
+static void set_pipe(uint32_t ce_gap, bool post) {
+  apb_write(CSR_PIPE, (post ? PIPE_POST : 0) | ce_gap);
+  pipe_slack = post ? om_posted_drain_cycles(OM_RESET_DIVIDER, (int)ce_gap)
+                    : (int)ce_gap;
+}
+
+static void idle_cycles(int n) {
+  for (int i = 0; i < n; i++)
+    tick();
+}
+
+// ─── Driver MMIO ───────────────────────────────────────────────
+// driver/qspi_drv.c runs on the APB helpers. BURST / PIPE writes keep the
+// latency guard's slack in step, as set_burst() / set_pipe() do.
+static uint32_t drv_read32(void *, uint32_t off) { return apb_read(off); }
+
+static void drv_write32(void *, uint32_t off, uint32_t val) {
+  if (off == CSR_BURST && (val & (BURST_RD | BURST_WR))) burst_open = true;
+  if (off == CSR_PIPE)
+    pipe_slack = val & PIPE_POST ? om_posted_drain_cycles(OM_RESET_DIVIDER, val & 0xFF)
+                                 : (int)(val & 0xFF);
+  apb_write(off, val, 0xF);
+}
+
+static void drv_write16(void *, uint32_t off, uint16_t val) {
+  apb_write(off & ~3u, (uint32_t)val << 8 * (off & 3), (uint8_t)(0x3 << (off & 3)));
+}
+
+static void drv_write8(void *, uint32_t off, uint8_t val) {
+  apb_write(off & ~3u, (uint32_t)val << 8 * (off & 3), (uint8_t)(0x1 << (off & 3)));
+}
+
+static const drv_mmio drv_io = {drv_read32, drv_write32, drv_write16, drv_write8, nullptr};
+
+static void drv_cost(const char *api, size_t bytes, uint64_t cycles) {
+  printf("  %-26s %5zu B %7llu cycles %7.2f cycles/B\n", api, bytes,
+         (unsigned long long)cycles, bytes ? (double)cycles / bytes : 0.0);
+}
+
+// ─── Workload (benchmark) ──────────────────────────────────────
+// Deterministic write/read-back traffic; only mismatches are reported.
+// The loop state lives in `wl` so that a checkpoint can resume it.
+struct WorkloadState {
+  uint64_t rounds = 0;
+  uint64_t round = 0;
+  uint32_t lcg = 0x12345678;
+  int errors = 0;
+  uint64_t ckpt_every = 0; // cycles between checkpoints (0 = none)
+  uint64_t next_ckpt = 0;  // cycle from which the next one is taken
+  uint32_t ckpt_idx = 0;   // index of the next checkpoint
+};
+static WorkloadState wl;
+static int segment = -1;         // +segment=K, see run_segment()
+static bool segment_ok = false;  // end state matched checkpoint K+1
+
+// Everything a checkpoint carries besides the model
+static void harness_state(SimCkpt &c) {
+  c.io(sim_time);
+  c.io(test_pass);
+  c.io(test_fail);
+  c.io(irq_edges);
+  c.io(int_prev);
+  c.io(ce_rises);
+  c.io(ce_prev);
+  c.io(ce_high_run);
+  c.io(ce_gap_min);
+  c.io(last_access_cycles);
+  c.io(latency_guard_armed);
+  c.io(latency_violations);
+  c.io(burst_open);
+  c.io(pipe_slack);
+  c.io(div_slack);
+  c.io(wl.rounds);
+  c.io(wl.round);
+  c.io(wl.lcg);
+  c.io(wl.errors);
+  c.io(wl.ckpt_every);
+  c.io(wl.next_ckpt);
+  c.io(wl.ckpt_idx);
+  c.bytes(psram_mem, sizeof(psram_mem));
+}
+
+static void ckpt_path(char *buf, size_t n, uint32_t k) {
+  snprintf(buf, n, "build/ckpt/qspi_psram_%u.bin", k);
+}
+
+// Runs at every round boundary and after the last round. The first pass
+// saves a checkpoint here; a segment compares its state, model included,
+// with the one saved at this point and returns false to stop.
+static bool workload_boundary(bool last) {
+  if (!wl.ckpt_every || (!last && sim_time / 2 < wl.next_ckpt)) return true;
+  while (wl.next_ckpt <= sim_time / 2) wl.next_ckpt += wl.ckpt_every;
+  uint32_t k = wl.ckpt_idx++;
+  char path[64];
+  ckpt_path(path, sizeof(path), k);
+  if (segment < 0) {
+    if (sim_save(dut, path, harness_state))
+      printf("  checkpoint %u: round %llu, cycle %llu\n", k,
+             (unsigned long long)wl.round, (unsigned long long)(sim_time / 2));
+    return true;
+  }
+  char scratch[64];
+  snprintf(scratch, sizeof(scratch), "build/ckpt/qspi_psram_seg%d_end.bin", segment);
+  segment_ok = sim_ckpt_match(dut, path, scratch, harness_state);
+  return false;
+}
+
+static void run_workload_rounds() {
+  psram_verbose = false;
+  while (wl.round < wl.rounds) {
+    if (!workload_boundary(false)) return;
+    uint32_t vals[64];
+    for (int i = 0; i < 64; i++) {
+      wl.lcg = wl.lcg * 1664525u + 1013904223u;
+      vals[i] = wl.lcg;
+      apb_write(0x1000 + 4 * i, vals[i], 0xF);
+    }
+    for (int i = 0; i < 64; i++) {
+      uint32_t rd = apb_read(0x1000 + 4 * i);
+      if (rd != vals[i] && wl.errors++ < 8)
+        printf("  FAIL workload round %llu word %d: expected 0x%08X, got 0x%08X\n",
+               (unsigned long long)wl.round, i, vals[i], rd);
+    }
+    wl.round++;
+  }
+  if (!workload_boundary(true)) return;
+  psram_verbose = true;
+  if (wl.errors) test_fail++; else test_pass++;
+  printf("  workload: %llu rounds, %d mismatches\n", (unsigned long long)wl.rounds,
+         wl.errors);
+}
+
+static void run_workload(uint64_t rounds, uint64_t ckpt_every) {
+  wl = WorkloadState();
+  wl.rounds = rounds;
+  wl.ckpt_every = ckpt_every;
+  wl.next_ckpt = sim_time / 2;
+  run_workload_rounds();
+}
+
+// ─── Segment run ───────────────────────────────────────────────
+// Resumes the workload from checkpoint k with tracing on and stops at
+// checkpoint k+1. Segments are independent, so `make
+// sim_qspi_psram_segments` runs them in parallel after the first pass.
+static int run_segment(VerilatedContext *contextp, uint32_t k) {
+  char path[64], wave[64];
+  ckpt_path(path, sizeof(path), k);
+  snprintf(wave, sizeof(wave), "build/ckpt/qspi_psram_seg%u.vcd", k);
+  segment = (int)k;
+  if (!sim_restore(dut, path, harness_state)) return 1;
+  trace.open(dut, wave);
+  SimPerf perf;
+
+  uint64_t c0 = sim_time / 2;
+  printf("-- Segment %u: from round %llu, cycle %llu --\n", k,
+         (unsigned long long)wl.round, (unsigned long long)c0);
+  run_workload_rounds();
+  printf("  stopped at round %llu, cycle %llu\n", (unsigned long long)wl.round,
+         (unsigned long long)(sim_time / 2));
+  check("end state matches next checkpoint", 1, segment_ok);
+  printf("  Waveform: %s\n", trace.path());
+  perf.report(sim_time / 2 - c0);
+
+  trace.close();
+  dut->final();
+  delete dut;
+  delete contextp;
+  return segment_ok ? 0 : 1;
+}
+
+// ─── XIP benchmark ─────────────────────────────────────────────
+// Reads a preloaded image the way a core booting from PSRAM would:
+//   1. sequential pass over every word (copy-to-RAM / checksum style)
+//   2. fetch-like pass: straight-line runs of 1..16 words, then a jump to
+//      a pseudo-random word inside the image (branch / call)
+// Every word is checked against psram_mem; throughput is payload bytes per
+// system clock cycle, APB overhead included.
+static void xip_report(const char *name, uint64_t bytes, uint64_t cycles) {
+  printf("  %-10s %8llu bytes in %9llu cycles: %.4f bytes/cycle\n", name,
+         (unsigned long long)bytes, (unsigned long long)cycles,
+         cycles ? (double)bytes / cycles : 0.0);
+}
+
+static uint32_t mem_word(uint32_t addr) {
+  uint32_t w = 0;
+  for (int i = 3; i >= 0; i--)
+    w = w << 8 | psram_mem[(addr + i) & 0xFFFFF];
+  return w;
+}
+
+static void run_xip(const std::vector<ImageSegment> &segs, uint64_t fetches) {
+  int errors = 0;
+  uint64_t words = 0;
+  auto verify = [&](uint32_t addr) {
+    uint32_t rd = apb_read(addr);
+    if (rd != mem_word(addr) && errors++ < 8)
+      printf("  FAIL xip @0x%05X: expected 0x%08X, got 0x%08X\n", addr, mem_word(addr), rd);
+  };
+
+  // Sequential
+  uint64_t t0 = sim_time;
+  for (const ImageSegment &seg : segs) {
+    for (uint32_t a = seg.addr & ~3u; a < seg.addr + seg.size; a += 4) {
+      verify(a);
+      words++;
+    }
+  }
+  xip_report("sequential", words * 4, (sim_time - t0) / 2);
+
+  // Fetch-like
+  if (fetches == 0) fetches = words;
+  uint32_t lcg = 0x2545F491;
+  uint64_t done = 0;
+  t0 = sim_time;
+  while (done < fetches) {
+    lcg = lcg * 1664525u + 1013904223u;
+    const ImageSegment &seg = segs[(lcg >> 8) % segs.size()];
+    uint32_t nwords = seg.size / 4 ? seg.size / 4 : 1;
+    uint32_t pc = (seg.addr & ~3u) + 4 * ((lcg >> 12) % nwords);
+    uint32_t run = 1 + (lcg >> 28);
+    for (uint32_t i = 0; i < run && done < fetches; i++, done++) {
+      verify(pc);
+      pc += 4;
+      if (pc >= seg.addr + seg.size) pc = seg.addr & ~3u;
+    }
+  }
+  xip_report("fetch", done * 4, (sim_time - t0) / 2);
+
+  if (errors) test_fail++; else test_pass++;
+  printf("  xip: %d mismatches\n", errors);
+}
+
+// ─── Interrupt moderation ──────────────────────────────────────
+// Streams `n` word writes; an "ISR" runs whenever intO is high between
+// accesses and acknowledges both causes through the CSR window. Returns
+// the interrupts raised (rising edges of intO).
+static uint64_t run_moderated(uint32_t thresh, uint32_t timeout, int n,
+                              uint64_t *cycles) {
+  apb_write(CSR_INT_CTRL, timeout << 16 | thresh);
+  apb_write(CSR_INT_STATUS, INT_CNT | INT_TMO); // start an empty batch
+
+  auto service = [&] {
+    if (dut->intO) {
+      uint32_t st = apb_read(CSR_INT_STATUS);
+      apb_write(CSR_INT_STATUS, st & (INT_CNT | INT_TMO));
+    }
+  };
+
+  psram_verbose = false;
+  uint64_t irq0 = irq_edges, t0 = sim_time;
+  for (int i = 0; i < n; i++) {
+    apb_write(0x2000 + 4 * (i & 0x3FF), 0xC0DE0000u | i, 0xF);
+    service();
+  }
+  // Let the timer flush a partial batch
+  for (uint32_t c = 0; c < timeout + 2; c++)
+    tick();
+  service();
+  *cycles = (sim_time - t0) / 2;
+  psram_verbose = true;
+
+  apb_write(CSR_INT_CTRL, 0);
+  return irq_edges - irq0;
+}
+
 // ═══════════════════════════════════════════════════════════════
 //  Main
 // ═══════════════════════════════════════════════════════════════
@@ -160,15 +694,52 @@ int main(int argc, char **argv) {
   contextp->commandArgs(argc, argv);
   contextp->traceEverOn(true);
 
-  dut = new VQSPIPSRAMTop{contextp};
-  tfp = new VerilatedVcdC;
-  dut->trace(tfp, 99);
-  tfp->open("build/qspi_psram.vcd");
-
   memset(psram_mem, 0, sizeof(psram_mem));
 
+  // ─── Image preload (backdoor) ───────────────────────────
+  // The functional tests below write a few words near 0x000-0x700; load
+  // images elsewhere (e.g. +load=fw.bin@0x10000) if they must survive.
+  std::vector<ImageSegment> image;
+  std::string load_spec = contextp->commandArgsPlusMatch("load=");
+  bool xip = !load_spec.empty() || contextp->commandArgsPlusMatch("xip")[0];
+  if (!load_spec.empty()) {
+    std::string path;
+    uint64_t base;
+    image_parse_spec(load_spec.substr(strlen("+load=")), path, base);
+    if (!load_image(path.c_str(), base, psram_mem, sizeof(psram_mem), &image))
+      return 1;
+    for (const ImageSegment &seg : image)
+      printf("image: %s -> 0x%05X..0x%05X\n", path.c_str(), seg.addr, seg.addr + seg.size);
+  } else if (xip) {
+    uint32_t lcg = 0xB007B007;
+    for (uint32_t a = 0x8000; a < 0xC000; a++) {
+      lcg = lcg * 1664525u + 1013904223u;
+      psram_mem[a] = (uint8_t)(lcg >> 24);
+    }
+    image.push_back({0x8000, 0x4000});
+    printf("image: synthetic 16 KiB -> 0x08000..0x0C000\n");
+  }
+#ifdef PSRAM_SRAM
+  // $readmemh runs when the model is first evaluated
+  if (!image_write_readmemh(PSRAM_INIT_HEX, psram_mem, image))
+    return 1;
+#endif
+
+  dut = new VQSPIPSRAMTop{contextp};
+  if (contextp->commandArgsPlusMatch("segment=")[0])
+    return run_segment(contextp, (uint32_t)plusarg_u64(contextp, "segment", 0));
+  // The checkpointing first pass runs without a waveform
+  uint64_t ckpt_every = plusarg_u64(contextp, "ckpt_every", 0);
+  if (!ckpt_every)
+    trace.open(dut, "build/qspi_psram.vcd");
+  SimPerf perf;
+
   printf("====================================================\n");
-  printf("  QSPI Master + PSRAM Slave Simulation\n");
+#ifdef PSRAM_SRAM
+  printf("  QSPI Master + PSRAM Slave Simulation (SRAM backend)\n");
+#else
+  printf("  QSPI Master + PSRAM Slave Simulation (DPI-C backend)\n");
+#endif
   printf("  Memory-mapped transparent flash controller test\n");
   printf("====================================================\n\n");
 
@@ -184,7 +755,9 @@ int main(int argc, char **argv) {
     apb_write(base, 0x0000BB00, 0x2); // pstrb=0010 → byte 1
     apb_write(base, 0x00CC0000, 0x4); // pstrb=0100 → byte 2
     apb_write(base, 0xDD000000, 0x8); // pstrb=1000 → byte 3
+#ifndef PSRAM_SRAM
     printf("@0x%03X: %02X %02X %02X %02X\n", base, psram_mem[base], psram_mem[base+1], psram_mem[base+2], psram_mem[base+3]);
+#endif
     uint32_t rd = apb_read(base);
     check("byte writes → word read", 0xDDCCBBAA, rd);
     printf("\n");
@@ -259,17 +832,542 @@ int main(int argc, char **argv) {
     printf("\n");
   }
 
+  // ─── Test 7: Timing vs. object model ────────────────────
+  {
+    printf("-- Test 7: Access cycles vs. QSPIOM timing model --\n");
+    uint32_t base = 0x600;
+
+    apb_write(base, 0x11223344, 0xF);
+    check("word write cycles", om_write_cycles(4, OM_RESET_DIVIDER), last_access_cycles);
+    apb_write(base, 0x00005566, 0x3);
+    check("half-word write cycles", om_write_cycles(2, OM_RESET_DIVIDER), last_access_cycles);
+    apb_write(base, 0x00000077, 0x1);
+    check("byte write cycles", om_write_cycles(1, OM_RESET_DIVIDER), last_access_cycles);
+    apb_read(base);
+    check("word read cycles", om_read_cycles(OM_RESET_DIVIDER), last_access_cycles);
+
+    // The harness formulas (and so the latency guard) against QSPIOM's own
+    check("OM readCycles", OM_READ_CYCLES, om_read_cycles(OM_RESET_DIVIDER));
+    const int bytes[3] = {1, 2, 4};
+    for (int i = 0; i < 3; i++) {
+      char name[48];
+      snprintf(name, sizeof(name), "OM writeCycles(%d bytes)", bytes[i]);
+      check(name, OM_WRITE_CYCLES[i], om_write_cycles(bytes[i], OM_RESET_DIVIDER));
+    }
+    check("OM burstCloseCycles", OM_BURST_CLOSE_CYCLES, om_burst_close_cycles(OM_RESET_DIVIDER));
+    check("OM postedDrainCycles", OM_POSTED_DRAIN_CYCLES,
+          om_posted_drain_cycles(OM_RESET_DIVIDER, OM_CE_GAP_RESET));
+    printf("\n");
+  }
+
+  // ─── Test 8: Interrupt moderation ───────────────────────
+  {
+    int n = (int)plusarg_u64(contextp, "irq_writes", 200);
+    printf("-- Test 8: Interrupt moderation (%d word writes) --\n", n);
+
+    apb_write(CSR_INT_CTRL, 0x12340010);
+    check("INT_CTRL register", 0x12340010, apb_read(CSR_INT_CTRL));
+
+    // TIMEOUT covers a full 32-write batch, so it only flushes the tail
+    struct { uint32_t thresh, timeout; int expected; } cases[] = {
+        {1, 0, n},
+        {8, 0, n / 8},
+        {32, 0, n / 32},
+        {32, 16384, (n + 31) / 32},
+        {255, 2048, -1},
+    };
+    double mb = n * 4.0 / (1 << 20);
+    for (const auto &c : cases) {
+      uint64_t cycles = 0;
+      uint64_t irqs = run_moderated(c.thresh, c.timeout, n, &cycles);
+      printf("  THRESH=%3u TIMEOUT=%5u: %5llu irqs, %9.1f irqs/MB, %llu cycles\n",
+             c.thresh, c.timeout, (unsigned long long)irqs, irqs / mb,
+             (unsigned long long)cycles);
+      if (c.expected >= 0) {
+        char name[64];
+        snprintf(name, sizeof(name), "irqs(THRESH=%u, TIMEOUT=%u)", c.thresh, c.timeout);
+        check(name, c.expected, (uint32_t)irqs);
+      }
+    }
+    printf("\n");
+  }
+
+  // ─── Test 9: Data transforms ────────────────────────────
+  // Writes go through XFORM.TX, then are read back raw (XFORM = 0) and
+  // through XFORM.RX.
+  {
+    printf("-- Test 9: XFORM data transforms --\n");
+    uint32_t base = 0x700;
+
+    apb_write(CSR_XFORM, XF_BSWAP32);
+    apb_write(base, 0x11223344, 0xF);
+    apb_write(CSR_XFORM, 0);
+    check("TX bswap32, raw read", 0x44332211, apb_read(base));
+    apb_write(CSR_XFORM, XF_BSWAP32 << 8);
+    check("TX bswap32, RX bswap32", 0x11223344, apb_read(base));
+
+    // The strobe moves with the byte: lane 0 lands at address + 3
+    apb_write(CSR_XFORM, XF_BSWAP32);
+    apb_write(base, 0x000000AB, 0x1);
+    apb_write(CSR_XFORM, 0);
+    check("TX bswap32 byte write", 0xAB332211, apb_read(base));
+
+    apb_write(CSR_XFORM, XF_BSWAP16 | XF_BITREV);
+    apb_write(base + 4, 0x80C00103, 0xF);
+    apb_write(CSR_XFORM, 0);
+    check("TX bswap16+bitrev, raw read", 0x0301C080, apb_read(base + 4));
+
+    apb_write(CSR_XFORM, XF_NIBSWAP << 8);
+    check("RX nibswap", 0x30100C08, apb_read(base + 4));
+    apb_write(CSR_XFORM, 0);
+    printf("\n");
+  }
+
+  // ─── Test 10: Bursts ────────────────────────────────────
+  // The "CPU" idles up to a few hundred cycles between accesses, so SCK
+  // sits paused mid-transaction with CE low; the PSRAM model must carry
+  // on from where it stopped. One page (0x800..0xBFF) plus a crossing
+  // into the next.
+  {
+    printf("-- Test 10: Bursts with SCK paused between accesses --\n");
+    const uint32_t base = 0x800;
+    const int n = 64;
+    uint32_t vals[n];
+    uint32_t lcg = 0x0B0E57u;
+    int errors = 0;
+    psram_verbose = false;
+
+    for (int i = 0; i < n; i++) {
+      lcg = lcg * 1664525u + 1013904223u;
+      vals[i] = lcg;
+      apb_write(base + 4 * i, vals[i], 0xF);
+    }
+    uint64_t t0 = sim_time;
+    for (int i = 0; i < n; i++)
+      errors += apb_read(base + 4 * i) != vals[i];
+    uint64_t single = (sim_time - t0) / 2;
+
+    // Back-to-back sequential reads
+    set_burst(BURST_RD);
+    uint64_t ce0 = ce_rises;
+    t0 = sim_time;
+    for (int i = 0; i < n; i++)
+      errors += apb_read(base + 4 * i) != vals[i];
+    uint64_t burst = (sim_time - t0) / 2;
+    check("burst read: CE held low", 0, (uint32_t)(ce_rises - ce0));
+    printf("  %d sequential reads: %llu cycles single, %llu cycles burst (%.2fx)\n", n,
+           (unsigned long long)single, (unsigned long long)burst,
+           burst ? (double)single / burst : 0.0);
+    check("burst read faster than single reads", 1, burst < single);
+
+    // Slow consumer: SCK pauses on a full buffer. Going back to `base`
+    // is not sequential and reopens the burst.
+    errors += apb_read(base) != vals[0];
+    ce0 = ce_rises;
+    for (int i = 1; i < n; i++) {
+      lcg = lcg * 1664525u + 1013904223u;
+      idle_cycles(lcg >> 24);
+      errors += apb_read(base + 4 * i) != vals[i];
+    }
+    check("paused burst read: CE held low", 0, (uint32_t)(ce_rises - ce0));
+    check("burst read data", 0, errors);
+
+    // A non-sequential read closes the open burst
+    ce0 = ce_rises;
+    check("non-sequential read", vals[5], apb_read(base + 4 * 5));
+    check("non-sequential read closes the burst", 1, (uint32_t)(ce_rises - ce0));
+
+    // Write burst with gaps, then a byte write that closes it
+    set_burst(BURST_WR);
+    for (int i = 0; i < n; i++) {
+      lcg = lcg * 1664525u + 1013904223u;
+      vals[i] = lcg;
+      idle_cycles((lcg >> 8) & 0xFF);
+      apb_write(base + 4 * i, vals[i], 0xF);
+      if (i == 0) ce0 = ce_rises; // the first write closed the read burst
+    }
+    check("paused burst write: CE held low", 0, (uint32_t)(ce_rises - ce0));
+    apb_write(base, 0x000000EE, 0x1);
+    vals[0] = (vals[0] & ~0xFFu) | 0xEE;
+    set_burst(0);
+    errors = 0;
+    for (int i = 0; i < n; i++)
+      errors += apb_read(base + 4 * i) != vals[i];
+    check("burst write data", 0, errors);
+
+    // Crossing a page boundary ends the burst at the boundary
+    const uint32_t edge = base + OM_BURST_PAGE_BYTES - 8;
+    uint32_t cross[4];
+    for (int i = 0; i < 4; i++) {
+      cross[i] = 0x9A6E0000u | i;
+      apb_write(edge + 4 * i, cross[i], 0xF);
+    }
+    set_burst(BURST_RD | BURST_WR);
+    for (int i = 0; i < 4; i++)
+      apb_write(edge + 4 * i, ~cross[i], 0xF);
+    errors = 0;
+    for (int i = 0; i < 4; i++)
+      errors += apb_read(edge + 4 * i) != ~cross[i];
+    check("burst across a page boundary", 0, errors);
+
+    // CE_MAX closes an idle burst; the prefetched word is still served
+    set_burst(BURST_RD | 1000u << 16);
+    check("BURST register", BURST_RD | 1000u << 16, apb_read(CSR_BURST));
+    check("burst opened", vals[0], apb_read(base));
+    ce0 = ce_rises;
+    idle_cycles(1500);
+    check("CE_MAX closes an idle burst", 1, (uint32_t)(ce_rises - ce0));
+    check("prefetched word after CE_MAX", vals[1], apb_read(base + 4));
+    set_burst(0);
+    psram_verbose = true;
+    printf("\n");
+  }
+
+  // ─── Test 11: Pipelined transactions ────────────────────
+  // Word writes to scattered addresses. Posted, each one is issued while
+  // the previous one is still on the wire, so the APB side runs at the
+  // serial link rate and CE# stays high for exactly CE_GAP cycles.
+  {
+    printf("-- Test 11: Pipelined transactions (posted writes, CE# gap) --\n");
+    const int n = 64;
+    const int link = om_write_cycles(OM_MAX_PAYLOAD_BYTES, OM_RESET_DIVIDER) - OM_ACCESS_OVERHEAD;
+    uint32_t addrs[n], vals[n];
+    uint32_t lcg = 0x919E11u;
+    for (int i = 0; i < n; i++) {
+      lcg = lcg * 1664525u + 1013904223u;
+      addrs[i] = 0x4000 + 4 * ((i * 389) & 0x3FF); // distinct words
+      vals[i] = lcg;
+    }
+    psram_verbose = false;
+
+    uint64_t t0 = sim_time;
+    for (int i = 0; i < n; i++)
+      apb_write(addrs[i], ~vals[i], 0xF);
+    uint64_t unposted = (sim_time - t0) / 2;
+
+    set_pipe(1, true);
+    check("PIPE register", PIPE_POST | 1, apb_read(CSR_PIPE));
+    ce_gap_min = ~0ull;
+    t0 = sim_time;
+    for (int i = 0; i < n; i++)
+      apb_write(addrs[i], vals[i], 0xF);
+    uint64_t posted = (sim_time - t0) / 2;
+    check("CE# gap at CE_GAP=1", 1, (uint32_t)ce_gap_min);
+
+    int errors = 0;
+    for (int i = 0; i < n; i++)
+      errors += apb_read(addrs[i]) != vals[i];
+    check("posted write data", 0, errors);
+    printf("  %d random word writes: %llu cycles unposted, %llu posted "
+           "(%.1f / %.1f cycles per write, link limit %d)\n", n,
+           (unsigned long long)unposted, (unsigned long long)posted,
+           (double)unposted / n, (double)posted / n, link);
+    check("posted writes faster", 1, posted < unposted);
+
+    // A longer gap is honoured exactly
+    set_pipe(8, true);
+    ce_gap_min = ~0ull;
+    for (int i = 0; i < 16; i++)
+      apb_write(addrs[i], vals[i] ^ 0x5A5A5A5A, 0xF);
+    check("CE# gap at CE_GAP=8", 8, (uint32_t)ce_gap_min);
+
+    // A read right behind a posted write sees its data
+    apb_write(addrs[0], 0x600DF00D, 0xF);
+    check("read after posted write", 0x600DF00D, apb_read(addrs[0]));
+
+    set_pipe(1, false);
+    psram_verbose = true;
+    printf("\n");
+  }
+
+  // ─── Test 12: RX compare ────────────────────────────────
+  // Erase-verify style pass: every word must read back as all ones.
+  {
+    printf("-- Test 12: RX compare on memory reads (CMP CSR) --\n");
+    const uint32_t base = 0x6000;
+    const int words = 64;
+    psram_verbose = false;
+    for (int i = 0; i < words; i++)
+      apb_write(base + 4 * i, 0xFFFFFFFF);
+    apb_write(CSR_CMP_EXP, 0xFFFFFFFF);
+    apb_write(CSR_CMP_MASK, 0xFFFFFFFF);
+    apb_write(CSR_CMP_CTRL, CMP_EN);
+    check("CMP_EXP register", 0xFFFFFFFF, apb_read(CSR_CMP_EXP));
+
+    uint64_t irq0 = irq_edges;
+    for (int i = 0; i < words; i++)
+      apb_read(base + 4 * i);
+    check("matching pass", CMP_EN, apb_read(CSR_CMP_CTRL));
+    check("no intO while matching", 0, (uint32_t)(irq_edges - irq0));
+
+    const uint32_t bad = base + 4 * 17 + 1;
+    apb_write(bad & ~3u, 0, 0x2);
+    for (int i = 0; i < words; i++)
+      apb_read(base + 4 * i);
+    uint32_t st = apb_read(CSR_CMP_CTRL);
+    check("FAIL after mismatch", CMP_EN | CMP_FAIL, st & 0xFF);
+    check("mismatch byte address", bad, st >> 8);
+    check("intO on failure", 1, dut->intO);
+    apb_write(CSR_CMP_CTRL, CMP_EN | CMP_FAIL);
+    check("intO after clear", 0, dut->intO);
+
+    // The masked byte lane is ignored
+    apb_write(CSR_CMP_MASK, 0xFFFF00FF);
+    for (int i = 0; i < words; i++)
+      apb_read(base + 4 * i);
+    check("masked lane ignored", CMP_EN, apb_read(CSR_CMP_CTRL));
+
+    apb_write(CSR_CMP_CTRL, 0);
+    apb_write(CSR_CMP_MASK, 0xFFFFFFFF);
+    psram_verbose = true;
+    printf("\n");
+  }
+
+  // ─── Test 13: Link efficiency ───────────────────────────
+  {
+    printf("-- Test 13: Link efficiency from the pins --\n");
+    const uint32_t base = 0x6000;
+    const int words = 16;
+    psram_verbose = false;
+
+    link_mon.clear();
+    apb_read(base);
+    const LinkClass &c = link_mon.last();
+    check("single read classified", 1, c.type == "read 4B");
+    check("cmd SCK cycles", 2, c.sck[LINK_CMD]);
+    check("addr SCK cycles", 6, c.sck[LINK_ADDR]);
+    check("turnaround SCK cycles", 1, c.sck[LINK_TURN]);
+    check("dummy SCK cycles", 5, c.sck[LINK_DUMMY]);
+    check("data SCK cycles", 8, c.sck[LINK_DATA]);
+    check("payload bits", 32, c.payload_bits);
+
+    link_mon.clear();
+    for (int i = 0; i < words; i++)
+      apb_read(base + 4 * i);
+    double single = link_mon.aggregate().efficiency();
+    link_mon.report("QSPI, single reads");
+
+    set_burst(BURST_RD);
+    link_mon.clear();
+    for (int i = 0; i < words; i++)
+      apb_read(base + 4 * i);
+    set_burst(0);
+    double burst = link_mon.aggregate().efficiency();
+    link_mon.report("QSPI, read burst");
+    printf("  %d words: %.1f%% single, %.1f%% burst\n", words, 100.0 * single,
+           100.0 * burst);
+    check("burst raises link efficiency", 1, burst > single);
+
+    psram_verbose = true;
+    link_mon.clear();
+    printf("\n");
+  }
+
+  // ─── Test 14: Reference driver ──────────────────────────
+  {
+    printf("-- Test 14: Reference driver (driver/qspi_drv.c) --\n");
+    const uint32_t base = 0x7000;
+    const size_t len = 256;
+    uint8_t src[len + 8], dst[len + 8];
+    uint32_t lcg = 0xD21BE5u;
+    for (size_t i = 0; i < sizeof(src); i++) {
+      lcg = lcg * 1664525u + 1013904223u;
+      src[i] = (uint8_t)(lcg >> 24);
+    }
+    psram_verbose = false;
+    qspi_dev qd;
+    qspi_init(&qd, &drv_io, 0, QSPI_PIPE_CE_GAP(1));
+
+    uint64_t c0 = sim_time / 2;
+    qspi_write32(&qd, base, 0x0DDBA11u);
+    drv_cost("qspi_write32", 4, sim_time / 2 - c0);
+    c0 = sim_time / 2;
+    uint32_t w = qspi_read32(&qd, base);
+    drv_cost("qspi_read32", 4, sim_time / 2 - c0);
+    check("qspi_read32", 0x0DDBA11u, w);
+
+    // Unaligned both ways: byte head, halfword head, word body, byte tail
+    c0 = sim_time / 2;
+    qspi_memcpy_to(&qd, base + 1, src, len);
+    drv_cost("qspi_memcpy_to (burst)", len, sim_time / 2 - c0);
+    memset(dst, 0, sizeof(dst));
+    c0 = sim_time / 2;
+    qspi_memcpy_from(&qd, dst, base + 1, len);
+    drv_cost("qspi_memcpy_from (burst)", len, sim_time / 2 - c0);
+    check("memcpy round trip", 0, (uint32_t)memcmp(src, dst, len));
+
+    // Scatter list: three pieces, read back in the other order
+    qspi_sg wr[3] = {{base + 0x200, src, 5}, {base + 0x300, src + 5, 64},
+                     {base + 0x402, src + 69, 7}};
+    qspi_sg rd[3] = {{base + 0x402, dst + 69, 7}, {base + 0x200, dst, 5},
+                     {base + 0x300, dst + 5, 64}};
+    memset(dst, 0, sizeof(dst));
+    c0 = sim_time / 2;
+    qspi_write_sg(&qd, wr, 3);
+    drv_cost("qspi_write_sg (3 pieces)", 76, sim_time / 2 - c0);
+    c0 = sim_time / 2;
+    qspi_read_sg(&qd, rd, 3);
+    drv_cost("qspi_read_sg (3 pieces)", 76, sim_time / 2 - c0);
+    check("scatter list round trip", 0, (uint32_t)memcmp(src, dst, 76));
+
+    // Queued: posted writes return early, the fence pays the rest
+    qspi_init(&qd, &drv_io, 0, QSPI_PIPE_CE_GAP(1) | QSPI_PIPE_POST);
+    c0 = sim_time / 2;
+    qspi_memcpy_to(&qd, base + 0x800, src + 3, len);
+    uint64_t queued = sim_time / 2 - c0;
+    drv_cost("qspi_memcpy_to (posted)", len, queued);
+    c0 = sim_time / 2;
+    qspi_fence(&qd);
+    drv_cost("qspi_fence", 0, sim_time / 2 - c0);
+    memset(dst, 0, sizeof(dst));
+    qspi_memcpy_from(&qd, dst, base + 0x800, len);
+    check("posted copy round trip", 0, (uint32_t)memcmp(src + 3, dst, len));
+
+    set_pipe(1, false);
+    set_burst(0);
+    psram_verbose = true;
+    printf("\n");
+  }
+
+  // ─── Test 15: Boot microcode ────────────────────────────
+  {
+    printf("-- Test 15: Boot microcode (INIT table) --\n");
+    const uint32_t addr = 0x9000;
+    psram_verbose = false;
+    check("INIT_CTRL after reset", init_count(5), apb_read(CSR_INIT_CTRL));
+    check("entry 0: QPI 0x66", INIT_QPI | 0x66, apb_read(CSR_INIT_CMD(0)));
+    check("entry 1: QPI 0x99, WAIT 16", init_wait(16) | INIT_QPI | 0x99, apb_read(CSR_INIT_CMD(1)));
+    check("entry 4: SPI 0x35", 0x35, apb_read(CSR_INIT_CMD(4)));
+    check("entry 5 unused", 0, apb_read(CSR_INIT_CMD(5)));
+    apb_write(addr, 0xB007C0DEu);
+
+    // RUN, then a read that waits for the table; cycles of both
+    auto replay = [&](uint32_t count) {
+      uint64_t c0 = sim_time / 2;
+      link_mon.clear();
+      apb_write(CSR_INIT_CTRL, init_count(count) | INIT_RUN);
+      latency_guard_armed = false; // the next access waits for the table
+      check("memory after replay", 0xB007C0DEu, apb_read(addr));
+      return sim_time / 2 - c0;
+    };
+    auto sent = [&](const char *type) {
+      const LinkStats *st = link_mon.stats(type);
+      return st ? (uint32_t)st->count : 0u;
+    };
+
+    // The PSRAM is in QPI mode now: the reset table returns it to SPI first
+    uint64_t ce0 = ce_rises;
+    replay(5);
+    check("replay: a transaction per entry", 5 + 1, (uint32_t)(ce_rises - ce0));
+    check("replay: QPI reset", 1, sent("QPI 0x99"));
+    check("replay: QPI entry", 1, sent("enter QPI (0x35)"));
+
+    // Reprogrammed: a command with an argument byte (the PSRAM model drops
+    // it at CE#), reset in QPI with a WAIT after it, QPI entry
+    apb_write(CSR_INIT_CMD(0), INIT_QPI | init_narg(1) | 0xC0);
+    apb_write(CSR_INIT_ARG(0), 0x5A);
+    apb_write(CSR_INIT_CMD(1), INIT_QPI | 0x66);
+    apb_write(CSR_INIT_CMD(2), INIT_QPI | 0x99);
+    apb_write(CSR_INIT_CMD(3), 0x35);
+    check("INIT_ARG readback", 0x5A, apb_read(CSR_INIT_ARG(0)));
+    ce0 = ce_rises;
+    uint64_t fast = replay(4);
+    check("reprogrammed: a transaction per entry", 4 + 1, (uint32_t)(ce_rises - ce0));
+    check("argument byte on the wire", 1, sent("QPI 0xC0 5A"));
+    apb_write(CSR_INIT_CMD(2), init_wait(300) | INIT_QPI | 0x99);
+    uint64_t slow = replay(4);
+    printf("  replay: %llu cycles, %llu with WAIT 300\n", (unsigned long long)fast,
+           (unsigned long long)slow);
+    check("WAIT holds CE# high", 1, slow >= fast + 300);
+
+    // COUNT 0: RUN sends nothing
+    ce0 = ce_rises;
+    replay(0);
+    check("empty table: no transactions", 1, (uint32_t)(ce_rises - ce0));
+
+    // Back to the reset table
+    apb_write(CSR_INIT_CMD(0), INIT_QPI | 0x66);
+    apb_write(CSR_INIT_ARG(0), 0);
+    apb_write(CSR_INIT_CMD(1), init_wait(16) | INIT_QPI | 0x99);
+    apb_write(CSR_INIT_CMD(2), 0x66);
+    apb_write(CSR_INIT_CMD(3), init_wait(16) | 0x99);
+    replay(5);
+
+    psram_verbose = true;
+    link_mon.clear();
+    printf("\n");
+  }
+
+  // ─── Test 16: SCK phase dividers ────────────────────────
+  {
+    printf("-- Test 16: SCK phase dividers (DIV CSRs) --\n");
+    const uint32_t base = 0xA000;
+    const int words = 16;
+    psram_verbose = false;
+    check("DIV_CMD after reset", OM_RESET_DIVIDER, apb_read(CSR_DIV_CMD));
+    check("DIV_DATA after reset", OM_RESET_DIVIDER, apb_read(CSR_DIV_DATA));
+
+    // Command, address and dummy at 1/14 of the clock, data at 1/4
+    const int div[4] = {6, 6, 6, 1};
+    set_dividers(div[0], div[1], div[2], div[3]);
+    check("DIV_DUMMY readback", 6, apb_read(CSR_DIV_DUMMY));
+    const int wr[4] = {OM_CMD_NIBBLES, OM_ADDR_NIBBLES, 0, 2 * OM_MAX_PAYLOAD_BYTES};
+    const int rd[4] = {OM_CMD_NIBBLES, OM_ADDR_NIBBLES, OM_READ_DUMMY_NIBBLES,
+                       2 * OM_MAX_PAYLOAD_BYTES};
+    apb_write(base, 0xFA57DA7Au);
+    check("word write cycles", om_phase_cycles(wr, div), last_access_cycles);
+    check("word read", 0xFA57DA7Au, apb_read(base));
+    check("word read cycles", om_phase_cycles(rd, div), last_access_cycles);
+    printf("  word read: %d cycles, %d at the reset divider\n", last_access_cycles,
+           om_read_cycles(OM_RESET_DIVIDER));
+
+    for (int i = 0; i < words; i++)
+      apb_write(base + 4 * i, 0x51DE0000u + i);
+    set_burst(BURST_RD);
+    int errors = 0;
+    for (int i = 0; i < words; i++)
+      errors += apb_read(base + 4 * i) != 0x51DE0000u + i;
+    set_burst(0);
+    check("read burst at the data rate", 0, errors);
+
+    set_dividers(OM_RESET_DIVIDER, OM_RESET_DIVIDER, OM_RESET_DIVIDER, OM_RESET_DIVIDER);
+    psram_verbose = true;
+    printf("\n");
+  }
+
+  if (uint32_t burst = (uint32_t)plusarg_u64(contextp, "burst", 0))
+    set_burst(burst);
+
+  // ─── Workload (optional) ────────────────────────────────
+  if (uint64_t rounds = plusarg_u64(contextp, "workload", 0)) {
+    printf("-- Workload: %llu rounds --\n", (unsigned long long)rounds);
+    run_workload(rounds, ckpt_every);
+    printf("\n");
+  }
+
+  // ─── XIP benchmark (optional) ───────────────────────────
+  if (xip) {
+    printf("-- XIP benchmark --\n");
+    run_xip(image, plusarg_u64(contextp, "xip", 0));
+    printf("\n");
+  }
+
   // Cool-down
   for (int i = 0; i < 20; i++)
     tick();
 
   printf("====================================================\n");
+  if (latency_violations) test_fail++;
   printf("  Results: %d passed, %d failed\n", test_pass, test_fail);
-  printf("  Waveform: build/qspi_psram.vcd\n");
+  printf("  Latency violations: %d\n", latency_violations);
+  printf("  Waveform: %s\n", trace.path());
+  link_mon.report("QSPI");
+  perf.report(sim_time / 2);
+  sim_coverage(contextp, "build/qspi_psram_coverage.dat");
   printf("====================================================\n");
 
-  tfp->close();
-  delete tfp;
+  trace.close();
+  dut->final();
   delete dut;
   delete contextp;
   return test_fail > 0 ? 1 : 0;
@@ -0,0 +1,465 @@
+// sim_soc.cpp
+// APB contention study on PeripheralSubsystemTop (Verilator)
+// SPI (MOSI looped back to MISO), QSPI + PSRAM (SRAM backend) and a
+// generic wait-state slave behind one APB decoder; wiring done in Chisel.
+//
+// The harness is one APB bridge serving three traffic sources. Each
+// source produces requests at pseudo-random times into its own queue; the
+// bridge runs one transfer at a time and always picks the oldest ready
+// request. Every request is timed from arrival to completion, and every
+// cycle a request spends queued is charged to the source whose transfer
+// holds the bus, separately for cycles in which that transfer has pready
+// low (a stall).
+//
+//   QSPI   random word reads / writes in a 16 KiB PSRAM window,
+//          reads checked against a reference copy
+//   SPI    32-bit loopback jobs: read RX0 (checked against the previous
+//          job's TX), write TX0, write CTRL.GO. Blocking: the job is
+//          issued as is and its RX0 read stalls APB while the previous
+//          transfer runs. Polling: CTRL is read first (legal during a
+//          transfer) and the job retries later while GO is set.
+//   SLAVE  random word reads / writes, checked against a reference copy
+//
+// Test plan:
+//   1. Each source alone: baseline latency
+//   2. All three sources, SPI blocking: latency per peripheral and the
+//      queueing cycles charged to each peripheral's stalls
+//   3. All three sources, SPI polling: SPI stalls nobody
+//
+// Plusargs:
+//   +reqs=N       requests per source and phase (default 300)
+//   +gap=N        mean cycles between QSPI / SLAVE requests (default 60)
+//   +spi_gap=N    mean cycles between SPI jobs (default 480)
+//   +spi_div=N    SPI DIVIDER (default 4: a 32-bit transfer is 320 cycles)
+//   +poll_gap=N   cycles between CTRL polls of a waiting SPI job (default 16)
+
+#include "VPeripheralSubsystemTop.h"
+#include "sim_common.h"
+#include "verilated.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+
+// ─── Address map (PeripheralSubsystemTopParameter) ─────────────
+static constexpr uint32_t SLOT_BITS  = 25;
+static constexpr uint32_t QSPI_BASE  = 0u << SLOT_BITS;
+static constexpr uint32_t SPI_BASE   = 1u << SLOT_BITS;
+static constexpr uint32_t SLAVE_BASE = 2u << SLOT_BITS;
+
+static constexpr uint32_t SPI_TX0     = SPI_BASE + 0x00;
+static constexpr uint32_t SPI_CTRL    = SPI_BASE + 0x10;
+static constexpr uint32_t SPI_DIVIDER = SPI_BASE + 0x14;
+static constexpr uint32_t SPI_SS      = SPI_BASE + 0x18;
+static constexpr uint32_t CTRL_GO     = 1 << 8;
+static constexpr uint32_t CTRL_TX_NEG = 1 << 10;
+static constexpr uint32_t CTRL_ASS    = 1 << 13;
+
+static constexpr uint32_t QSPI_WINDOW = 16 << 10; // bytes exercised
+static constexpr uint32_t SLAVE_WORDS = 256;      // slave.words
+
+// ─── Simulation globals ────────────────────────────────────────
+static VPeripheralSubsystemTop *dut = nullptr;
+static SimTrace<VPeripheralSubsystemTop> trace;
+static uint64_t sim_time = 0;
+static uint64_t cycle = 0;
+static int test_pass = 0;
+static int test_fail = 0;
+
+static constexpr int MAX_CYCLES = 500000;
+
+// ─── Traffic ───────────────────────────────────────────────────
+enum Src { SRC_QSPI, SRC_SPI, SRC_SLAVE, NSRC };
+static const char *const SRC_NAME[NSRC] = {"QSPI", "SPI", "SLAVE"};
+
+enum Kind { RD, WR, SPI_POLL, SPI_RX, SPI_TX, SPI_GO };
+
+struct Req {
+  Kind kind;
+  uint32_t addr;
+  uint32_t data;
+  uint64_t arrival; // cycle the request became ready
+  uint64_t job;     // SPI: arrival of the job it belongs to
+};
+
+struct SrcStats {
+  uint64_t reqs = 0, lat_sum = 0, lat_max = 0, service_sum = 0;
+  uint64_t jobs = 0, job_sum = 0, job_max = 0; // SPI jobs (first step to GO)
+  uint64_t wait[NSRC] = {};  // cycles queued while the bus served source j
+  uint64_t stall[NSRC] = {}; // ... and source j held pready low
+  int errors = 0;
+};
+
+struct Source {
+  std::deque<Req> q;
+  uint64_t next = 0;  // arrival of the next generated request
+  uint64_t left = 0;  // requests still to generate
+  uint64_t gap = 0;   // mean inter-arrival gap
+  uint32_t lcg = 0;
+};
+
+static Source src[NSRC];
+static SrcStats stats[NSRC];
+static bool spi_poll_mode = false;
+static uint64_t mean_gap = 60;
+static uint64_t spi_gap = 480;
+static uint64_t poll_gap = 16;
+
+// Bus state, sampled by tick() for the charge matrix
+static int bus_owner = -1;      // source of the transfer on the bus
+static bool bus_access = false; // in the ACCESS phase
+static bool last_pslverr = false;
+
+static uint32_t qspi_ref[QSPI_WINDOW / 4];
+static uint32_t slave_ref[SLAVE_WORDS];
+static uint32_t spi_last_tx = 0;
+static bool spi_have_tx = false;
+
+static uint32_t lcg_next(uint32_t &s) { return s = s * 1664525u + 1013904223u; }
+
+// Uniform inter-arrival gap in [1, 2 * mean]
+static uint64_t next_gap(uint32_t &s, uint64_t mean) {
+  uint32_t r = lcg_next(s) >> 16;
+  return 1 + (uint64_t)r * 2 * mean / 65536;
+}
+
+static void generate(int i) {
+  Source &s = src[i];
+  while (s.left && s.next <= cycle) {
+    uint32_t r = lcg_next(s.lcg);
+    uint64_t t = s.next;
+    switch (i) {
+    case SRC_QSPI: {
+      uint32_t a = (r >> 8) % (QSPI_WINDOW / 4) * 4;
+      s.q.push_back({(r & 1) ? WR : RD, QSPI_BASE + a, lcg_next(s.lcg), t, t});
+      break;
+    }
+    case SRC_SLAVE: {
+      uint32_t a = (r >> 8) % SLAVE_WORDS * 4;
+      s.q.push_back({(r & 1) ? WR : RD, SLAVE_BASE + a, lcg_next(s.lcg), t, t});
+      break;
+    }
+    case SRC_SPI:
+      if (spi_poll_mode) {
+        s.q.push_back({SPI_POLL, SPI_CTRL, 0, t, t});
+      } else {
+        s.q.push_back({SPI_RX, SPI_TX0, 0, t, t});
+        s.q.push_back({SPI_TX, SPI_TX0, r, t, t});
+        s.q.push_back({SPI_GO, SPI_CTRL, 32 | CTRL_GO | CTRL_ASS | CTRL_TX_NEG, t, t});
+      }
+      break;
+    }
+    s.left--;
+    s.next += next_gap(s.lcg, s.gap);
+  }
+}
+
+// ─── Clock tick ────────────────────────────────────────────────
+static void tick() {
+  dut->clock = 1;
+  dut->eval();
+  trace.dump(sim_time++);
+  // Charge every queued request to the transfer holding the bus
+  if (bus_owner >= 0) {
+    bool stalled = bus_access && !dut->pready;
+    for (int i = 0; i < NSRC; i++)
+      for (const Req &r : src[i].q) {
+        if (r.arrival > cycle) break;
+        stats[i].wait[bus_owner]++;
+        if (stalled) stats[i].stall[bus_owner]++;
+      }
+  }
+  cycle++;
+  for (int i = 0; i < NSRC; i++) generate(i);
+  dut->clock = 0;
+  dut->eval();
+  trace.dump(sim_time++);
+}
+
+// ─── Reset ─────────────────────────────────────────────────────
+static void do_reset() {
+  dut->reset = 0;
+  dut->clock = 0;
+  dut->psel = 0;
+  dut->penable = 0;
+  dut->pwrite = 0;
+  dut->pstrb = 0;
+  dut->paddr = 0;
+  dut->pwdata = 0;
+  dut->eval();
+  dut->reset = 1;
+  for (int i = 0; i < 10; i++) tick();
+  dut->reset = 0;
+  tick();
+}
+
+// ─── APB transfer (waits for pready) ───────────────────────────
+// Same phases as sim_qspi_psram.cpp: SETUP, ACCESS until pready, one
+// more cycle with penable held, IDLE. Returns prdata; `service` is the
+// SETUP..pready cycle count.
+static uint32_t apb_xfer(int owner, bool write, uint32_t addr, uint32_t data, int *service) {
+  bus_owner = owner;
+  dut->paddr = addr;
+  dut->pwdata = data;
+  dut->pstrb = 0xF;
+  dut->pwrite = write;
+  dut->psel = 1;
+  dut->penable = 0;
+  tick();
+  dut->penable = 1;
+  bus_access = true;
+  int cycles = 0;
+  do {
+    tick();
+    if (++cycles > MAX_CYCLES) {
+      printf("  TIMEOUT: apb_%s(0x%08X) did not complete\n", write ? "write" : "read", addr);
+      test_fail++;
+      break;
+    }
+  } while (!dut->pready);
+  bus_access = false;
+  uint32_t val = dut->prdata;
+  last_pslverr = dut->pslverr;
+  tick();
+  dut->psel = 0;
+  dut->penable = 0;
+  dut->pwrite = 0;
+  tick();
+  bus_owner = -1;
+  if (service) *service = 1 + cycles;
+  return val;
+}
+
+static void apb_write(uint32_t addr, uint32_t data) { apb_xfer(-1, true, addr, data, nullptr); }
+static uint32_t apb_read(uint32_t addr) { return apb_xfer(-1, false, addr, 0, nullptr); }
+
+// ─── Check helper ──────────────────────────────────────────────
+static void check(const char *name, uint32_t expected, uint32_t actual) {
+  if (actual == expected) {
+    printf("  PASS %s: expected 0x%08X, got 0x%08X\n", name, expected, actual);
+    test_pass++;
+  } else {
+    printf("  FAIL %s: expected 0x%08X, got 0x%08X\n", name, expected, actual);
+    test_fail++;
+  }
+}
+
+// ─── Bridge ────────────────────────────────────────────────────
+// Serves the oldest ready request; a source's queue is in issue order.
+static void serve(int i) {
+  Source &s = src[i];
+  SrcStats &st = stats[i];
+  Req r = s.q.front();
+  s.q.pop_front();
+  bool write = r.kind == WR || r.kind == SPI_TX || r.kind == SPI_GO;
+  int service = 0;
+  uint32_t val = apb_xfer(i, write, r.addr, r.data, &service);
+  uint64_t lat = cycle - r.arrival;
+  st.reqs++;
+  st.lat_sum += lat;
+  st.lat_max = std::max(st.lat_max, lat);
+  st.service_sum += service;
+  if (last_pslverr && st.errors++ < 4)
+    printf("  %s: PSLVERR at 0x%08X\n", SRC_NAME[i], r.addr);
+
+  switch (r.kind) {
+  case RD: {
+    uint32_t exp = i == SRC_QSPI ? qspi_ref[(r.addr - QSPI_BASE) / 4]
+                                 : slave_ref[(r.addr - SLAVE_BASE) / 4];
+    if (val != exp && st.errors++ < 4)
+      printf("  %s read 0x%08X: expected 0x%08X, got 0x%08X\n", SRC_NAME[i], r.addr, exp, val);
+    break;
+  }
+  case WR:
+    if (i == SRC_QSPI)
+      qspi_ref[(r.addr - QSPI_BASE) / 4] = r.data;
+    else
+      slave_ref[(r.addr - SLAVE_BASE) / 4] = r.data;
+    break;
+  case SPI_POLL:
+    if (val & CTRL_GO) { // transfer running: retry later, ahead of newer jobs
+      s.q.push_front({SPI_POLL, SPI_CTRL, 0, cycle + poll_gap, r.job});
+    } else {
+      uint32_t tx = lcg_next(s.lcg);
+      s.q.push_front({SPI_GO, SPI_CTRL, 32 | CTRL_GO | CTRL_ASS | CTRL_TX_NEG, cycle, r.job});
+      s.q.push_front({SPI_TX, SPI_TX0, tx, cycle, r.job});
+      s.q.push_front({SPI_RX, SPI_TX0, 0, cycle, r.job});
+    }
+    break;
+  case SPI_RX:
+    if (spi_have_tx && val != spi_last_tx && st.errors++ < 4)
+      printf("  SPI loopback: expected 0x%08X, got 0x%08X\n", spi_last_tx, val);
+    break;
+  case SPI_TX:
+    spi_last_tx = r.data;
+    break;
+  case SPI_GO:
+    spi_have_tx = true;
+    st.jobs++;
+    st.job_sum += cycle - r.job;
+    st.job_max = std::max(st.job_max, cycle - r.job);
+    break;
+  }
+}
+
+static void run_phase(const char *title, unsigned mask, bool poll, uint64_t reqs) {
+  printf("-- %s --\n", title);
+  spi_poll_mode = poll;
+  for (int i = 0; i < NSRC; i++) {
+    stats[i] = SrcStats();
+    src[i].q.clear();
+    src[i].left = (mask >> i & 1) ? reqs : 0;
+    src[i].gap = i == SRC_SPI ? spi_gap : mean_gap;
+    src[i].next = cycle + 1;
+    src[i].lcg = 0x5EED0000u + 0x101u * i;
+  }
+  for (;;) {
+    int pick = -1;
+    bool pending = false;
+    for (int i = 0; i < NSRC; i++) {
+      pending = pending || src[i].left || !src[i].q.empty();
+      if (src[i].q.empty() || src[i].q.front().arrival > cycle) continue;
+      if (pick < 0 || src[i].q.front().arrival < src[pick].q.front().arrival) pick = i;
+    }
+    if (!pending) break;
+    if (pick < 0)
+      tick();
+    else
+      serve(pick);
+  }
+  // Let the last SPI transfer finish so the next phase starts idle
+  while (apb_read(SPI_CTRL) & CTRL_GO) {}
+
+  printf("  %-6s %6s %9s %9s %9s %9s\n", "", "reqs", "avg lat", "max lat", "avg svc", "avg job");
+  for (int i = 0; i < NSRC; i++) {
+    const SrcStats &st = stats[i];
+    if (!st.reqs) continue;
+    printf("  %-6s %6llu %9.1f %9llu %9.1f", SRC_NAME[i], (unsigned long long)st.reqs,
+           (double)st.lat_sum / st.reqs, (unsigned long long)st.lat_max,
+           (double)st.service_sum / st.reqs);
+    if (st.jobs)
+      printf(" %9.1f", (double)st.job_sum / st.jobs);
+    printf("\n");
+  }
+  printf("  Queued cycles per request, by the peripheral holding the bus (stalled):\n");
+  printf("  %-6s", "");
+  for (int j = 0; j < NSRC; j++) printf(" %16s", SRC_NAME[j]);
+  printf("\n");
+  for (int i = 0; i < NSRC; i++) {
+    const SrcStats &st = stats[i];
+    if (!st.reqs) continue;
+    printf("  %-6s", SRC_NAME[i]);
+    for (int j = 0; j < NSRC; j++)
+      printf("  %6.1f (%6.1f)", (double)st.wait[j] / st.reqs, (double)st.stall[j] / st.reqs);
+    printf("\n");
+  }
+  for (int i = 0; i < NSRC; i++)
+    if (stats[i].reqs) {
+      char name[48];
+      snprintf(name, sizeof(name), "%s data errors", SRC_NAME[i]);
+      check(name, 0, (uint32_t)stats[i].errors);
+    }
+}
+
+static double avg_lat(int i) { return stats[i].reqs ? (double)stats[i].lat_sum / stats[i].reqs : 0; }
+
+int main(int argc, char **argv) {
+  VerilatedContext *contextp = new VerilatedContext;
+  contextp->commandArgs(argc, argv);
+  contextp->traceEverOn(true);
+
+  uint64_t reqs = plusarg_u64(contextp, "reqs", 300);
+  mean_gap = plusarg_u64(contextp, "gap", 60);
+  spi_gap = plusarg_u64(contextp, "spi_gap", 480);
+  poll_gap = plusarg_u64(contextp, "poll_gap", 16);
+  uint32_t spi_div = (uint32_t)plusarg_u64(contextp, "spi_div", 4);
+
+  dut = new VPeripheralSubsystemTop{contextp};
+  trace.open(dut, "build/soc.vcd");
+  SimPerf perf;
+
+  printf("====================================================\n");
+  printf("  Peripheral Subsystem APB Contention Simulation\n");
+  printf("  SPI + QSPI/PSRAM + generic slave on one APB segment\n");
+  printf("====================================================\n\n");
+
+  do_reset();
+  printf("[time %5lu] reset done\n\n", (unsigned long)sim_time);
+
+  // ─── Setup: SPI divider / SS, initial memory contents ───
+  // The first QSPI access also waits out the PSRAM boot sequence.
+  apb_write(SPI_DIVIDER, spi_div);
+  apb_write(SPI_SS, 1);
+  for (uint32_t a = 0; a < QSPI_WINDOW; a += 4) {
+    qspi_ref[a / 4] = 0xA5000000u ^ a;
+    apb_write(QSPI_BASE + a, qspi_ref[a / 4]);
+  }
+  for (uint32_t w = 0; w < SLAVE_WORDS; w++) {
+    slave_ref[w] = 0x5A000000u ^ w;
+    apb_write(SLAVE_BASE + w * 4, slave_ref[w]);
+  }
+  check("QSPI setup read-back", qspi_ref[7], apb_read(QSPI_BASE + 28));
+  check("SLAVE setup read-back", slave_ref[7], apb_read(SLAVE_BASE + 28));
+  apb_read(3u << SLOT_BITS);
+  check("unmapped slot PSLVERR", 1, last_pslverr);
+  printf("\n");
+
+  // ─── Test 1: Baselines ──────────────────────────────────
+  double base[NSRC];
+  for (int i = 0; i < NSRC; i++) {
+    char title[48];
+    snprintf(title, sizeof(title), "Test 1: %s alone", SRC_NAME[i]);
+    run_phase(title, 1u << i, false, reqs);
+    base[i] = avg_lat(i);
+    printf("\n");
+  }
+
+  // ─── Test 2: Mixed, SPI blocking ────────────────────────
+  run_phase("Test 2: mixed traffic, SPI blocking", 7, false, reqs);
+  SrcStats blocking[NSRC];
+  for (int i = 0; i < NSRC; i++) blocking[i] = stats[i];
+  check("SPI stalls delay QSPI", 1, stats[SRC_QSPI].stall[SRC_SPI] > 0);
+  check("SPI stalls delay SLAVE", 1, stats[SRC_SLAVE].stall[SRC_SPI] > 0);
+  printf("\n");
+
+  // ─── Test 3: Mixed, SPI polling ─────────────────────────
+  run_phase("Test 3: mixed traffic, SPI polling", 7, true, reqs);
+  check("polled SPI stalls nobody", 0,
+        (uint32_t)(stats[SRC_QSPI].stall[SRC_SPI] + stats[SRC_SLAVE].stall[SRC_SPI]));
+  printf("\n");
+
+  // ─── Report ─────────────────────────────────────────────
+  printf("-- Latency inflation over the source running alone --\n");
+  printf("  %-6s %9s %9s %9s %9s %9s\n", "", "alone", "blocking", "x", "polling", "x");
+  for (int i = 0; i < NSRC; i++) {
+    double b = blocking[i].reqs ? (double)blocking[i].lat_sum / blocking[i].reqs : 0;
+    double p = avg_lat(i);
+    printf("  %-6s %9.1f %9.1f %9.2f %9.1f %9.2f\n", SRC_NAME[i], base[i], b,
+           base[i] > 0 ? b / base[i] : 0, p, base[i] > 0 ? p / base[i] : 0);
+  }
+  for (int i = 0; i < NSRC; i++) {
+    if (i == SRC_SPI || !blocking[i].reqs) continue;
+    printf("  SPI stall cost to %-5s: %.1f cycles per request (blocking), %.1f (polling)\n",
+           SRC_NAME[i], (double)blocking[i].stall[SRC_SPI] / blocking[i].reqs,
+           (double)stats[i].stall[SRC_SPI] / stats[i].reqs);
+  }
+  printf("\n");
+
+  for (int i = 0; i < 20; i++)
+    tick();
+
+  printf("====================================================\n");
+  printf("  Results: %d passed, %d failed\n", test_pass, test_fail);
+  printf("  Waveform: %s\n", trace.path());
+  perf.report(sim_time / 2);
+  sim_coverage(contextp, "build/soc_coverage.dat");
+  printf("====================================================\n");
+
+  trace.close();
+  dut->final();
+  delete dut;
+  delete contextp;
+  return test_fail > 0 ? 1 : 0;
+}
@@ -0,0 +1,370 @@
+// sim_spi_slave.cpp
+// SPI Master + SPISlave interaction test (Verilator)
+// Wiring done in Chisel (SPISlaveTop). C++ drives both APB ports.
+// SPI Mode 0: CPOL=0, CPHA=0 (tx_neg=1, rx_neg=0)
+//
+// Test contents:
+//   1. Slave register defaults
+//   2. Single byte exchange, divider=4
+//   3. 15-byte burst exchange at the slave's minimum divider
+//   4. TX underrun flag (W1C)
+//   5. RX threshold interrupt
+//   6. Sustained throughput at the minimum divider
+//
+// Plusargs:
+//   +bytes=N      bytes moved in each direction by test 6 (default 4096)
+//   +div=N        master divider for test 6 (default 1 = SCK at clk/4)
+//   +fclk_mhz=N   system clock used to convert bytes/cycle to MB/s (100)
+
+#include "VSPISlaveTop.h"
+#include "sim_common.h"
+#include "verilated.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+
+// ─── SPI master registers ───────────────────────────────────────────────
+static constexpr uint8_t ADDR_TX0    = 0 << 2;
+static constexpr uint8_t ADDR_CTRL   = 4 << 2;
+static constexpr uint8_t ADDR_DIVIDE = 5 << 2;
+static constexpr uint8_t ADDR_SS     = 6 << 2;
+
+static constexpr uint32_t CTRL_GO     = 1 << 8;
+static constexpr uint32_t CTRL_TX_NEG = 1 << 10;
+static constexpr uint32_t CTRL_ASS    = 1 << 13;
+
+// ─── SPISlave registers (spi/src/SPISlave.scala) ────────────────────────
+static constexpr uint8_t S_DATA   = 0 << 2;
+static constexpr uint8_t S_STATUS = 1 << 2;
+static constexpr uint8_t S_CTRL   = 2 << 2;
+static constexpr uint8_t S_THRESH = 3 << 2;
+
+static constexpr uint32_t S_DATA_EMPTY   = 1 << 8;
+static constexpr uint32_t S_ST_TX_EMPTY  = 1 << 1;
+static constexpr uint32_t S_ST_RX_EMPTY  = 1 << 3;
+static constexpr uint32_t S_ST_RX_OVF    = 1 << 8;
+static constexpr uint32_t S_ST_TX_UDR    = 1 << 9;
+static constexpr uint32_t S_CTRL_RX_IE   = 1 << 0;
+
+static constexpr int FIFO_DEPTH = 16;   // configs/SPISlaveTop.json
+static constexpr int MAX_BURST  = 15;   // CHAR_LEN is 7 bits: 120 bits max
+static constexpr int MIN_DIV    = 1;    // SPISlaveOM.minSckDivider
+static_assert(MAX_BURST <= FIFO_DEPTH, "a burst must fit in the slave TX FIFO");
+
+static VSPISlaveTop*          dut = nullptr;
+static SimTrace<VSPISlaveTop> trace;
+static uint64_t               sim_time = 0;
+static uint64_t               cs_cycles = 0;  // cycles with SS0 asserted
+static int                    test_pass = 0;
+static int                    test_fail = 0;
+
+static void tick() {
+    if (!(dut->ssPadO & 1)) cs_cycles++;
+    dut->clock = 1;
+    dut->eval();
+    trace.dump(sim_time++);
+    dut->clock = 0;
+    dut->eval();
+    trace.dump(sim_time++);
+}
+
+static void do_reset() {
+    dut->reset         = 1;
+    dut->psel          = 0;
+    dut->penable       = 0;
+    dut->pwrite        = 0;
+    dut->pstrb         = 0;
+    dut->paddr         = 0;
+    dut->pwdata        = 0;
+    dut->slave_psel    = 0;
+    dut->slave_penable = 0;
+    dut->slave_pwrite  = 0;
+    dut->slave_pstrb   = 0;
+    dut->slave_paddr   = 0;
+    dut->slave_pwdata  = 0;
+    for (int i = 0; i < 10; i++) tick();
+    dut->reset = 0;
+    tick();
+}
+
+// ─── Master APB ─────────────────────────────────────────────────────────
+static void apb_write(uint8_t addr, uint32_t data) {
+    dut->paddr   = addr;
+    dut->pwdata  = data;
+    dut->pstrb   = 0xF;
+    dut->pwrite  = 1;
+    dut->psel    = 1;
+    dut->penable = 0;
+    tick();
+    dut->penable = 1;
+    do { tick(); } while (!dut->pready);
+    dut->psel    = 0;
+    dut->penable = 0;
+    dut->pwrite  = 0;
+    tick();
+}
+
+static uint32_t apb_read(uint8_t addr) {
+    dut->paddr   = addr;
+    dut->pwrite  = 0;
+    dut->pstrb   = 0xF;
+    dut->psel    = 1;
+    dut->penable = 0;
+    tick();
+    dut->penable = 1;
+    do { tick(); } while (!dut->pready);
+    uint32_t val = dut->prdata;
+    dut->psel    = 0;
+    dut->penable = 0;
+    tick();
+    return val;
+}
+
+// ─── Slave APB ──────────────────────────────────────────────────────────
+// The slave has side-effecting registers (DATA pushes / pops a FIFO), so
+// PREADY is sampled before the clock edge that completes the access; the
+// ACCESS phase then lasts exactly one accepted edge.
+static void slv_write(uint8_t addr, uint32_t data) {
+    dut->slave_paddr   = addr;
+    dut->slave_pwdata  = data;
+    dut->slave_pstrb   = 0xF;
+    dut->slave_pwrite  = 1;
+    dut->slave_psel    = 1;
+    dut->slave_penable = 0;
+    tick();
+    dut->slave_penable = 1;
+    dut->eval();
+    while (!dut->slave_pready) tick();
+    tick();
+    dut->slave_psel    = 0;
+    dut->slave_penable = 0;
+    dut->slave_pwrite  = 0;
+}
+
+static uint32_t slv_read(uint8_t addr) {
+    dut->slave_paddr   = addr;
+    dut->slave_pwrite  = 0;
+    dut->slave_pstrb   = 0xF;
+    dut->slave_psel    = 1;
+    dut->slave_penable = 0;
+    tick();
+    dut->slave_penable = 1;
+    dut->eval();
+    while (!dut->slave_pready) tick();
+    uint32_t val = dut->slave_prdata;
+    tick();
+    dut->slave_psel    = 0;
+    dut->slave_penable = 0;
+    return val;
+}
+
+static void check(const char* name, uint32_t expected, uint32_t actual,
+                  uint32_t mask = 0xFFFFFFFF) {
+    actual   &= mask;
+    expected &= mask;
+    if (actual == expected) {
+        printf("  PASS %s: expected 0x%02X, got 0x%02X\n", name, expected, actual);
+        test_pass++;
+    } else {
+        printf("  FAIL %s: expected 0x%02X, got 0x%02X\n", name, expected, actual);
+        test_fail++;
+    }
+}
+
+// ─── Master transfer of n bytes (n <= MAX_BURST) ────────────────────────
+// The master shifts bits [8n-1:0] out MSB first, so byte k on the wire
+// lives at bit (n-1-k)*8 of the TX/RX words.
+static void master_exchange(const uint8_t* tx, uint8_t* rx, int n) {
+    uint32_t words[4] = {0, 0, 0, 0};
+    for (int k = 0; k < n; k++) {
+        int lo = (n - 1 - k) * 8;
+        words[lo / 32] |= (uint32_t)tx[k] << (lo % 32);
+    }
+    int nwords = (n * 8 + 31) / 32;
+    for (int w = 0; w < nwords; w++)
+        apb_write(ADDR_TX0 + (w << 2), words[w]);
+    apb_write(ADDR_CTRL, (uint32_t)(n * 8) | CTRL_ASS | CTRL_TX_NEG | CTRL_GO);
+    // pready blocks RX reads until the transfer is over
+    for (int w = 0; w < nwords; w++)
+        words[w] = apb_read(ADDR_TX0 + (w << 2));
+    for (int k = 0; k < n; k++) {
+        int lo = (n - 1 - k) * 8;
+        rx[k] = (uint8_t)(words[lo / 32] >> (lo % 32));
+    }
+}
+
+static void setup_master(uint32_t divider) {
+    apb_write(ADDR_DIVIDE, divider);
+    apb_write(ADDR_SS, 0x01);
+}
+
+// Slave TX preload + master transfer + slave RX drain; returns mismatches.
+static int exchange_and_check(const uint8_t* m_tx, const uint8_t* s_tx, int n,
+                              bool verbose) {
+    uint8_t m_rx[MAX_BURST];
+    int errors = 0;
+    for (int k = 0; k < n; k++) slv_write(S_DATA, s_tx[k]);
+    master_exchange(m_tx, m_rx, n);
+    for (int k = 0; k < n; k++) {
+        uint32_t s_rx = slv_read(S_DATA);
+        if (s_rx != m_tx[k]) {
+            if (verbose) printf("  FAIL slave rx[%d]: expected 0x%02X, got 0x%03X\n", k, m_tx[k], s_rx);
+            errors++;
+        }
+        if (m_rx[k] != s_tx[k]) {
+            if (verbose) printf("  FAIL master rx[%d]: expected 0x%02X, got 0x%02X\n", k, s_tx[k], m_rx[k]);
+            errors++;
+        }
+    }
+    return errors;
+}
+
+// ─── Sustained throughput ───────────────────────────────────────────────
+static void run_throughput(uint64_t bytes, uint32_t divider, uint64_t fclk_mhz) {
+    setup_master(divider);
+    uint8_t m_tx[MAX_BURST], s_tx[MAX_BURST];
+    uint32_t lcg = 0x5EED1234;
+    int errors = 0;
+    uint64_t done = 0;
+    uint64_t t0 = sim_time, cs0 = cs_cycles;
+    while (done < bytes) {
+        int n = (int)(bytes - done < MAX_BURST ? bytes - done : MAX_BURST);
+        for (int k = 0; k < n; k++) {
+            lcg = lcg * 1664525u + 1013904223u;
+            m_tx[k] = (uint8_t)(lcg >> 24);
+            s_tx[k] = (uint8_t)(lcg >> 16);
+        }
+        errors += exchange_and_check(m_tx, s_tx, n, errors < 8);
+        done += n;
+    }
+    uint64_t cycles = (sim_time - t0) / 2;
+    uint64_t wire   = cs_cycles - cs0;
+    double bpc      = cycles ? (double)done / cycles : 0.0;
+    double wire_bpc = wire ? (double)done / wire : 0.0;
+    printf("  divider=%u (SCK = clk/%u), %llu bytes each way\n", divider,
+           2 * (divider + 1), (unsigned long long)done);
+    printf("  on the wire : %8llu cycles, %.4f bytes/cycle (%.2f MB/s at %llu MHz)\n",
+           (unsigned long long)wire, wire_bpc, wire_bpc * fclk_mhz,
+           (unsigned long long)fclk_mhz);
+    printf("  sustained   : %8llu cycles, %.4f bytes/cycle (%.2f MB/s at %llu MHz)\n",
+           (unsigned long long)cycles, bpc, bpc * fclk_mhz,
+           (unsigned long long)fclk_mhz);
+    uint32_t st = slv_read(S_STATUS);
+    if (st & (S_ST_RX_OVF | S_ST_TX_UDR)) {
+        printf("  FAIL slave STATUS error flags: 0x%08X\n", st);
+        errors++;
+    }
+    if (errors) test_fail++; else test_pass++;
+    printf("  throughput: %d mismatches\n", errors);
+}
+
+int main(int argc, char** argv) {
+    VerilatedContext* contextp = new VerilatedContext;
+    contextp->commandArgs(argc, argv);
+    contextp->traceEverOn(true);
+
+    dut = new VSPISlaveTop{contextp};
+    trace.open(dut, "build/spi_slave.vcd");
+    SimPerf perf;
+
+    printf("====================================================\n");
+    printf("  SPI Master + SPISlave (Chisel wiring)\n");
+    printf("  Mode: CPOL=0, CPHA=0 (tx_neg=1, rx_neg=0)\n");
+    printf("====================================================\n\n");
+
+    do_reset();
+    printf("[time %5lu] reset done\n\n", (unsigned long)sim_time);
+
+    // ─── Test 1 ─────────────────────────────────────────────
+    {
+        printf("-- Test 1: slave register defaults --\n");
+        check("STATUS", S_ST_TX_EMPTY | S_ST_RX_EMPTY, slv_read(S_STATUS));
+        check("CTRL", 0, slv_read(S_CTRL));
+        check("THRESH", 0x0001, slv_read(S_THRESH));
+        check("DATA (RX empty)", S_DATA_EMPTY, slv_read(S_DATA));
+        printf("\n");
+    }
+
+    // ─── Test 2 ─────────────────────────────────────────────
+    {
+        printf("-- Test 2: single byte, divider=4 --\n");
+        setup_master(4);
+        uint8_t m_tx = 0xA5, s_tx = 0x3C, m_rx = 0;
+        slv_write(S_DATA, s_tx);
+        master_exchange(&m_tx, &m_rx, 1);
+        check("master rx", s_tx, m_rx, 0xFF);
+        check("slave rx", m_tx, slv_read(S_DATA));
+        printf("\n");
+    }
+
+    // ─── Test 3 ─────────────────────────────────────────────
+    {
+        printf("-- Test 3: %d-byte burst, divider=%d --\n", MAX_BURST, MIN_DIV);
+        setup_master(MIN_DIV);
+        uint8_t m_tx[MAX_BURST], s_tx[MAX_BURST];
+        for (int k = 0; k < MAX_BURST; k++) {
+            m_tx[k] = (uint8_t)(0x10 + k * 0x11);
+            s_tx[k] = (uint8_t)(0xF0 - k * 0x0D);
+        }
+        int errors = exchange_and_check(m_tx, s_tx, MAX_BURST, true);
+        check("burst mismatches", 0, errors);
+        check("STATUS after burst", S_ST_TX_EMPTY | S_ST_RX_EMPTY, slv_read(S_STATUS));
+        printf("\n");
+    }
+
+    // ─── Test 4 ─────────────────────────────────────────────
+    {
+        printf("-- Test 4: TX underrun --\n");
+        uint8_t m_tx = 0x5A, m_rx = 0xFF;
+        master_exchange(&m_tx, &m_rx, 1);
+        check("master rx (underrun sends 0x00)", 0x00, m_rx, 0xFF);
+        check("STATUS.TX_UDR", S_ST_TX_UDR, slv_read(S_STATUS), S_ST_TX_UDR);
+        check("slave rx", m_tx, slv_read(S_DATA));
+        slv_write(S_STATUS, S_ST_TX_UDR);
+        check("STATUS.TX_UDR cleared", 0, slv_read(S_STATUS), S_ST_TX_UDR);
+        printf("\n");
+    }
+
+    // ─── Test 5 ─────────────────────────────────────────────
+    {
+        printf("-- Test 5: RX threshold interrupt --\n");
+        slv_write(S_THRESH, 4);
+        slv_write(S_CTRL, S_CTRL_RX_IE);
+        uint8_t m_tx[4] = {1, 2, 3, 4}, m_rx[4];
+        for (int k = 0; k < 4; k++) slv_write(S_DATA, 0);
+        master_exchange(m_tx, m_rx, 3);
+        check("intO below threshold", 0, dut->slaveIntO);
+        master_exchange(m_tx + 3, m_rx + 3, 1);
+        check("intO at threshold", 1, dut->slaveIntO);
+        for (int k = 0; k < 4; k++) slv_read(S_DATA);
+        check("intO after drain", 0, dut->slaveIntO);
+        slv_write(S_CTRL, 0);
+        slv_write(S_THRESH, 1);
+        printf("\n");
+    }
+
+    // ─── Test 6 ─────────────────────────────────────────────
+    {
+        uint64_t bytes    = plusarg_u64(contextp, "bytes", 4096);
+        uint32_t divider  = (uint32_t)plusarg_u64(contextp, "div", MIN_DIV);
+        uint64_t fclk_mhz = plusarg_u64(contextp, "fclk_mhz", 100);
+        printf("-- Test 6: sustained throughput --\n");
+        run_throughput(bytes, divider, fclk_mhz);
+        printf("\n");
+    }
+
+    for (int i = 0; i < 20; i++) tick();
+
+    printf("====================================================\n");
+    printf("  Results: %d passed, %d failed\n", test_pass, test_fail);
+    printf("  Waveform: %s\n", trace.path());
+    perf.report(sim_time / 2);
+    sim_coverage(contextp, "build/spi_slave_coverage.dat");
+    printf("====================================================\n");
+
+    trace.close();
+    dut->final();
+    delete dut;
+    delete contextp;
+    return test_fail > 0 ? 1 : 0;
+}
@@ -29,8 +29,8 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "Vspi_top.h"
+#include "sim_common.h"
 #include "verilated.h"
-#include "verilated_vcd_c.h"
 #include <cstdio>
 #include <cstdlib>
 #include <memory>
@@ -59,7 +59,7 @@ static constexpr uint32_t CTRL_ASS    = 1 << 13;
 
 // ─── 全局变量 ───────────────────────────────────────────────
 static Vspi_top*      dut = nullptr;
-static VerilatedVcdC* tfp = nullptr;
+static SimTrace<Vspi_top> trace;
 static uint64_t       sim_time = 0;
 static int            test_pass = 0;
 static int            test_fail = 0;
@@ -72,13 +72,13 @@ static void tick() {
     dut->pclk = 0;
     dut->miso_pad_i = dut->mosi_pad_o;  // 回环连接
     dut->eval();
-    if (tfp) tfp->dump(sim_time++);
+    trace.dump(sim_time++);
 
     // 上升沿
     dut->pclk = 1;
     dut->miso_pad_i = dut->mosi_pad_o;  // 回环连接
     dut->eval();
-    if (tfp) tfp->dump(sim_time++);
+    trace.dump(sim_time++);
 }
 
 // ─── 复位 ───────────────────────────────────────────────────
@@ -204,9 +204,8 @@ int main(int argc, char** argv) {
     contextp->traceEverOn(true);
 
     dut = new Vspi_top{contextp};
-    tfp = new VerilatedVcdC;
-    dut->trace(tfp, 99);
-    tfp->open("build/opencores_spi.vcd");
+    trace.open(dut, "build/opencores_spi.vcd");
+    SimPerf perf;
 
     printf("════════════════════════════════════════════════════\n");
     printf("  OpenCores SPI Master (APB) - Verilator 仿真测试\n");
@@ -275,12 +274,14 @@ int main(int argc, char** argv) {
     // ─── 结果汇总 ─────────────────────────────────────
     printf("════════════════════════════════════════════════════\n");
     printf("  测试结果: %d 通过, %d 失败\n", test_pass, test_fail);
-    printf("  波形文件: build/opencores_spi.vcd\n");
+    printf("  波形文件: %s\n", trace.path());
+    perf.report(sim_time / 2);
+    sim_coverage(contextp, "build/opencores_spi_coverage.dat");
     printf("════════════════════════════════════════════════════\n");
 
     // 清理
-    tfp->close();
-    delete tfp;
+    trace.close();
+    dut->final();
     delete dut;
     delete contextp;
 
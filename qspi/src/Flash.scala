@@ -0,0 +1,371 @@
+
+package org.chipsalliance.qspi
+
+import chisel3._
+import chisel3.util._
+
+object FlashParameter {
+  implicit def rwP: upickle.default.ReadWriter[FlashParameter] =
+    upickle.default.macroRW
+}
+
+/** Parameter of [[flash_sync]], a quad NOR flash in the style of the
+  * Macronix MX25L series: SPI mode after power-up, `0x35` enters QPI,
+  * `0xEB` quad I/O read with 6 dummy cycles (what [[QSPI]] issues for
+  * memory reads).
+  *
+  * The array lives in the harness behind DPI-C ([[flash_cmd]]), which maps
+  * an image file, so images load without copying and survive the run.
+  *
+  * @param sizeBytes
+  *   Array size (power of two, 64 KiB to 16 MiB); addresses wrap.
+  * @param manufacturer
+  *   First JEDEC ID byte; the third is log2(`sizeBytes`).
+  * @param memoryType
+  *   Second JEDEC ID byte.
+  * @param programCycles
+  *   Busy time of a page program (system clock cycles after CE# rises).
+  * @param sectorEraseCycles
+  *   Busy time of a 4 KiB sector erase (`0x20`).
+  * @param blockEraseCycles
+  *   Busy time of a 64 KiB block erase (`0xD8`).
+  * @param chipEraseCycles
+  *   Busy time of a chip erase (`0x60` / `0xC7`).
+  */
+case class FlashParameter(
+  sizeBytes:         Int = 1 << 24,
+  manufacturer:      Int = 0xC2,
+  memoryType:        Int = 0x20,
+  programCycles:     Int = 1000,
+  sectorEraseCycles: Int = 8000,
+  blockEraseCycles:  Int = 32000,
+  chipEraseCycles:   Int = 64000
+) {
+  require(isPow2(sizeBytes) && sizeBytes >= (1 << 16) && sizeBytes <= (1 << 24),
+    "sizeBytes must be a power of two in 64 KiB..16 MiB")
+  require(Seq(programCycles, sectorEraseCycles, blockEraseCycles, chipEraseCycles).forall(_ > 0),
+    "busy times must be positive")
+
+  val addrBits: Int = log2Ceil(sizeBytes)
+
+  def jedecId: Seq[Int] = Seq(manufacturer, memoryType, addrBits)
+
+  /** SFDP (JESD216) space: header, one parameter header, and the basic
+    * flash parameter table at 0x30. Unlisted addresses read 0xFF.
+    */
+  def sfdp: Seq[Int] = {
+    val fastRead144 = 4 | 2 << 5 | 0xEB << 8 // 4 wait + 2 mode clocks = 6 dummy
+    val bfpt = Seq[Long](
+      // 4 KiB erase 0x20, write granularity >= 64 B, 3-byte address, 1-4-4 read
+      1 | 1 << 2 | 7 << 5 | 0x20 << 8 | 1 << 21 | 0x1FFL << 23,
+      sizeBytes.toLong * 8 - 1,       // density in bits - 1
+      fastRead144,                    // 1-4-4 read, no 1-1-4
+      0,                              // no 1-1-2 / 1-2-2
+      0xFFFFFFFEL,                    // 4-4-4 read, no 2-2-2
+      0x0000FFFFL,
+      (fastRead144.toLong << 16) | 0xFFFF, // 4-4-4 read
+      12 | 0x20 << 8 | 16 << 16 | 0xD8L << 24, // erase types: 4 KiB 0x20, 64 KiB 0xD8
+      0
+    )
+    val header = Seq(0x53, 0x46, 0x44, 0x50, 0x00, 0x01, 0x00, 0xFF) ++ // "SFDP", v1.0, 1 header
+      Seq(0x00, 0x00, 0x01, bfpt.size, 0x30, 0x00, 0x00, 0xFF)          // BFPT v1.0 at 0x30
+    val table = bfpt.flatMap(dw => (0 until 4).map(i => ((dw >> (8 * i)) & 0xFF).toInt))
+    header ++ Seq.fill(0x30 - header.size)(0xFF) ++ table
+  }
+}
+
+/** `op` codes of [[flash_cmd]]. */
+object flash_cmd {
+  val Read    = 0
+  val Program = 1
+  val Erase   = 2
+}
+
+/** DPI-C array of [[flash_sync]] (opencores/sim/flash_cmd.sv). A read
+  * shows up on `rdata` in the next cycle; a program ANDs `wdata` into the
+  * byte; an erase sets `len` bytes from `addr` to 0xFF.
+  */
+class flash_cmd extends BlackBox {
+  val io = IO(new Bundle {
+    val clock = Input(Clock())
+    val valid = Input(Bool())
+    val op    = Input(UInt(2.W)) // flash_cmd.Read / Program / Erase
+    val addr  = Input(UInt(32.W))
+    val wdata = Input(UInt(8.W))
+    val len   = Input(UInt(32.W)) // erase: bytes
+    val rdata = Output(UInt(8.W))
+  })
+}
+
+/** Flash command decoder and data path, one bit (SPI) or nibble (QPI,
+  * quad phases of `0xEB` / `0x38`) per `step`. The module reset is the
+  * deselect; mode, write enable, the busy timer and the operation that
+  * starts when CE# rises are on `systemReset`.
+  *
+  * | Cmd  | SPI   | QPI   | Operation                                    |
+  * |------|-------|-------|----------------------------------------------|
+  * | 03   | 1-1-1 |       | read                                         |
+  * | EB   | 1-4-4 | 4-4-4 | quad I/O read, 6 dummy cycles                |
+  * | 02   | 1-1-1 | 4-4-4 | page program                                 |
+  * | 38   | 1-4-4 | 4-4-4 | quad page program                            |
+  * | 20   | x     | x     | 4 KiB sector erase                           |
+  * | D8   | x     | x     | 64 KiB block erase                           |
+  * | 60/C7| x     | x     | chip erase                                   |
+  * | 06/04| x     | x     | write enable / disable                       |
+  * | 05   | x     | x     | read status (WIP [0], WEL [1], QE [6])       |
+  * | 9F   | x     |       | JEDEC ID                                     |
+  * | AF   |       | x     | JEDEC ID (QPI)                               |
+  * | 5A   | x     |       | SFDP, 8 dummy cycles                         |
+  * | 35   | x     |       | enter QPI                                    |
+  * | F5   |       | x     | exit QPI                                     |
+  * | 66/99| x     | x     | reset enable / reset                         |
+  *
+  * Program and erase need WEL and start the busy time at CE# rise; a
+  * program clears bits (AND) byte by byte and wraps within its 256-byte
+  * page. While busy only `0x05` is accepted; other commands are ignored
+  * until CE# rises.
+  */
+class FlashCore(parameter: FlashParameter) extends Module {
+  val io = IO(new Bundle {
+    val step        = Input(Bool())
+    val mosi        = Input(UInt(4.W))
+    val miso        = Output(UInt(4.W))
+    val misoEn      = Output(UInt(4.W)) // per DIO lane
+    val ceN         = Input(Bool())
+    val systemReset = Input(AsyncReset())
+    val status      = Output(UInt(8.W))
+  })
+  private val P = parameter
+
+  object Kind extends ChiselEnum {
+    val none, read, program, erase4k, erase64k, eraseChip = Value
+  }
+  object Src extends ChiselEnum {
+    val array, status, id, sfdp = Value
+  }
+  object State extends ChiselEnum {
+    val cmd, addr, dummy, dataIn, dataOut, ignore = Value
+  }
+
+  // ─── Device state (survives CE# high) ────────────────────
+  val qpiMode  = withClockAndReset(this.clock, io.systemReset) { RegInit(false.B) }
+  val rstEn    = withClockAndReset(this.clock, io.systemReset) { RegInit(false.B) }
+  val wel      = withClockAndReset(this.clock, io.systemReset) { RegInit(false.B) }
+  val busyCnt  = withClockAndReset(this.clock, io.systemReset) { RegInit(0.U(32.W)) }
+  val pend     = withClockAndReset(this.clock, io.systemReset) { RegInit(Kind.none) } // starts at CE# rise
+  val pendAddr = withClockAndReset(this.clock, io.systemReset) { RegInit(0.U(24.W)) }
+  val busy = busyCnt =/= 0.U
+  io.status := Cat(0.U(1.W), 1.U(1.W), 0.U(4.W), wel, busy)
+
+  // ─── Transaction state ───────────────────────────────────
+  val state  = RegInit(State.cmd)
+  val cnt    = RegInit(0.U(5.W)) // bits of the phase so far, or dummy cycles
+  val cmd    = RegInit(0.U(8.W))
+  val kind   = RegInit(Kind.none)
+  val src    = RegInit(Src.array)
+  val wide   = RegInit(false.B) // address and data four bits per step
+  val dummyN = RegInit(0.U(4.W))
+  val addr   = RegInit(0.U(24.W))
+  val wbyte  = RegInit(0.U(8.W))
+
+  val store = Module(new flash_cmd)
+  store.io.clock := clock
+  store.io.valid := false.B
+  store.io.op    := flash_cmd.Read.U
+  store.io.addr  := addr(P.addrBits - 1, 0)
+  store.io.wdata := 0.U
+  store.io.len   := 0.U
+
+  private val idRom   = VecInit(P.jedecId.map(_.U(8.W)))
+  private val sfdpRom = VecInit(P.sfdp.map(_.U(8.W)))
+  private val obyte = MuxLookup(src, store.io.rdata)(
+    Seq(
+      Src.status -> io.status,
+      Src.id     -> idRom((addr % 3.U)(1, 0)),
+      Src.sfdp   -> Mux(addr < sfdpRom.length.U, sfdpRom(addr(log2Ceil(sfdpRom.length) - 1, 0)), "hff".U)
+    )
+  )
+
+  // Outputs depend on state only; the wrapper registers them at SCK fall
+  io.misoEn := Mux(state === State.dataOut, Mux(wide, "b1111".U, "b0010".U), 0.U)
+  io.miso   := Mux(wide, Mux(cnt === 0.U, obyte(7, 4), obyte(3, 0)), (obyte >> (7.U - cnt(2, 0)))(0) << 1)
+
+  // Bits per step in the current phase
+  val bitsW = Mux(Mux(state === State.cmd, qpiMode, wide), 4.U, 1.U)
+
+  private def startRead(a: UInt): Unit = {
+    store.io.valid := src === Src.array
+    store.io.op    := flash_cmd.Read.U
+    store.io.addr  := a(P.addrBits - 1, 0)
+  }
+
+  // Phase after the address (or the command if it has none)
+  private def afterAddr(a: UInt): Unit = {
+    when(kind === Kind.read) {
+      when(dummyN =/= 0.U) {
+        state := State.dummy
+      }.otherwise {
+        state := State.dataOut
+        startRead(a)
+      }
+    }.elsewhen(kind === Kind.program) {
+      state := State.dataIn
+    }.otherwise { // erase: starts at CE# rise
+      pend     := Mux(wel, kind, Kind.none)
+      pendAddr := a
+      state    := State.ignore
+    }
+  }
+
+  // Commands: (code, SPI, QPI, quad address / data in SPI mode, kind, source, dummy)
+  private case class Op(code: Int, spi: Boolean, qpi: Boolean, quad: Boolean, kind: Kind.Type, src: Src.Type, dummy: Int)
+  private val ops = Seq(
+    Op(0x03, true, false, false, Kind.read, Src.array, 0),
+    Op(0xEB, true, true, true, Kind.read, Src.array, 6),
+    Op(0x02, true, true, false, Kind.program, Src.array, 0),
+    Op(0x38, true, true, true, Kind.program, Src.array, 0),
+    Op(0x20, true, true, false, Kind.erase4k, Src.array, 0),
+    Op(0xD8, true, true, false, Kind.erase64k, Src.array, 0),
+    Op(0x05, true, true, false, Kind.read, Src.status, 0),
+    Op(0x9F, true, false, false, Kind.read, Src.id, 0),
+    Op(0xAF, false, true, false, Kind.read, Src.id, 0),
+    Op(0x5A, true, false, false, Kind.read, Src.sfdp, 8)
+  )
+  private val noAddr = Seq(0x05, 0x9F, 0xAF)
+
+  when(io.step) {
+    switch(state) {
+      is(State.cmd) {
+        val nextCmd = Mux(qpiMode, Cat(cmd(3, 0), io.mosi), Cat(cmd(6, 0), io.mosi(0)))
+        cmd := nextCmd
+        cnt := cnt + bitsW
+        when(cnt + bitsW === 8.U) {
+          cnt   := 0.U
+          addr  := 0.U
+          state := State.ignore // unknown, or a single-byte command
+          rstEn := nextCmd === "h66".U
+          // Busy: only status reads
+          val accept = !busy || nextCmd === "h05".U
+          for (op <- ops) {
+            val mode = if (op.spi && op.qpi) true.B else if (op.spi) !qpiMode else qpiMode
+            when(accept && nextCmd === op.code.U && mode) {
+              kind   := op.kind
+              src    := op.src
+              wide   := qpiMode || op.quad.B
+              dummyN := op.dummy.U
+              state  := (if (noAddr.contains(op.code)) State.dataOut else State.addr)
+            }
+          }
+          when(accept) {
+            when(nextCmd === "h06".U) { wel := true.B }
+            when(nextCmd === "h04".U) { wel := false.B }
+            when(nextCmd === "h35".U && !qpiMode) { qpiMode := true.B }
+            when(nextCmd === "hf5".U && qpiMode) { qpiMode := false.B }
+            when(nextCmd === "h99".U && rstEn) {
+              qpiMode := false.B
+              wel     := false.B
+            }
+            when((nextCmd === "h60".U || nextCmd === "hc7".U) && wel) { pend := Kind.eraseChip }
+          }
+        }
+      }
+      is(State.addr) {
+        val nextAddr = Mux(wide, Cat(addr(19, 0), io.mosi), Cat(addr(22, 0), io.mosi(0)))
+        addr := nextAddr
+        cnt  := cnt + bitsW
+        when(cnt + bitsW === 24.U) {
+          cnt := 0.U
+          afterAddr(nextAddr)
+        }
+      }
+      is(State.dummy) {
+        cnt := cnt + 1.U
+        when(cnt === dummyN - 1.U) {
+          cnt   := 0.U
+          state := State.dataOut
+          startRead(addr)
+        }
+      }
+      is(State.dataOut) {
+        cnt := cnt + bitsW
+        when(cnt + bitsW === 8.U) {
+          cnt := 0.U
+          val nextAddr = addr + 1.U
+          addr := nextAddr
+          startRead(nextAddr)
+        }
+      }
+      is(State.dataIn) {
+        val nextByte = Mux(wide, Cat(wbyte(3, 0), io.mosi), Cat(wbyte(6, 0), io.mosi(0)))
+        wbyte := nextByte
+        cnt   := cnt + bitsW
+        when(cnt + bitsW === 8.U) {
+          cnt := 0.U
+          when(wel) {
+            store.io.valid := true.B
+            store.io.op    := flash_cmd.Program.U
+            store.io.wdata := nextByte
+            pend           := Kind.program
+          }
+          addr := Cat(addr(23, 8), addr(7, 0) + 1.U) // wrap in the page
+        }
+      }
+      is(State.ignore) {}
+    }
+  }
+
+  // ─── Program / erase at CE# rise ─────────────────────────
+  when(busy) { busyCnt := busyCnt - 1.U }
+  when(io.ceN && pend =/= Kind.none) {
+    pend    := Kind.none
+    wel     := false.B
+    busyCnt := MuxLookup(pend, 0.U)(
+      Seq(
+        Kind.program   -> P.programCycles.U,
+        Kind.erase4k   -> P.sectorEraseCycles.U,
+        Kind.erase64k  -> P.blockEraseCycles.U,
+        Kind.eraseChip -> P.chipEraseCycles.U
+      )
+    )
+    when(pend =/= Kind.program) {
+      store.io.valid := true.B
+      store.io.op    := flash_cmd.Erase.U
+      store.io.addr  := MuxLookup(pend, 0.U)(
+        Seq(
+          Kind.erase4k  -> Cat(pendAddr(23, 12), 0.U(12.W)),
+          Kind.erase64k -> Cat(pendAddr(23, 16), 0.U(16.W))
+        )
+      )(P.addrBits - 1, 0)
+      store.io.len := MuxLookup(pend, P.sizeBytes.U)(
+        Seq(Kind.erase4k -> (1 << 12).U, Kind.erase64k -> (1 << 16).U)
+      )
+    }
+  }
+}
+
+/** Quad NOR flash on split DIO pins, oversampled in the system clock
+  * domain like [[psram_sync]]: the busy times count system clock cycles,
+  * so there is no SCK-clocked variant. `status` is the status register as
+  * `0x05` would return it.
+  */
+class flash_sync(parameter: FlashParameter = FlashParameter()) extends Module {
+  val io = IO(Flipped(new QSPIPinIO))
+  val status = IO(Output(UInt(8.W)))
+
+  val sckPrev  = RegNext(io.sck, false.B)
+  val rise     = io.sck && !sckPrev
+  val fall     = !io.sck && sckPrev
+  val deselect = reset.asBool || io.ce_n
+
+  val module = withReset(deselect) { Module(new FlashCore(parameter)) }
+  val misoOut = withReset(deselect) { RegEnable(module.io.miso, 0.U(4.W), fall) }
+  val misoEnOut = withReset(deselect) { RegEnable(module.io.misoEn, 0.U(4.W), fall) }
+  module.io.step := rise
+  module.io.mosi := io.dout
+  module.io.ceN := io.ce_n
+  module.io.systemReset := reset.asAsyncReset
+  status := module.io.status
+
+  // Bus as seen by the master: the device's lanes while it drives, else the master
+  io.din := (misoOut & misoEnOut) | (io.dout & ~misoEnOut)
+}
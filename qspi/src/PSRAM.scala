@@ -3,6 +3,49 @@ package org.chipsalliance.qspi
 
 import chisel3._
 import chisel3.util._
+import chisel3.util.experimental.loadMemoryFromFileInline
+
+object PSRAMParameter {
+  implicit def rwP: upickle.default.ReadWriter[PSRAMParameter] =
+    upickle.default.macroRW
+}
+
+/** Parameter of [[psram]].
+  *
+  * @param backend
+  *   Byte store behind the command decoder: `"dpi"` calls the DPI-C
+  *   `psram_read` / `psram_write` of the harness through [[psram_cmd]],
+  *   `"sram"` uses an on-chip [[SyncReadMem]] ([[psram_sram]]) and needs
+  *   no DPI, so it also maps to FPGA block RAM.
+  * @param sizeBytes
+  *   Size of the `"sram"` store (power of two, at least 1 KiB); addresses
+  *   wrap at this size.
+  * @param initFile
+  *   Optional `$readmemh` image for the `"sram"` store, one byte per line.
+  * @param oversample
+  *   Use [[psram_sync]] (SCK / CE_n edge-detected in the system clock,
+  *   split DIO pins) instead of the SCK-clocked [[psram]].
+  */
+case class PSRAMParameter(
+  backend:    String  = "dpi",
+  sizeBytes:  Int     = 1 << 20,
+  initFile:   String  = "",
+  oversample: Boolean = false
+) {
+  require(Seq("dpi", "sram").contains(backend), "backend must be dpi or sram")
+  require(isPow2(sizeBytes) && sizeBytes >= 1024, "sizeBytes must be a power of two >= 1024")
+
+  val addrBits: Int = log2Ceil(sizeBytes)
+}
+
+/** Byte access port between the PSRAM command decoder and its store. */
+class PSRAMCmdIO extends Bundle {
+  val valid = Input(Bool())
+  val cmd   = Input(UInt(8.W))
+  val addr  = Input(UInt(32.W))
+  val wdata = Input(UInt(8.W))
+  val rdata = Output(UInt(8.W))
+}
 
 class psram_cmd extends BlackBox {
   val io = IO(new Bundle {
@@ -15,59 +58,114 @@ class psram_cmd extends BlackBox {
   })
 }
 
-// eb: write (1, 4, 4)
-// 38: read (1, 4, 4)
-class psram extends RawModule {
-  val io = IO(Flipped(new QSPIIO))
-  val systemReset = IO(Input(AsyncReset()))
-  val ce_n = io.ce_n.asAsyncReset
-  val sckRise = io.sck.asClock
-  val sckFall = (!io.sck).asClock
-  val module = withClockAndReset(sckRise, ce_n) { Module(new Impl) }
-  val misoOut = withClockAndReset(sckFall, ce_n) { RegNext(module.io.miso) }
-  val misoEnOut = withClockAndReset(sckFall, ce_n) { RegNext(module.io.misoEn, false.B) }
-  module.io.mosi := TriStateInBuf(io.dio, misoOut, misoEnOut)
-  module.io.systemReset := systemReset
-  class Impl extends Module with RequireAsyncReset {
-    val io = IO(new Bundle{
-      val miso = Output(UInt(4.W))
-      val mosi = Input(UInt(4.W))
-      val misoEn = Output(Bool())
-      val systemReset = Input(AsyncReset())
-    })
-
-    // mode
-    val qpiMode = withClockAndReset( this.clock, io.systemReset ) { RegInit(false.B) }
-
-    object State extends ChiselEnum {
-      val cmd, addr, wait_read, data = Value
-    }
-    val counter = RegInit(0.U(5.W))
-    val state = RegInit(State.cmd)
-    val cmd = RegInit(0.U(8.W))
-    val addr = RegInit(0.U(32.W));
-    val base = RegInit(0.U(24.W)); val offset = RegInit(0.U(10.W)) // wrapping
-    val wdataH = RegInit(0.U(4.W))
-    val u0_psram_cmd = Module(new psram_cmd)
-    u0_psram_cmd.io.clock := this.clock
-    u0_psram_cmd.io.valid := false.B
-    u0_psram_cmd.io.cmd := cmd
-    u0_psram_cmd.io.addr := Cat( base, offset )
-    u0_psram_cmd.io.wdata := Cat( wdataH, io.mosi )
-    val rdata = u0_psram_cmd.io.rdata
-
-    io.miso := 0.U
-    io.misoEn := false.B // default
+/** On-chip replacement for [[psram_cmd]].
+  *
+  * Same cycle behaviour: a read (`eb`) issued with `valid` shows up on
+  * `rdata` in the next cycle and stays there until the next read; a write
+  * (`38`) updates the store at the edge.
+  */
+class psram_sram(parameter: PSRAMParameter) extends Module {
+  val io = IO(new PSRAMCmdIO)
+
+  val mem = SyncReadMem(parameter.sizeBytes, UInt(8.W))
+  if (parameter.initFile.nonEmpty) loadMemoryFromFileInline(mem, parameter.initFile)
+
+  val idx     = io.addr(parameter.addrBits - 1, 0)
+  val isRead  = io.valid && io.cmd === "heb".U
+  val isWrite = io.valid && io.cmd === "h38".U
+
+  val raw = mem.read(idx, isRead)
+  when(isWrite) { mem.write(idx, io.wdata) }
+
+  // SyncReadMem data is only defined in the cycle after the read
+  val readD = RegNext(isRead, false.B)
+  val held  = RegEnable(raw, 0.U(8.W), readD)
+  io.rdata := Mux(readD, raw, held)
+}
+
+/** PSRAM command decoder and data path.
+  *
+  * Advances one nibble per cycle with `step` high. The wrappers decide
+  * what a cycle is: [[psram]] clocks it with SCK and ties `step` high,
+  * [[psram_sync]] clocks it with the system clock and raises `step` on
+  * detected SCK rising edges. The module reset deselects the device
+  * (CE_n high); the QPI mode bit only clears on `systemReset` or a
+  * software reset (`0x66` reset enable, then `0x99` reset, in either
+  * mode), which also returns the device to SPI mode.
+  *
+  * Nothing advances without an SCK edge and the read data is held until
+  * the next one, so the master may pause SCK low with CE_n asserted for
+  * any time (QSPI bursts do); reads and writes continue linearly and
+  * wrap within a 1 KiB page.
+  */
+class PSRAMCore(parameter: PSRAMParameter) extends Module {
+  val io = IO(new Bundle{
+    val step = Input(Bool())
+    val miso = Output(UInt(4.W))
+    val mosi = Input(UInt(4.W))
+    val misoEn = Output(Bool())
+    val systemReset = Input(AsyncReset())
+  })
 
+  // mode
+  val qpiMode = withClockAndReset( this.clock, io.systemReset ) { RegInit(false.B) }
+  // reset enable (0x66) arms the next command, which resets only if it is 0x99
+  val rstEn = withClockAndReset( this.clock, io.systemReset ) { RegInit(false.B) }
+
+  object State extends ChiselEnum {
+    val cmd, addr, wait_read, data = Value
+  }
+  val counter = RegInit(0.U(5.W))
+  val state = RegInit(State.cmd)
+  val cmd = RegInit(0.U(8.W))
+  val addr = RegInit(0.U(32.W));
+  val base = RegInit(0.U(24.W)); val offset = RegInit(0.U(10.W)) // wrapping
+  val wdataH = RegInit(0.U(4.W))
+  val cmdPort = Wire(new PSRAMCmdIO)
+  parameter.backend match {
+    case "dpi" =>
+      val store = Module(new psram_cmd)
+      store.io.clock := this.clock
+      store.io.valid := cmdPort.valid
+      store.io.cmd   := cmdPort.cmd
+      store.io.addr  := cmdPort.addr
+      store.io.wdata := cmdPort.wdata
+      cmdPort.rdata := store.io.rdata
+    case "sram" =>
+      val store = Module(new psram_sram(parameter))
+      store.io.valid := cmdPort.valid
+      store.io.cmd   := cmdPort.cmd
+      store.io.addr  := cmdPort.addr
+      store.io.wdata := cmdPort.wdata
+      cmdPort.rdata := store.io.rdata
+  }
+  cmdPort.valid := false.B
+  cmdPort.cmd := cmd
+  cmdPort.addr := Cat( base, offset )
+  cmdPort.wdata := Cat( wdataH, io.mosi )
+  val rdata = cmdPort.rdata
+
+  // Outputs depend on state only; the wrapper registers them at SCK fall
+  io.misoEn := state === State.data && cmd === "heb".U
+  io.miso := Mux( counter === 0.U, rdata(7, 4), rdata(3, 0) )
+
+  when( io.step ) {
     switch(state) {
       is(State.cmd) {
         counter := counter + 1.U
         when( qpiMode ) { // qpi mode
           val next_cmd = Cat( cmd(3,0), io.mosi )
           cmd := next_cmd
-          when(counter === 1.U) { // only allow: qspi -> qpi; not allow: qpi -> qspi
+          when(counter === 1.U) { // qpi -> qspi only through a software reset
             counter := 0.U
             state := State.addr
+            rstEn := next_cmd === "h66".U
+            when(next_cmd === "h66".U || next_cmd === "h99".U) {
+              state := State.cmd
+            }
+            when(next_cmd === "h99".U && rstEn) {
+              qpiMode := false.B
+            }
           }
         } .otherwise { // qspi mode
           val next_cmd = Cat( cmd(6, 0), io.mosi(0) )
@@ -75,10 +173,14 @@ class psram extends RawModule {
           when(counter === 7.U) {
             counter := 0.U
             state := State.addr // default
+            rstEn := next_cmd === "h66".U
             when(next_cmd === "h35".U) {
               qpiMode := true.B
               state := State.cmd // TODO: 一般设置完成以后, 总线事务就结束了
             }
+            when(next_cmd === "h66".U || next_cmd === "h99".U) {
+              state := State.cmd
+            }
           }
         }
       }
@@ -100,23 +202,20 @@ class psram extends RawModule {
         counter := counter + 1.U
         when( counter === 5.U ) {
           counter := 0.U
-          u0_psram_cmd.io.valid := true.B // pulse
+          cmdPort.valid := true.B // pulse
           state := State.data
         }
       }
       is(State.data) {
         assert( cmd === "heb".U || cmd === "h38".U, "impossible" )
         when( cmd === "heb".U ) { // read
-          io.misoEn := true.B
           when( counter === 0.U ) {
             counter := 1.U
-            io.miso := rdata(7, 4)
           } .otherwise {  // counter === 1
             counter := 0.U
-            io.miso := rdata(3, 0)
-            u0_psram_cmd.io.valid := true.B
+            cmdPort.valid := true.B
             val next_offset = offset + 1.U
-            u0_psram_cmd.io.addr := Cat( base, next_offset )
+            cmdPort.addr := Cat( base, next_offset )
             offset := next_offset
           }
         } .elsewhen( cmd === "h38".U ) { // write
@@ -126,10 +225,54 @@ class psram extends RawModule {
           } .otherwise {  // counter === 1
             counter := 0.U
             offset := offset + 1.U
-            u0_psram_cmd.io.valid := true.B
+            cmdPort.valid := true.B
           }
         }
       }
     }
   }
 }
+
+// eb: write (1, 4, 4)
+// 38: read (1, 4, 4)
+class psram(parameter: PSRAMParameter = PSRAMParameter()) extends RawModule {
+  val io = IO(Flipped(new QSPIIO))
+  val systemReset = IO(Input(AsyncReset()))
+  val ce_n = io.ce_n.asAsyncReset
+  val sckRise = io.sck.asClock
+  val sckFall = (!io.sck).asClock
+  val module = withClockAndReset(sckRise, ce_n) { Module(new PSRAMCore(parameter)) }
+  val misoOut = withClockAndReset(sckFall, ce_n) { RegNext(module.io.miso) }
+  val misoEnOut = withClockAndReset(sckFall, ce_n) { RegNext(module.io.misoEn, false.B) }
+  module.io.step := true.B
+  module.io.mosi := TriStateInBuf(io.dio, misoOut, misoEnOut)
+  module.io.systemReset := systemReset
+}
+
+/** [[psram]] oversampled in the system clock domain.
+  *
+  * SCK and CE_n come from a master clocked by the same system clock, so
+  * they are sampled directly and edge-detected instead of being used as
+  * clock and asynchronous reset; DIO uses split pins ([[QSPIPinIO]]).
+  * Verilator then sees a single clock and no inout. MISO is registered
+  * on the detected falling edge, one cycle after SCK falls, which the
+  * master samples correctly for any divider >= 1.
+  */
+class psram_sync(parameter: PSRAMParameter = PSRAMParameter()) extends Module {
+  val io = IO(Flipped(new QSPIPinIO))
+
+  val sckPrev  = RegNext(io.sck, false.B)
+  val rise     = io.sck && !sckPrev
+  val fall     = !io.sck && sckPrev
+  val deselect = reset.asBool || io.ce_n
+
+  val module = withReset(deselect) { Module(new PSRAMCore(parameter)) }
+  val misoOut = withReset(deselect) { RegEnable(module.io.miso, 0.U(4.W), fall) }
+  val misoEnOut = withReset(deselect) { RegEnable(module.io.misoEn, false.B, fall) }
+  module.io.step := rise
+  module.io.mosi := io.dout
+  module.io.systemReset := reset.asAsyncReset
+
+  // Bus as seen by the master: the device while it drives, else the master
+  io.din := Mux(misoEnOut, misoOut, io.dout)
+}
@@ -9,15 +9,65 @@ import chisel3.experimental.hierarchy.{instantiable, public, Instance, Instantia
 import chisel3.experimental.{SerializableModule, SerializableModuleParameter, Analog}
 import chisel3.probe.{define, Probe, ProbeValue}
 import chisel3.properties.{AnyClassType, Class, Property}
+import org.chipsalliance.shared.{DataTransform, IntCoalesce}
 
 // ═══════════════════════════════════════════════════════════════════
 // Parameter
 // configs/QSPI.json, used for the parameter deserialize from json to case class
 // ═══════════════════════════════════════════════════════════════════
 
+object QSPIInitCmd {
+  implicit def rwP: upickle.default.ReadWriter[QSPIInitCmd] =
+    upickle.default.macroRW
+}
+
+/** One command of the boot sequence, see [[QSPIParameter.initCmds]].
+  *
+  * @param cmd
+  *   Command byte.
+  * @param qpi
+  *   Send in QPI mode (a nibble per SCK) instead of SPI mode (a bit per
+  *   SCK on DIO[0]).
+  * @param args
+  *   Argument bytes sent after the command (0–3).
+  * @param waitCycles
+  *   CE# high cycles after the command, e.g. the device's reset time.
+  */
+case class QSPIInitCmd(
+  cmd:        Int,
+  qpi:        Boolean  = false,
+  args:       Seq[Int] = Seq(),
+  waitCycles: Int      = 0) {
+  require(cmd >= 0 && cmd < 256, "cmd must be a byte")
+  require(args.size <= 3 && args.forall(a => a >= 0 && a < 256), "args must be at most 3 bytes")
+  require(waitCycles >= 0 && waitCycles < (1 << 16), "waitCycles must fit 16 bits")
+
+  /** SCK cycles of the command. */
+  def nibbles: Int = (1 + args.size) * (if (qpi) 2 else 8)
+
+  /** Reset value of the INIT_CMD register ([[QSPI]]). */
+  def cmdWord: BigInt =
+    (BigInt(waitCycles) << 16) | (BigInt(args.size) << 9) | (if (qpi) BigInt(1) << 8 else BigInt(0)) | cmd
+
+  /** Reset value of the INIT_ARG register, first byte at [7:0]. */
+  def argWord: BigInt = args.zipWithIndex.map { case (a, i) => BigInt(a) << (8 * i) }.sum
+}
+
 object QSPIParameter {
   implicit def rwP: upickle.default.ReadWriter[QSPIParameter] =
     upickle.default.macroRW
+
+  /** Boot sequence for a QPI PSRAM found in either mode: reset from QPI
+    * (an SPI-mode device sees a 2-bit fragment and drops it), reset from
+    * SPI, then enter QPI.
+    */
+  val defaultInitCmds: Seq[QSPIInitCmd] = Seq(
+    QSPIInitCmd(0x66, qpi = true),
+    QSPIInitCmd(0x99, qpi = true, waitCycles = 16),
+    QSPIInitCmd(0x66),
+    QSPIInitCmd(0x99, waitCycles = 16),
+    QSPIInitCmd(0x35)
+  )
 }
 
 /** Parameter of [[QSPI]].
@@ -30,12 +80,21 @@ object QSPIParameter {
   *   Number of slave-select lines (1–32).
   * @param useAsyncReset
   *   Use asynchronous reset when true.
+  * @param useTriState
+  *   Expose DIO as an `Analog` inout ([[QSPIIO]]) when true, or as split
+  *   `dout` / `doe` / `din` pins ([[QSPIPinIO]]) when false, for slaves
+  *   and pads that resolve the bus themselves.
+  * @param initCmds
+  *   Commands sent after reset before the first APB access is served
+  *   (reset values of the INIT table, at most `initEntries`).
   */
 case class QSPIParameter(
-  dividerLen:    Int     = 16,
-  maxChar:       Int     = 128,
-  ssNb:          Int     = 8,
-  useAsyncReset: Boolean = false
+  dividerLen:    Int              = 16,
+  maxChar:       Int              = 128,
+  ssNb:          Int              = 8,
+  useAsyncReset: Boolean          = false,
+  useTriState:   Boolean          = true,
+  initCmds:      Seq[QSPIInitCmd] = QSPIParameter.defaultInitCmds
 ) extends SerializableModuleParameter {
   require(Seq(8, 16, 24, 32).contains(dividerLen), "dividerLen must be 8, 16, 24, or 32")
   require(Seq(8, 16, 24, 32, 64, 128).contains(maxChar), "maxChar must be 8, 16, 24, 32, 64, or 128")
@@ -49,6 +108,113 @@ case class QSPIParameter(
 
   /** Width of the control register. */
   val ctrlBitNb: Int = 14
+
+  // ─── Timing model (exported through [[QSPIOM]]) ─────────────
+  // Every APB access is one QSPI transaction. One SCK half period lasts
+  // `divider + 1` system cycles; an `n`-nibble transaction spans `2n`
+  // half periods plus the closing low phase. The FSM adds `idle → setup
+  // → access` in front of it.
+
+  /** Divider of every SCK phase at reset; SCK = clock / (2 * (divider + 1)). */
+  val resetDivider: Int = 4
+
+  /** Command nibbles in QPI mode. */
+  val cmdNibbles: Int = 2
+
+  /** Address nibbles (24-bit address). */
+  val addrNibbles: Int = 6
+
+  /** Wait nibbles between address and read data. */
+  val readDummyNibbles: Int = 6
+
+  /** Largest payload of one APB access. */
+  val maxPayloadBytes: Int = 4
+
+  /** SCK cycles of the boot sequence ([[initCmds]]) at reset. */
+  def initNibbles: Int = initCmds.map(_.nibbles).sum
+
+  /** Cycles from the first `psel` cycle to the first `pready` cycle, minus the serial part. */
+  val accessOverhead: Int = 3
+
+  // ─── Control/status registers ──────────────────────────────
+  // `paddr[23:0]` addresses the memory; `paddr[csrAddrBit]` set selects
+  // the CSR window instead, word offset `paddr[6:2]`.
+
+  /** Address bit selecting the CSR window. */
+  val csrAddrBit: Int = 24
+
+  /** Entries of the INIT table; its two words per entry fill the upper
+    * half of the CSR window.
+    */
+  val initEntries: Int = 8
+  require(initCmds.size <= initEntries, s"at most $initEntries initCmds")
+  require(initCmds.forall(_.nibbles <= maxChar / 4), "every initCmd must fit the shift register (maxChar / 4 nibbles)")
+
+  /** Width of INT_CTRL.THRESH and INT_STATUS.PENDING. */
+  val intCountBits: Int = 8
+
+  /** Width of INT_CTRL.TIMEOUT (cycles). */
+  val intTimerBits: Int = 16
+
+  // ─── Bursts ────────────────────────────────────────────────
+  // With BURST enabled a transaction stays open after its word: CE stays
+  // low and sequential full-word accesses continue it with
+  // `burstWordNibbles` more nibbles each, SCK pausing in between.
+
+  /** Nibbles of each further word of a burst (no command or address). */
+  val burstWordNibbles: Int = 2 * maxPayloadBytes
+
+  /** Linear burst boundary of the device (PSRAM page); bursts never cross it. */
+  val burstPageBytes: Int = 1024
+
+  /** Width of BURST.CE_MAX (cycles). */
+  val ceMaxBits: Int = 16
+
+  // ─── Pipelining ────────────────────────────────────────────
+  // A transaction runs on its own once issued; the next request waits
+  // only for it and the CE# high gap, during which the shift register is
+  // already loaded. With PIPE.POST a write completes on APB when issued.
+
+  /** Width of PIPE.CE_GAP (cycles). */
+  val ceGapBits: Int = 8
+
+  /** CE# high cycles between transactions at reset (0 behaves as 1). */
+  val ceGapReset: Int = 1
+
+  /** Nibbles of a read transaction. */
+  def readNibbles: Int = cmdNibbles + addrNibbles + readDummyNibbles + 2 * maxPayloadBytes
+
+  /** Nibbles of a write transaction carrying `bytes` bytes. */
+  def writeNibbles(bytes: Int): Int = cmdNibbles + addrNibbles + 2 * bytes
+
+  /** Cycles from the first `psel` cycle to the first `pready` cycle. */
+  def accessCycles(nibbles: Int, divider: Int): Int =
+    accessOverhead + (2 * nibbles + 1) * (divider + 1)
+
+  /** [[accessCycles]] with one divider per SCK phase: `nibbles` and
+    * `dividers` list command, address, dummy and data. The closing half
+    * period runs at the divider of the last phase with nibbles.
+    */
+  def phaseAccessCycles(nibbles: Seq[Int], dividers: Seq[Int]): Int = {
+    val last = nibbles.lastIndexWhere(_ > 0)
+    accessOverhead + nibbles.zip(dividers).map { case (n, d) => 2 * n * (d + 1) }.sum +
+      (if (last < 0) 1 else dividers(last) + 1)
+  }
+
+  /** Wire cycles of each further word of a burst. */
+  def burstWordCycles(divider: Int): Int = 2 * burstWordNibbles * (divider + 1)
+
+  /** Extra cycles an access may wait for a posted word write still on the
+    * wire and the CE# gap after it.
+    */
+  def postedDrainCycles(divider: Int, ceGap: Int): Int =
+    accessCycles(writeNibbles(maxPayloadBytes), divider) + math.max(ceGap, 1)
+
+  /** Extra cycles an access may wait for an open burst to close: a write
+    * burst first drains the word on the wire and one buffered word.
+    */
+  def burstCloseCycles(divider: Int): Int =
+    accessOverhead + (4 * burstWordNibbles + 1) * (divider + 1)
 }
 
 // ═══════════════════════════════════════════════════════════════════
@@ -65,17 +231,72 @@ class QSPIProbe(parameter: QSPIParameter) extends Bundle {
 // used to export metadata to downstream toolchains
 // ═══════════════════════════════════════════════════════════════════
 
-/** Metadata of [[QSPI]]. */
+/** Metadata of [[QSPI]].
+  *
+  * Besides the raw parameters, exports the per-access overhead so
+  * integration tools can cost reads and writes without simulating:
+  * {{{
+  * cycles(nibbles, divider) = accessOverhead + (2 * nibbles + 1) * (divider + 1)
+  * read nibbles  = cmdNibbles + addrNibbles + readDummyNibbles + 2 * 4
+  * write nibbles = cmdNibbles + addrNibbles + 2 * bytes
+  * }}}
+  * Every SCK phase runs at `resetDivider` after reset; with the phase
+  * dividers reprogrammed each phase's nibbles cost `2 * (div + 1)`
+  * instead, plus one data half period ([[QSPIParameter.phaseAccessCycles]]).
+  * A word continuing an open burst costs `burstWordCycles` on the wire;
+  * a posted write reaches `pready` two cycles after `psel` when the
+  * previous transaction and its CE# gap are over.
+  * `sim_qspi_psram.cpp` checks measured cycles against these numbers.
+  */
 @instantiable
 class QSPIOM(parameter: QSPIParameter) extends Class {
   val dividerLen:    Property[Int]     = IO(Output(Property[Int]()))
   val maxChar:       Property[Int]     = IO(Output(Property[Int]()))
   val ssNb:          Property[Int]     = IO(Output(Property[Int]()))
   val useAsyncReset: Property[Boolean] = IO(Output(Property[Boolean]()))
+  val useTriState:   Property[Boolean] = IO(Output(Property[Boolean]()))
   dividerLen    := Property(parameter.dividerLen)
   maxChar       := Property(parameter.maxChar)
   ssNb          := Property(parameter.ssNb)
   useAsyncReset := Property(parameter.useAsyncReset)
+  useTriState   := Property(parameter.useTriState)
+
+  // Derived performance characteristics
+  val resetDivider:     Property[Int]      = IO(Output(Property[Int]()))
+  val cmdNibbles:       Property[Int]      = IO(Output(Property[Int]()))
+  val addrNibbles:      Property[Int]      = IO(Output(Property[Int]()))
+  val readDummyNibbles: Property[Int]      = IO(Output(Property[Int]()))
+  val maxPayloadBytes:  Property[Int]      = IO(Output(Property[Int]()))
+  val accessOverhead:   Property[Int]      = IO(Output(Property[Int]()))
+  val initNibbles:      Property[Int]      = IO(Output(Property[Int]()))
+  val csrAddrBit:       Property[Int]      = IO(Output(Property[Int]()))
+  val burstPageBytes:   Property[Int]      = IO(Output(Property[Int]()))
+  val burstWordNibbles: Property[Int]      = IO(Output(Property[Int]()))
+  val ceGapReset:       Property[Int]      = IO(Output(Property[Int]()))
+  val readCycles:       Property[Int]      = IO(Output(Property[Int]()))
+  val writeCycles:      Property[Seq[Int]] = IO(Output(Property[Seq[Int]]())) // 1, 2, 4 bytes
+  val burstWordCycles:  Property[Int]      = IO(Output(Property[Int]()))
+  val burstCloseCycles: Property[Int]      = IO(Output(Property[Int]()))
+  val postedDrainCycles: Property[Int]     = IO(Output(Property[Int]()))
+  resetDivider     := Property(parameter.resetDivider)
+  cmdNibbles       := Property(parameter.cmdNibbles)
+  addrNibbles      := Property(parameter.addrNibbles)
+  readDummyNibbles := Property(parameter.readDummyNibbles)
+  maxPayloadBytes  := Property(parameter.maxPayloadBytes)
+  accessOverhead   := Property(parameter.accessOverhead)
+  initNibbles      := Property(parameter.initNibbles)
+  csrAddrBit       := Property(parameter.csrAddrBit)
+  burstPageBytes   := Property(parameter.burstPageBytes)
+  burstWordNibbles := Property(parameter.burstWordNibbles)
+  ceGapReset       := Property(parameter.ceGapReset)
+  // Cycle counts at the reset divider
+  readCycles  := Property(parameter.accessCycles(parameter.readNibbles, parameter.resetDivider))
+  writeCycles := Property(
+    Seq(1, 2, 4).map(b => parameter.accessCycles(parameter.writeNibbles(b), parameter.resetDivider))
+  )
+  burstWordCycles  := Property(parameter.burstWordCycles(parameter.resetDivider))
+  burstCloseCycles := Property(parameter.burstCloseCycles(parameter.resetDivider))
+  postedDrainCycles := Property(parameter.postedDrainCycles(parameter.resetDivider, parameter.ceGapReset))
 }
 
 // ═══════════════════════════════════════════════════════════════════
@@ -88,6 +309,15 @@ class QSPIIO extends Bundle {
   val dio  = Analog(4.W)
 }
 
+/** [[QSPIIO]] with DIO split into output, output enable and input. */
+class QSPIPinIO extends Bundle {
+  val sck  = Output(Bool())
+  val ce_n = Output(Bool())
+  val dout = Output(UInt(4.W))
+  val doe  = Output(Bool())
+  val din  = Input(UInt(4.W))
+}
+
 /** Interface of [[QSPI]]. */
 class QSPIInterface(parameter: QSPIParameter) extends Bundle {
   val clock = Input(Clock())
@@ -97,8 +327,9 @@ class QSPIInterface(parameter: QSPIParameter) extends Bundle {
   val apb  = new APBSlaveIO
   val intO = Output(Bool())
 
-  // QSPI master
-  val qspiio = new QSPIIO
+  // QSPI master (one of the two, see [[QSPIParameter.useTriState]])
+  val qspiio   = Option.when(parameter.useTriState)(new QSPIIO)
+  val qspipins = Option.when(!parameter.useTriState)(new QSPIPinIO)
 
   // Verification & metadata
   val probe = Output(Probe(new QSPIProbe(parameter), layers.Verification))
@@ -109,11 +340,23 @@ class QSPIInterface(parameter: QSPIParameter) extends Bundle {
 // Clock Generator
 // ═══════════════════════════════════════════════════════════════════
 
+/** QSPI serial clock generator, same scheme as the SPI master's.
+  *
+  * `pause` stops SCK mid-transaction without ending it: a high phase in
+  * progress completes, then the generator freezes with SCK low and issues
+  * no strobes until `pause` drops. CE stays with the controller, so a
+  * mode-0 device simply sees a long low phase.
+  *
+  * `divider` is only sampled when a half period starts, so it may change
+  * at any time (the QSPI top switches it between transaction phases):
+  * every half period runs at the divider it started with.
+  */
 class QSPIClgen(dividerLen: Int) extends Module {
   val io = IO(new Bundle {
     val go      = Input(Bool())
     val tip     = Input(Bool())
     val lastClk = Input(Bool())
+    val pause   = Input(Bool())
     val divider = Input(UInt(dividerLen.W))
     val clkOut  = Output(Bool())
     val posEdge = Output(Bool())
@@ -127,7 +370,13 @@ class QSPIClgen(dividerLen: Int) extends Module {
   private val cntOne  = cnt === 1.U
   private val divZero = !io.divider.orR
 
-  when(!io.tip || cntZero) {
+  // Frozen while paused with SCK low; the strobe registers hold, so the
+  // edge that was due is issued on resume
+  private val stall = io.tip && io.pause && !clkOut
+
+  when(stall) {
+    // hold
+  }.elsewhen(!io.tip || cntZero) {
     cnt := io.divider
   }.otherwise {
     cnt := cnt - 1.U
@@ -135,23 +384,28 @@ class QSPIClgen(dividerLen: Int) extends Module {
 
   // clkOut toggles every half period;
   // lastClk → clkOut ensures the final edge is always 1→0
-  when(io.tip && cntZero && (!io.lastClk || clkOut)) {
+  when(!stall && io.tip && cntZero && (!io.lastClk || clkOut)) {
     clkOut := ~clkOut
   }
 
-  io.posEdge := RegNext(
+  private val posEdge = RegEnable(
     (io.tip && !clkOut && cntOne) ||
-      (divZero && clkOut) ||
+      (divZero && cntZero && clkOut) ||
       (divZero && io.go && !io.tip),
-    false.B
+    false.B,
+    !stall
   )
 
-  io.negEdge := RegNext(
+  private val negEdge = RegEnable(
     (io.tip && clkOut && cntOne) ||
-      (divZero && !clkOut && io.tip),
-    false.B
+      (divZero && cntZero && !clkOut && io.tip),
+    false.B,
+    !stall
   )
 
+  io.posEdge := posEdge && !stall
+  io.negEdge := negEdge && !stall
+
   io.clkOut := clkOut
 }
 
@@ -173,6 +427,7 @@ class QSPIShift(parameter: QSPIParameter) extends Module {
     val negEdge = Input(Bool())
     val tip     = Output(Bool())        // transfer in progress
     val last    = Output(Bool())        // last nibble (cnt == 0)
+    val left    = Output(UInt(cBits.W)) // nibbles still to be sampled
     val wen     = Input(Bool())         // parallel load enable
     val pIn     = Input(UInt(mChar.W))  // parallel input
     val pOut    = Output(UInt(mChar.W)) // parallel output
@@ -180,6 +435,13 @@ class QSPIShift(parameter: QSPIParameter) extends Module {
     val sIn     = Input(UInt(4.W))      // serial input  (DIO read)
     val sOut    = Output(UInt(4.W))     // serial output (DIO write)
     val sOutEn  = Output(Bool())        // output enable for DIO
+    val stream  = Input(Bool())         // continue word by word (bursts)
+    val more    = Input(Bool())         // at a word end: go on with another word
+    val stop    = Input(Bool())         // abandon the transfer (SCK low)
+    val wordIn  = Input(UInt(32.W))     // next write word, loaded at a word end
+    val wordOut = Output(UInt(32.W))    // read word completed at a word end
+    val wordLast = Output(Bool())       // next rising edge ends a word
+    val wordEnd  = Output(Bool())       // posEdge of a word's last nibble
   })
 
   // ─── Registers ────────────────────────────────────────────────
@@ -203,6 +465,16 @@ class QSPIShift(parameter: QSPIParameter) extends Module {
   private val txClk  = io.negEdge && !last
   dontTouch(txClk)
 
+  // ─── Streaming ────────────────────────────────────────────────
+  // With `stream` set, the rising edge of a word's last nibble wraps the
+  // counter to another word while `more` is set, so the transfer goes on
+  // without a new command or address: reads hand each word out on
+  // `wordOut`, writes take the next one from `wordIn`.
+  private val wordNibbles = 8
+  private val wordLast    = io.stream && state =/= State.idle && cnt === 1.U
+  private val wordEnd     = wordLast && io.posEdge
+  private val wrap        = wordEnd && io.more
+
   // ─── State machine ───────────────────────────────────────────
   switch(state) {
     is(State.idle) {
@@ -232,6 +504,13 @@ class QSPIShift(parameter: QSPIParameter) extends Module {
         sOut := data(bitPos)
         when(outCnt.orR) { outCnt := outCnt - 1.U }
       }
+      when(wrap) {
+        cnt    := wordNibbles.U
+        outCnt := (wordNibbles + 1).U // stays non-zero through the word
+        for (i <- 0 until wordNibbles) {
+          data(i) := io.wordIn(i * 4 + 3, i * 4)
+        }
+      }
 
       when(last && io.posEdge) {
         state := State.idle
@@ -243,6 +522,7 @@ class QSPIShift(parameter: QSPIParameter) extends Module {
     is(State.miso) {
       when(io.posEdge) { cnt := cnt - 1.U }
       when(rxClk)      { data(bitPos) := io.sIn }
+      when(wrap)       { cnt := wordNibbles.U }
 
       when(last && io.posEdge) {
         state := State.idle
@@ -250,18 +530,135 @@ class QSPIShift(parameter: QSPIParameter) extends Module {
     }
   }
 
+  when(io.stop) {
+    state := State.idle
+  }
+
   // ─── Outputs ──────────────────────────────────────────────────
   io.pOut   := data.asUInt
   io.tip    := state =/= State.idle
   io.last   := last
+  io.left   := cnt
   io.sOut   := sOut
   io.sOutEn := state === State.mosi
+
+  io.wordOut  := Cat(VecInit(data.slice(1, wordNibbles)).asUInt, io.sIn)
+  io.wordLast := wordLast
+  io.wordEnd  := wordEnd
 }
 
 // ═══════════════════════════════════════════════════════════════════
 // QSPI Top
 // ═══════════════════════════════════════════════════════════════════
 
+/** QSPI master mapping a QPI PSRAM into the APB address space.
+  *
+  * Every APB access to `paddr[23:0]` is one QSPI transaction (`0xEB` quad
+  * read, `0x38` quad write). With `paddr[csrAddrBit]` set the access goes
+  * to the CSR window instead and completes without a transaction
+  * (word offset `paddr[6:2]`):
+  *   - 0: INT_CTRL
+  *   - 1: INT_STATUS
+  *   - 2: XFORM
+  *   - 3: BURST
+  *   - 4: PIPE
+  *   - 5: CMP_CTRL
+  *   - 6: CMP_EXP
+  *   - 7: CMP_MASK
+  *   - 8: INIT_CTRL
+  *   - 9: DIV_CMD
+  *   - 10: DIV_ADDR
+  *   - 11: DIV_DUMMY
+  *   - 12: DIV_DATA
+  *   - 16 + 2i: INIT_CMD of INIT table entry i
+  *   - 17 + 2i: INIT_ARG of INIT table entry i
+  *
+  * INT_CTRL register layout (interrupt moderation, see [[IntCoalesce]]):
+  *   - [7:0]    THRESH   completed transactions per interrupt (0 = off)
+  *   - [31:16]  TIMEOUT  raise the interrupt this many cycles after the
+  *                       first unacknowledged completion even if THRESH
+  *                       is not reached (0 = off)
+  *
+  * INT_STATUS register layout (intO = CNT | TMO):
+  *   - [0]      CNT      THRESH completions reached (write 1 to clear)
+  *   - [1]      TMO      TIMEOUT expired (write 1 to clear)
+  *   - [15:8]   PENDING  completions since the last acknowledge; writing
+  *                       1 to CNT or TMO restarts it from 0
+  *
+  * XFORM register layout (see [[DataTransform]] for the 4-bit fields):
+  *   - [3:0]    TX  applied to `pwdata` (byte swaps move `pstrb` along,
+  *                  so a byte written to lane 0 under a 32-bit swap lands
+  *                  at address + 3)
+  *   - [11:8]   RX  applied to `prdata`
+  * Both act on the APB word, so a 64-bit swap behaves as a 32-bit one.
+  * They come on top of the fixed lane order (lane 0 at the lowest address).
+  *
+  * BURST register layout (CE kept low between sequential accesses):
+  *   - [0]      RD      a read opens a burst: each next word is prefetched
+  *                      into a one-word buffer and SCK pauses while the
+  *                      buffer is full, so reading the next address costs
+  *                      no command, address or dummy nibbles
+  *   - [1]      WR      a full-word write opens a burst: the next
+  *                      sequential full-word write is posted to the buffer,
+  *                      and SCK pauses on a word's last nibble while the
+  *                      buffer is empty
+  *   - [31:16]  CE_MAX  close an idle burst once CE has been low this many
+  *                      cycles (0 = no limit), e.g. for the PSRAM's tCEM
+  * Any other memory access closes the burst first: a read burst is cut
+  * with SCK low, a write burst drains its buffered word. Bursts also end
+  * at a `burstPageBytes` boundary; CSR accesses leave them open.
+  *
+  * PIPE register layout (transaction pipelining):
+  *   - [7:0]    CE_GAP  CE# high cycles between two transactions, the
+  *                      device's minimum deselect time (0 behaves as 1).
+  *                      The next transaction is loaded into the shift
+  *                      register during the gap and SCK starts right after
+  *   - [8]      POST    writes complete on APB as soon as they are issued
+  *                      and run in the background; the next access is
+  *                      captured while the write is still on the wire
+  *
+  * RX compare: every memory read returned on APB (`prdata`, after
+  * XFORM.RX) is checked against CMP_EXP under CMP_MASK, so a verify pass
+  * needs no compare in software. While CMP_CTRL.EN is set, intO means
+  * FAIL only; completions do not interrupt.
+  *
+  * CMP_CTRL register layout:
+  *   - [0]      EN    compare memory reads
+  *   - [1]      FAIL  a compared read mismatched (write 1 to clear)
+  *   - [31:8]   ADDR  read-only, byte address of the first mismatching
+  *                    byte, kept until FAIL is cleared
+  *
+  * Boot microcode: after reset the controller sends the first COUNT
+  * entries of the INIT table, one transaction each, before it serves
+  * APB; the table resets to [[QSPIParameter.initCmds]]. Writing RUN
+  * replays it (an open burst is closed first) and the next access waits
+  * until it is done, e.g. after reprogramming the table for a faster
+  * configuration. Memory accesses are always QPI `0xEB` / `0x38`, so
+  * the table must leave the device in QPI mode.
+  *
+  * INIT_CTRL register layout:
+  *   - [0]      RUN    write 1 to replay the table
+  *   - [11:8]   COUNT  entries to send (at most `initEntries`)
+  *
+  * INIT_CMD register layout:
+  *   - [7:0]    CMD    command byte
+  *   - [8]      QPI    a nibble per SCK; otherwise SPI, a bit per SCK on
+  *                     DIO[0]
+  *   - [10:9]   NARG   argument bytes from INIT_ARG sent after CMD
+  *   - [31:16]  WAIT   CE# high cycles after the command (besides CE_GAP)
+  * INIT_ARG holds the argument bytes, the first one at [7:0]. A command
+  * longer than `maxChar / 4` SCK cycles is cut.
+  *
+  * SCK phase dividers: DIV_CMD, DIV_ADDR, DIV_DUMMY and DIV_DATA
+  * ([dividerLen-1:0], `resetDivider` at reset) set SCK = clock /
+  * (2 * (div + 1)) separately for the command, address, dummy and data
+  * nibbles of each transaction, so the data phase can run at the
+  * device's quad rate while the command runs slower. A nibble's low
+  * half period (DIO set up) and high half period (DIO sampled) both run
+  * at its phase's rate, the closing half period at the last phase's;
+  * burst words are data. INIT table commands, arguments included, run
+  * at DIV_CMD.
+  */
 @instantiable
 class QSPI(val parameter: QSPIParameter)
     extends FixedIORawModule(new QSPIInterface(parameter))
@@ -296,11 +693,20 @@ class QSPI(val parameter: QSPIParameter)
   // ─── TriState Gate ──────────────────────────────────────────
   private val mosiEnOut = WireDefault(false.B)
   private val mosiOut   = WireDefault(0.U(4.W))
-  private val miso      = TriStateInBuf(io.qspiio.dio, mosiOut, mosiEnOut)
+  private val ceN       = WireDefault(true.B)
+  private val miso = io.qspiio match {
+    case Some(bus) => TriStateInBuf(bus.dio, mosiOut, mosiEnOut)
+    case None =>
+      val pins = io.qspipins.get
+      pins.dout := mosiOut
+      pins.doe  := mosiEnOut
+      pins.din
+  }
 
   // ─── Config registers ──────────────────────────────────────
-  // Default divider = 0 → SCK = system_clock / 2 (fastest)
-  private val divider = RegInit(4.U(P.dividerLen.W))
+  // SCK = system_clock / (2 * (divider + 1)), one divider per phase:
+  // command, address, dummy, data
+  private val sckDiv = RegInit(VecInit(Seq.fill(4)(P.resetDivider.U(P.dividerLen.W))))
 
   // ─── Sub-modules ───────────────────────────────────────────
   private val clgen = Module(new QSPIClgen(P.dividerLen))
@@ -321,18 +727,67 @@ class QSPI(val parameter: QSPIParameter)
 
   clgen.io.go      := false.B
   clgen.io.tip     := shift.io.tip
-  clgen.io.divider := divider
   clgen.io.lastClk := shift.io.last
 
   // ─── APB default outputs ──────────────────────────────────
   io.apb.pready  := false.B
   io.apb.prdata  := 0.U
   io.apb.pslverr := false.B
-  io.intO        := false.B
+
+  // ─── CSR window ────────────────────────────────────────────
+  private val csrSel     = io.apb.paddr(P.csrAddrBit)
+  private val csrAddr    = io.apb.paddr(6, 2)
+  private val intThresh  = RegInit(0.U(P.intCountBits.W))
+  private val intTimeout = RegInit(0.U(P.intTimerBits.W))
+  private val txXform    = RegInit(0.U(DataTransform.width.W))
+  private val rxXform    = RegInit(0.U(DataTransform.width.W))
+  private val burstRd    = RegInit(false.B)
+  private val burstWr    = RegInit(false.B)
+  private val ceMax      = RegInit(0.U(P.ceMaxBits.W))
+  private val ceGap      = RegInit(P.ceGapReset.U(P.ceGapBits.W))
+  private val postWr     = RegInit(false.B)
+  private val cmpEn      = RegInit(false.B)
+  private val cmpFail    = RegInit(false.B)
+  private val cmpAddr    = RegInit(0.U(24.W))
+  private val cmpExp     = RegInit(0.U(32.W))
+  private val cmpMask    = RegInit("hffffffff".U(32.W))
+  private val coalesce   = Module(new IntCoalesce(P.intCountBits, P.intTimerBits))
+  coalesce.io.event   := false.B
+  coalesce.io.thresh  := intThresh
+  coalesce.io.timeout := intTimeout
+  coalesce.io.ack     := 0.U
+  io.intO := Mux(cmpEn, cmpFail, coalesce.io.cause.orR)
+
+  // ─── INIT table (boot microcode) ─────────────────────────
+  private val initIdxBits = log2Ceil(P.initEntries + 1)
+  private val initCmdMask = "hffff07ff".U(32.W)
+  private def initReset(f: QSPIInitCmd => BigInt) =
+    VecInit(Seq.tabulate(P.initEntries)(i => P.initCmds.lift(i).map(f).getOrElse(BigInt(0)).U(32.W)))
+  private val initCmd   = RegInit(initReset(_.cmdWord))
+  private val initArg   = RegInit(initReset(_.argWord))
+  private val initCount = RegInit(P.initCmds.size.U(initIdxBits.W))
+  private val initRun   = RegInit(true.B)
+  private val initIdx   = RegInit(0.U(initIdxBits.W))
+  private val initWait  = RegInit(0.U(16.W))
+
+  // Entry `initIdx` in wire order: CMD, then the NARG argument bytes,
+  // right-aligned in the shift register. SPI mode puts one bit per nibble.
+  private val initEntry = initCmd(initIdx(log2Ceil(P.initEntries) - 1, 0))
+  private val initArgs  = initArg(initIdx(log2Ceil(P.initEntries) - 1, 0))
+  private val initNarg  = initEntry(10, 9)
+  private val initQpi   = initEntry(8)
+  private val initWord  = Cat(initEntry(7, 0), initArgs(7, 0), initArgs(15, 8), initArgs(23, 16))
+  private val initLen4  = Mux(initQpi, (initNarg +& 1.U) << 1, (initNarg +& 1.U) << 3)
+  private val initSpi   = Cat(initWord.asBools.reverse.map(b => Cat(0.U(3.W), b)))
+  private val initData  = Mux(
+    initQpi,
+    (initWord >> ((3.U - initNarg) << 3)).pad(128),
+    initSpi >> ((3.U - initNarg) << 5)
+  )
 
   // ─── QSPI outputs ────────────────────────────────────────
-  io.qspiio.sck := clgen.io.clkOut
-  io.qspiio.ce_n := true.B
+  io.qspiio.foreach { bus => bus.sck := clgen.io.clkOut; bus.ce_n := ceN }
+  io.qspipins.foreach { pins => pins.sck := clgen.io.clkOut; pins.ce_n := ceN }
 
   // ─── QPI Mode ────────────────────────────────────────
   private val qpiMode = RegInit(false.B)
@@ -342,37 +797,43 @@ class QSPI(val parameter: QSPIParameter)
   // the lowest APB byte lane maps to the lowest flash address.
   private val wdata     = WireDefault(0.U(mChar.W))
   private val wCharLen4 = WireDefault(0.U(cBits.W))
+  private val pwdata    = DataTransform(io.apb.pwdata, txXform)
+  private val pstrb     = DataTransform.strobes(io.apb.pstrb, txXform)
+  private val wireWord  = Cat(pwdata(7, 0), pwdata(15, 8), pwdata(23, 16), pwdata(31, 24))
 
-  switch(io.apb.pstrb) {
+  // Reassembles a received word (first byte on the wire in lane 0)
+  private def readWord(rd: UInt): UInt =
+    DataTransform(Cat(rd(7, 0), rd(15, 8), rd(23, 16), rd(31, 24)), rxXform)
+
+  switch(pstrb) {
     is("b0001".U) {
-      wdata     := Cat(qspiWriteCmdExp, io.apb.paddr(23, 0), io.apb.pwdata(7, 0))
+      wdata     := Cat(qspiWriteCmdExp, io.apb.paddr(23, 0), pwdata(7, 0))
       wCharLen4 := ((8 + 24 + 8) >> 2).U
     }
     is("b0010".U) {
-      wdata     := Cat(qspiWriteCmdExp, io.apb.paddr(23, 0) + 1.U, io.apb.pwdata(15, 8))
+      wdata     := Cat(qspiWriteCmdExp, io.apb.paddr(23, 0) + 1.U, pwdata(15, 8))
       wCharLen4 := ((8 + 24 + 8) >> 2).U
     }
     is("b0100".U) {
-      wdata     := Cat(qspiWriteCmdExp, io.apb.paddr(23, 0) + 2.U, io.apb.pwdata(23, 16))
+      wdata     := Cat(qspiWriteCmdExp, io.apb.paddr(23, 0) + 2.U, pwdata(23, 16))
       wCharLen4 := ((8 + 24 + 8) >> 2).U
     }
     is("b1000".U) {
-      wdata     := Cat(qspiWriteCmdExp, io.apb.paddr(23, 0) + 3.U, io.apb.pwdata(31, 24))
+      wdata     := Cat(qspiWriteCmdExp, io.apb.paddr(23, 0) + 3.U, pwdata(31, 24))
       wCharLen4 := ((8 + 24 + 8) >> 2).U
     }
     is("b0011".U) {
-      val swapped = Cat(io.apb.pwdata(7, 0), io.apb.pwdata(15, 8))
+      val swapped = Cat(pwdata(7, 0), pwdata(15, 8))
       wdata     := Cat(qspiWriteCmdExp, io.apb.paddr(23, 0), swapped)
       wCharLen4 := ((8 + 24 + 16) >> 2).U
     }
     is("b1100".U) {
-      val swapped = Cat(io.apb.pwdata(23, 16), io.apb.pwdata(31, 24))
+      val swapped = Cat(pwdata(23, 16), pwdata(31, 24))
       wdata     := Cat(qspiWriteCmdExp, io.apb.paddr(23, 0) + 2.U, swapped)
       wCharLen4 := ((8 + 24 + 16) >> 2).U
     }
     is("b1111".U) {
-      val swapped = Cat(io.apb.pwdata(7, 0), io.apb.pwdata(15, 8), io.apb.pwdata(23, 16), io.apb.pwdata(31, 24))
-      wdata     := Cat(qspiWriteCmdExp, io.apb.paddr(23, 0), swapped)
+      wdata     := Cat(qspiWriteCmdExp, io.apb.paddr(23, 0), wireWord)
       wCharLen4 := ((8 + 24 + 32) >> 2).U
     }
   }
@@ -383,31 +844,128 @@ class QSPI(val parameter: QSPIParameter)
   // shift FSM transition in lockstep — no retrigger gap.
   private val tipDone = shift.io.tip && shift.io.last && clgen.io.posEdge
 
+  // ─── SCK phases ──────────────────────────────────────────
+  // Nibbles left in the transaction when its address, dummy and data
+  // phases start, set with each shift register load; INIT commands keep
+  // all three at 0 and run at DIV_CMD throughout. The clock generator
+  // takes the divider of the nibble in flight (the last one for the
+  // closing half period) at every half period boundary.
+  private val phAddr   = RegInit(0.U(cBits.W))
+  private val phDummy  = RegInit(0.U(cBits.W))
+  private val phData   = RegInit(0.U(cBits.W))
+  private val sckLeft  = Mux(shift.io.last, 1.U, shift.io.left)
+  private val sckPhase = Mux(
+    !shift.io.tip || sckLeft > phAddr,
+    0.U,
+    Mux(sckLeft > phDummy, 1.U, Mux(sckLeft > phData, 2.U, 3.U))
+  )
+  clgen.io.divider := sckDiv(sckPhase)
+
   // ─── State machine ────────────────────────────────────────
   object State extends ChiselEnum {
-    val initSetup, initAccess, idle, setup, access, ready = Value
+    val initSetup, initAccess, initWait, idle, setup, access, ready, csr, burst, close = Value
   }
   private val state = RegInit(State.initSetup)
   private val isWriteReg = RegInit(false.B)
 
+  // ─── Bursts ──────────────────────────────────────────────
+  // `burstOn`: a burst transaction is open (CE low). `buf` holds one word
+  // in wire order: the prefetched next word of a read burst, or the
+  // posted next word of a write burst.
+  private val pageBits   = log2Ceil(P.burstPageBytes)
+  private val burstOn    = RegInit(false.B)
+  private val burstWrite = RegInit(false.B)
+  private val burstAddr  = RegInit(0.U(24.W)) // next sequential address
+  private val closing    = RegInit(false.B)
+  private val bufValid   = RegInit(false.B)
+  private val buf        = RegInit(0.U(32.W))
+  private val ceLow      = RegInit(0.U(P.ceMaxBits.W))
+
+  private val memAddr = io.apb.paddr(23, 0)
+  private val seqHit  = memAddr === burstAddr && memAddr(pageBits - 1, 0) =/= 0.U && !closing
+  private val rdHit   = !io.apb.pwrite && !burstWrite && (burstOn || bufValid) && seqHit
+  private val wrHit   = io.apb.pwrite && burstWrite && burstOn && pstrb === "b1111".U && seqHit
+
+  // A read burst stops after the last word of the page
+  private val pageLastWord = burstAddr(pageBits - 1, 2).andR
+
+  shift.io.stream := burstOn
+  shift.io.more   := Mux(burstWrite, bufValid, !closing && !pageLastWord)
+  shift.io.wordIn := buf
+  // Reads pause while the buffer is full and writes on a word's last
+  // nibble while it is empty; closing freezes a read and releases a write
+  clgen.io.pause := burstOn && Mux(burstWrite, shift.io.wordLast && !bufValid && !closing, bufValid || closing)
+  shift.io.stop  := burstOn && !burstWrite && closing && !clgen.io.clkOut
+
+  when(burstOn) {
+    ceN         := false.B
+    shift.io.go := true.B
+    clgen.io.go := true.B
+  }
+
+  // ─── Transaction engine ──────────────────────────────────
+  // `xferGo`: a single transaction issued from `setup` is on the wire.
+  // It finishes on its own, so `setup` only waits for the engine, and
+  // `gapCnt` keeps CE# high for CE_GAP cycles after each transaction.
+  private val xferGo     = RegInit(false.B)
+  private val gapCnt     = RegInit(0.U(P.ceGapBits.W))
+  private val engineFree = !xferGo && !burstOn && gapCnt <= 1.U
+
+  when(xferGo) {
+    ceN         := false.B
+    shift.io.go := true.B
+    clgen.io.go := true.B
+  }
+  when(tipDone || shift.io.stop) {
+    gapCnt := ceGap
+  }.elsewhen(gapCnt.orR) {
+    gapCnt := gapCnt - 1.U
+  }
+
   switch(state) {
     is(State.initSetup) {
-      shift.io.wen := true.B
-      shift.io.len4 := ( (32) >> 2 ).U
-      shift.io.pIn := expandCmd(0x35).U(32.W)
-      shift.io.sOutLen := ( (32) >> 2 ).U
-      state := State.initAccess
+      when(initIdx >= initCount) {
+        initRun := false.B
+        initIdx := 0.U
+        state   := State.idle
+      }.elsewhen(engineFree) {
+        // One INIT entry per transaction, after the previous CE# gap
+        shift.io.wen     := true.B
+        shift.io.len4    := initLen4
+        shift.io.pIn     := initData(mChar - 1, 0)
+        shift.io.sOutLen := initLen4
+        phAddr           := 0.U
+        phDummy          := 0.U
+        phData           := 0.U
+        state            := State.initAccess
+      }
     }
     is(State.initAccess) {
-      io.qspiio.ce_n := false.B
+      ceN := false.B
       shift.io.go := true.B
       clgen.io.go := true.B
       when(tipDone) {
-        state := State.idle
+        initIdx  := initIdx + 1.U
+        initWait := initEntry(31, 16)
+        state    := State.initWait
+      }
+    }
+    is(State.initWait) {
+      initWait := initWait - 1.U
+      when(initWait <= 1.U) {
+        state := State.initSetup
       }
     }
     is(State.idle) {
-      when(io.apb.psel) {
+      when(initRun) {
+        // INIT_CTRL.RUN: close an open burst, then replay the table
+        when(burstOn) {
+          closing := true.B
+        }.otherwise {
+          bufValid := false.B
+          state    := State.initSetup
+        }
+      }.elsewhen(io.apb.psel) {
         state := State.setup
       }
     }
@@ -431,22 +989,57 @@ class QSPI(val parameter: QSPIParameter)
         nextSOutLen4  := ((8 + 24) >> 2).U
       }
 
-      when(nextCharLen4 === 0.U) {
+      when(csrSel) {
+        // CSR window: no transaction
+        state := State.csr
+      }.elsewhen(rdHit || wrHit) {
+        // Continues the open burst
+        state := State.burst
+      }.elsewhen(burstOn || bufValid) {
+        // Any other access ends the burst first
+        state := State.close
+      }.elsewhen(nextCharLen4 === 0.U) {
         // Unsupported pstrb or zero-length → skip transfer
         state := State.ready
-      }.otherwise {
+      }.elsewhen(engineFree) {
+        // Issue once the previous transaction and its CE# gap are over
+        // (until then stay here); SCK starts in the next cycle
         shift.io.wen     := true.B
         shift.io.len4    := nextCharLen4
         shift.io.pIn     := nextData
         shift.io.sOutLen := nextSOutLen4
-        state            := State.access
+        phAddr           := nextCharLen4 - P.cmdNibbles.U
+        phDummy          := Mux(
+          io.apb.pwrite,
+          nextCharLen4 - (P.cmdNibbles + P.addrNibbles).U,
+          (P.readDummyNibbles + 2 * P.maxPayloadBytes).U
+        )
+        phData           := Mux(
+          io.apb.pwrite,
+          nextCharLen4 - (P.cmdNibbles + P.addrNibbles).U,
+          (2 * P.maxPayloadBytes).U
+        )
+        xferGo           := true.B
+        state            := Mux(io.apb.pwrite && postWr, State.ready, State.access)
+
+        when(Mux(io.apb.pwrite, burstWr && pstrb === "b1111".U, burstRd)) {
+          xferGo     := false.B
+          burstOn    := true.B
+          burstWrite := io.apb.pwrite
+          when(io.apb.pwrite) {
+            // Posted: the word is in the shift register
+            burstAddr         := memAddr + 4.U
+            coalesce.io.event := true.B
+            state             := State.ready
+          }.otherwise {
+            burstAddr := memAddr
+            state     := State.burst
+          }
+        }
       }
     }
 
     is(State.access) {
-      io.qspiio.ce_n := false.B
-      shift.io.go := true.B
-      clgen.io.go := true.B
       when(tipDone) {
         state := State.ready
       }
@@ -457,14 +1050,161 @@ class QSPI(val parameter: QSPIParameter)
 
       // For reads: reassemble the 32bit word from the 4 nibbles
       when(!isWriteReg) {
-        val rd = shift.io.pOut(31, 0)
-        io.apb.prdata := Cat(rd(7, 0), rd(15, 8), rd(23, 16), rd(31, 24))
+        io.apb.prdata := readWord(shift.io.pOut(31, 0))
       }
 
       when(io.apb.penable) {
         state := State.idle
       }
     }
+
+    is(State.csr) {
+      io.apb.pready := true.B
+      switch(csrAddr) {
+        is(0.U) { io.apb.prdata := Cat(intTimeout, 0.U(8.W), intThresh) }
+        is(1.U) { io.apb.prdata := Cat(0.U(16.W), coalesce.io.pending, 0.U(6.W), coalesce.io.cause) }
+        is(2.U) { io.apb.prdata := Cat(rxXform, 0.U(4.W), txXform).pad(32) }
+        is(3.U) { io.apb.prdata := Cat(ceMax, 0.U(14.W), burstWr, burstRd) }
+        is(4.U) { io.apb.prdata := Cat(postWr, ceGap).pad(32) }
+        is(5.U) { io.apb.prdata := Cat(cmpAddr, 0.U(6.W), cmpFail, cmpEn) }
+        is(6.U) { io.apb.prdata := cmpExp }
+        is(7.U) { io.apb.prdata := cmpMask }
+        is(8.U) { io.apb.prdata := Cat(initCount, 0.U(7.W), initRun).pad(32) }
+        is(9.U) { io.apb.prdata := sckDiv(0).pad(32) }
+        is(10.U) { io.apb.prdata := sckDiv(1).pad(32) }
+        is(11.U) { io.apb.prdata := sckDiv(2).pad(32) }
+        is(12.U) { io.apb.prdata := sckDiv(3).pad(32) }
+      }
+      when(csrAddr(4)) {
+        io.apb.prdata := Mux(csrAddr(0), initArg(csrAddr(3, 1)), initCmd(csrAddr(3, 1)))
+      }
+
+      when(io.apb.penable) {
+        when(io.apb.pwrite) {
+          when(csrAddr === 0.U) {
+            when(io.apb.pstrb(0)) { intThresh := io.apb.pwdata(7, 0) }
+            val mask = Cat(Fill(8, io.apb.pstrb(3)), Fill(8, io.apb.pstrb(2)))
+            intTimeout := (io.apb.pwdata(31, 16) & mask) | (intTimeout & ~mask)
+          }
+          when(csrAddr === 1.U && io.apb.pstrb(0)) {
+            coalesce.io.ack := io.apb.pwdata(1, 0)
+          }
+          when(csrAddr === 2.U) {
+            when(io.apb.pstrb(0)) { txXform := io.apb.pwdata(3, 0) }
+            when(io.apb.pstrb(1)) { rxXform := io.apb.pwdata(11, 8) }
+          }
+          when(csrAddr === 3.U) {
+            when(io.apb.pstrb(0)) {
+              burstRd := io.apb.pwdata(0)
+              burstWr := io.apb.pwdata(1)
+            }
+            val mask = Cat(Fill(8, io.apb.pstrb(3)), Fill(8, io.apb.pstrb(2)))
+            ceMax := (io.apb.pwdata(31, 16) & mask) | (ceMax & ~mask)
+          }
+          when(csrAddr === 4.U) {
+            when(io.apb.pstrb(0)) { ceGap := io.apb.pwdata(7, 0) }
+            when(io.apb.pstrb(1)) { postWr := io.apb.pwdata(8) }
+          }
+          when(csrAddr === 5.U && io.apb.pstrb(0)) {
+            cmpEn := io.apb.pwdata(0)
+            when(io.apb.pwdata(1)) { cmpFail := false.B }
+          }
+          val laneMask = Cat((0 until 4).reverse.map(j => Fill(8, io.apb.pstrb(j))))
+          when(csrAddr === 6.U) { cmpExp := (io.apb.pwdata & laneMask) | (cmpExp & ~laneMask) }
+          when(csrAddr === 7.U) { cmpMask := (io.apb.pwdata & laneMask) | (cmpMask & ~laneMask) }
+          when(csrAddr === 8.U) {
+            when(io.apb.pstrb(0) && io.apb.pwdata(0)) { initRun := true.B }
+            when(io.apb.pstrb(1)) {
+              val count = io.apb.pwdata(8 + initIdxBits - 1, 8)
+              initCount := Mux(count > P.initEntries.U, P.initEntries.U, count)
+            }
+          }
+          for (ph <- 0 until 4) {
+            when(csrAddr === (9 + ph).U) {
+              sckDiv(ph) := ((io.apb.pwdata & laneMask) | (sckDiv(ph).pad(32) & ~laneMask))(P.dividerLen - 1, 0)
+            }
+          }
+          when(csrAddr(4)) {
+            val i = csrAddr(3, 1)
+            when(csrAddr(0)) {
+              initArg(i) := ((io.apb.pwdata & laneMask) | (initArg(i) & ~laneMask)) & "hffffff".U
+            }.otherwise {
+              initCmd(i) := ((io.apb.pwdata & laneMask) | (initCmd(i) & ~laneMask)) & initCmdMask
+            }
+          }
+        }
+        state := State.idle
+      }
+    }
+
+    is(State.burst) {
+      when(burstWrite) {
+        // Post the word once the previous one has gone to the shift register
+        when(!bufValid) {
+          io.apb.pready := true.B
+          when(io.apb.penable) {
+            buf               := wireWord
+            bufValid          := true.B
+            burstAddr         := burstAddr + 4.U
+            coalesce.io.event := true.B
+            state             := State.idle
+          }
+        }
+      }.elsewhen(bufValid) {
+        io.apb.pready := true.B
+        io.apb.prdata := readWord(buf)
+        when(io.apb.penable) {
+          bufValid          := false.B
+          burstAddr         := burstAddr + 4.U
+          coalesce.io.event := true.B
+          state             := State.idle
+        }
+      }
+    }
+
+    is(State.close) {
+      when(burstOn) {
+        closing := true.B
+      }.otherwise {
+        bufValid := false.B
+        state    := State.setup
+      }
+    }
+  }
+
+  // ─── Burst bookkeeping ────────────────────────────────────
+  when(shift.io.wordEnd) {
+    when(!burstWrite) {
+      // Read: the buffer is empty here, otherwise SCK would be paused
+      buf      := shift.io.wordOut
+      bufValid := true.B
+    }.elsewhen(bufValid) {
+      // Write: the buffered word has been loaded into the shift register
+      bufValid := false.B
+    }
+  }
+  when(burstOn && (tipDone || shift.io.stop)) {
+    burstOn := false.B
+    closing := false.B
+  }
+  when(xferGo && tipDone) {
+    xferGo            := false.B
+    coalesce.io.event := true.B
+  }
+
+  // ─── RX compare ───────────────────────────────────────────
+  private val memReadDone = io.apb.psel && io.apb.penable && io.apb.pready && !io.apb.pwrite &&
+    (state === State.ready || state === State.burst)
+  private val cmpDiff = (io.apb.prdata ^ cmpExp) & cmpMask
+  private val cmpLane = PriorityEncoder((0 until 4).map(i => cmpDiff(8 * i + 7, 8 * i).orR))
+  when(cmpEn && memReadDone && cmpDiff.orR && !cmpFail) {
+    cmpFail := true.B
+    cmpAddr := memAddr + cmpLane
+  }
+
+  ceLow := Mux(burstOn, ceLow + (!ceLow.andR).asUInt, 0.U)
+  when(state === State.idle && burstOn && ceMax.orR && ceLow >= ceMax) {
+    closing := true.B
   }
 
   // ─── Probe ──────────────────────────────────────────────────
@@ -472,6 +1212,44 @@ class QSPI(val parameter: QSPIParameter)
   define(io.probe, ProbeValue(probeWire))
   probeWire.tip := shift.io.tip
 
+  // ─── Latency bound (performance regression guard) ──────────
+  // Every APB access must reach pready within the timing model published
+  // by [[QSPIOM]]. Counting starts in `idle` with no INIT run pending, so
+  // an access that waits for the boot sequence is measured from when the
+  // FSM accepts it. An access may also wait for the CE# gap, a posted
+  // write still on the wire, or an open burst to close.
+  layer.block(layers.Verification) {
+    val busy    = RegInit(false.B)
+    val elapsed = RegInit(0.U(32.W))
+    val bound   = RegInit(0.U(32.W))
+
+    val start    = io.apb.psel && !busy && state === State.idle && !initRun
+    val nibbles  = Mux(io.apb.pwrite, wCharLen4, P.readNibbles.U)
+    val measured = Mux(start, 1.U, elapsed + 1.U)
+    // Bounded at the slowest SCK phase
+    val divider  = sckDiv.reduce((a, b) => Mux(a > b, a, b))
+    val closeMax = P.accessOverhead.U + (4 * P.burstWordNibbles + 1).U * (divider +& 1.U)
+    val drainMax = P.accessOverhead.U + (2 * P.writeNibbles(P.maxPayloadBytes) + 1).U * (divider +& 1.U)
+    val allowed  = Mux(
+      start,
+      P.accessOverhead.U + (2.U * nibbles + 1.U) * (divider +& 1.U) + ceGap +
+        Mux(xferGo, drainMax, 0.U) + Mux(burstOn || bufValid, closeMax, 0.U),
+      bound
+    )
+
+    when(start || busy) {
+      elapsed := measured
+      bound   := allowed
+      busy    := !io.apb.pready
+      when(io.apb.pready) {
+        assert(
+          measured <= allowed,
+          cf"QSPI access latency bound exceeded (pwrite=${io.apb.pwrite}): measured $measured cycles, allowed $allowed"
+        )
+      }
+    }
+  }
+
   // ─── Object Model ──────────────────────────────────────────
   private val omInstance: Instance[QSPIOM] = Instantiate(new QSPIOM(parameter))
   io.om := omInstance.getPropertyReference.asAnyClassType
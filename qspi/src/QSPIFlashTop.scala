@@ -0,0 +1,98 @@
+package org.chipsalliance.qspi
+
+import chisel3._
+import chisel3.experimental.hierarchy.instantiable
+import chisel3.experimental.{SerializableModule, SerializableModuleParameter}
+
+object QSPIFlashTopParameter {
+  implicit def rwP: upickle.default.ReadWriter[QSPIFlashTopParameter] =
+    upickle.default.macroRW
+}
+
+/** Parameter of [[QSPIFlashTop]]: the QSPI master and the NOR flash model
+  * behind it. The flash is oversampled only, so the master needs split
+  * DIO pins.
+  */
+case class QSPIFlashTopParameter(
+  qspi:  QSPIParameter  = QSPIParameter(useTriState = false),
+  flash: FlashParameter = FlashParameter()
+) extends SerializableModuleParameter {
+  require(!qspi.useTriState, "the flash model needs qspi.useTriState = false")
+}
+
+class QSPIFlashInterface(parameter: QSPIFlashTopParameter) extends Bundle {
+  val clock   = Input(Clock())
+  val reset   = Input(if (parameter.qspi.useAsyncReset) AsyncReset() else Bool())
+
+  // APB slave interface
+  val paddr   = Input(UInt(32.W))
+  val psel    = Input(Bool())
+  val penable = Input(Bool())
+  val pwrite  = Input(Bool())
+  val pstrb   = Input(UInt(4.W))
+  val pwdata  = Input(UInt(32.W))
+  val prdata  = Output(UInt(32.W))
+  val pready  = Output(Bool())
+  val pslverr = Output(Bool())
+  val intO    = Output(Bool())
+
+  // Programming header: with prog_en the flash pins follow prog_* and the
+  // master sees an idle bus
+  val prog_en   = Input(Bool())
+  val prog_sck  = Input(Bool())
+  val prog_ce_n = Input(Bool())
+  val prog_dout = Input(UInt(4.W))
+
+  // Debug outputs (qspi_dio: whatever is on DIO, from either side)
+  val qspi_sck     = Output(Bool())
+  val qspi_ce_n    = Output(Bool())
+  val qspi_dio     = Output(UInt(4.W))
+  val flash_status = Output(UInt(8.W))
+}
+
+/** [[QSPI]] master with a quad NOR flash ([[flash_sync]]) for XIP and
+  * program / erase studies. Memory reads are the same `0xEB` transactions
+  * as against [[QSPIPSRAMTop]]; memory writes are `0x38` page programs
+  * and only take effect after a write enable (e.g. an INIT table entry).
+  */
+@instantiable
+class QSPIFlashTop(val parameter: QSPIFlashTopParameter)
+    extends FixedIORawModule(new QSPIFlashInterface(parameter))
+    with SerializableModule[QSPIFlashTopParameter]
+    with ImplicitClock
+    with ImplicitReset {
+  override protected def implicitClock: Clock = io.clock
+  override protected def implicitReset: Reset = io.reset
+
+  val qspiMaster = Module(new QSPI(parameter.qspi))
+  val flashDev   = Module(new flash_sync(parameter.flash))
+
+  // Clock and reset
+  qspiMaster.io.clock := io.clock
+  qspiMaster.io.reset := io.reset
+
+  // APB connections
+  qspiMaster.io.apb.paddr   := io.paddr
+  qspiMaster.io.apb.psel    := io.psel
+  qspiMaster.io.apb.penable := io.penable
+  qspiMaster.io.apb.pwrite  := io.pwrite
+  qspiMaster.io.apb.pstrb   := io.pstrb
+  qspiMaster.io.apb.pwdata  := io.pwdata
+  io.prdata                 := qspiMaster.io.apb.prdata
+  io.pready                 := qspiMaster.io.apb.pready
+  io.pslverr                := qspiMaster.io.apb.pslverr
+  io.intO                   := qspiMaster.io.intO
+
+  // QSPI master / programming header <-> flash
+  val pins = qspiMaster.io.qspipins.get
+  flashDev.io.sck  := Mux(io.prog_en, io.prog_sck, pins.sck)
+  flashDev.io.ce_n := Mux(io.prog_en, io.prog_ce_n, pins.ce_n)
+  flashDev.io.dout := Mux(io.prog_en, io.prog_dout, pins.dout)
+  flashDev.io.doe  := Mux(io.prog_en, true.B, pins.doe)
+  pins.din         := Mux(io.prog_en, pins.dout, flashDev.io.din)
+
+  io.qspi_sck     := flashDev.io.sck
+  io.qspi_ce_n    := flashDev.io.ce_n
+  io.qspi_dio     := flashDev.io.din
+  io.flash_status := flashDev.status
+}
@@ -1,12 +1,29 @@
 package org.chipsalliance.qspi
 
 import chisel3._
+import chisel3.experimental.attach
 import chisel3.experimental.hierarchy.instantiable
-import chisel3.experimental.SerializableModule
+import chisel3.experimental.{SerializableModule, SerializableModuleParameter}
 
-class QSPIPSRAMInterface(parameter: QSPIParameter) extends Bundle {
+object QSPIPSRAMTopParameter {
+  implicit def rwP: upickle.default.ReadWriter[QSPIPSRAMTopParameter] =
+    upickle.default.macroRW
+}
+
+/** Parameter of [[QSPIPSRAMTop]]: the QSPI master and the PSRAM model
+  * behind it (DPI-C or on-chip SRAM store). The oversampled model needs
+  * the master's split DIO pins, the SCK-clocked one its tri-state bus.
+  */
+case class QSPIPSRAMTopParameter(
+  qspi:  QSPIParameter  = QSPIParameter(),
+  psram: PSRAMParameter = PSRAMParameter()
+) extends SerializableModuleParameter {
+  require(psram.oversample == !qspi.useTriState, "psram.oversample requires qspi.useTriState = false (and vice versa)")
+}
+
+class QSPIPSRAMInterface(parameter: QSPIPSRAMTopParameter) extends Bundle {
   val clock   = Input(Clock())
-  val reset   = Input(if (parameter.useAsyncReset) AsyncReset() else Bool())
+  val reset   = Input(if (parameter.qspi.useAsyncReset) AsyncReset() else Bool())
 
   // APB slave interface
   val paddr   = Input(UInt(32.W))
@@ -20,22 +37,22 @@ class QSPIPSRAMInterface(parameter: QSPIParameter) extends Bundle {
   val pslverr = Output(Bool())
   val intO    = Output(Bool())
 
-  // Debug outputs
+  // Debug outputs (qspi_dio: whatever is on DIO, from either side)
   val qspi_sck  = Output(Bool())
   val qspi_ce_n = Output(Bool())
+  val qspi_dio  = Output(UInt(4.W))
 }
 
 @instantiable
-class QSPIPSRAMTop(val parameter: QSPIParameter)
+class QSPIPSRAMTop(val parameter: QSPIPSRAMTopParameter)
     extends FixedIORawModule(new QSPIPSRAMInterface(parameter))
-    with SerializableModule[QSPIParameter]
+    with SerializableModule[QSPIPSRAMTopParameter]
     with ImplicitClock
     with ImplicitReset {
   override protected def implicitClock: Clock = io.clock
   override protected def implicitReset: Reset = io.reset
 
-  val qspiMaster = Module(new QSPI(parameter))
-  val psramDev   = Module(new psram)
+  val qspiMaster = Module(new QSPI(parameter.qspi))
 
   // Clock and reset
   qspiMaster.io.clock := io.clock
@@ -54,12 +71,29 @@ class QSPIPSRAMTop(val parameter: QSPIParameter)
   io.intO                   := qspiMaster.io.intO
 
   // QSPI master <-> PSRAM slave
-  psramDev.io.sck  := qspiMaster.io.qspiio.sck
-  psramDev.io.ce_n := qspiMaster.io.qspiio.ce_n
-  psramDev.io.dio  <> qspiMaster.io.qspiio.dio
-  psramDev.systemReset := io.reset.asAsyncReset
+  if (parameter.psram.oversample) {
+    val psramDev = Module(new psram_sync(parameter.psram))
+    val pins     = qspiMaster.io.qspipins.get
+    psramDev.io <> pins
+
+    io.qspi_sck  := pins.sck
+    io.qspi_ce_n := pins.ce_n
+    io.qspi_dio  := Mux(pins.doe, pins.dout, pins.din)
+  } else {
+    val psramDev = Module(new psram(parameter.psram))
+    val bus      = qspiMaster.io.qspiio.get
+    psramDev.io.sck  := bus.sck
+    psramDev.io.ce_n := bus.ce_n
+    psramDev.systemReset := io.reset.asAsyncReset
+
+    // A third, never-driving buffer on the bus to observe DIO
+    val dioMon = Module(new TriStateInBuf(4))
+    dioMon.io.dout   := 0.U
+    dioMon.io.out_en := false.B
+    attach(bus.dio, psramDev.io.dio, dioMon.io.dio)
 
-  // Debug outputs
-  io.qspi_sck  := qspiMaster.io.qspiio.sck
-  io.qspi_ce_n := qspiMaster.io.qspiio.ce_n
+    io.qspi_sck  := bus.sck
+    io.qspi_ce_n := bus.ce_n
+    io.qspi_dio  := dioMon.io.din
+  }
 }
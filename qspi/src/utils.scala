@@ -48,4 +48,4 @@ object TriStateInBuf {
     buf.io.out_en := out_en
     buf.io.din
   }
-}
\ No newline at end of file
+}
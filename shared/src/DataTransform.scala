@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: Unlicense
+// Building blocks shared by the SPI and QSPI masters
+
+package org.chipsalliance.shared
+
+import chisel3._
+import chisel3.util._
+
+/** Byte/bit-order transform applied on a controller data path.
+  *
+  * XFORM field layout (4 bits, applied in this order):
+  *   - [1:0]  BSWAP    0: none, 1: swap bytes within 16 bits,
+  *                     2: within 32 bits, 3: within 64 bits
+  *                     (a group never exceeds the data width)
+  *   - [2]    BITREV   reverse the bits of every byte
+  *   - [3]    NIBSWAP  swap the nibbles of every byte
+  */
+object DataTransform {
+  val width: Int = 4
+
+  // Reverses the order of `elems` inside every run of `group` of them
+  private def swapGroups(elems: Seq[UInt], group: Int): Seq[UInt] = {
+    val g = math.min(group, elems.size)
+    elems.indices.map { i =>
+      val base = i / g * g
+      elems(base + g - 1 - (i - base))
+    }
+  }
+
+  private def bswap(elems: Seq[UInt], xform: UInt, default: UInt): UInt =
+    MuxLookup(xform(1, 0), default)(
+      Seq(1.U -> 2, 2.U -> 4, 3.U -> 8).map { case (k, g) => k -> VecInit(swapGroups(elems, g)).asUInt }
+    )
+
+  /** `data` (a whole number of bytes) transformed by `xform`. */
+  def apply(data: UInt, xform: UInt): UInt = {
+    require(data.getWidth % 8 == 0, "DataTransform needs whole bytes")
+    val bytes   = (0 until data.getWidth / 8).map(i => data(8 * i + 7, 8 * i))
+    val swapped = bswap(bytes, xform, data)
+    val out = (0 until data.getWidth / 8).map { i =>
+      val b = swapped(8 * i + 7, 8 * i)
+      val r = Mux(xform(2), Reverse(b), b)
+      Mux(xform(3), Cat(r(3, 0), r(7, 4)), r)
+    }
+    Cat(out.reverse)
+  }
+
+  /** Byte strobes moved along with their bytes by the BSWAP part of `xform`. */
+  def strobes(strb: UInt, xform: UInt): UInt =
+    bswap(strb.asBools, xform, strb)
+}
@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: Unlicense
+// Building blocks shared by the SPI and QSPI masters
+
+package org.chipsalliance.shared
+
+import chisel3._
+import chisel3.util._
+
+/** Interrupt moderation (coalescing).
+  *
+  * Counts `event` pulses and raises the COUNT cause once `thresh` of them
+  * are pending, or the TIMEOUT cause `timeout` cycles after the first
+  * pending one (0 disables the timer). Acknowledging either cause starts a
+  * new batch: `pending` restarts from 0, and an event in the acknowledge
+  * cycle counts toward the new batch.
+  */
+class IntCoalesce(countBits: Int, timerBits: Int) extends Module {
+  val io = IO(new Bundle {
+    val event   = Input(Bool())
+    val thresh  = Input(UInt(countBits.W))  // events per interrupt (0 = never)
+    val timeout = Input(UInt(timerBits.W))  // cycles (0 = no timer)
+    val ack     = Input(UInt(2.W))          // write-1-to-clear of `cause`
+    val pending = Output(UInt(countBits.W)) // saturating
+    val cause   = Output(UInt(2.W))         // [0] COUNT, [1] TIMEOUT
+  })
+
+  private val pending    = RegInit(0.U(countBits.W))
+  private val timer      = RegInit(0.U(timerBits.W))
+  private val causeCount = RegInit(false.B)
+  private val causeTimer = RegInit(false.B)
+
+  private val acked       = io.ack.orR
+  private val base        = Mux(acked, 0.U, pending)
+  private val nextPending = Mux(io.event && !base.andR, base + 1.U, base)
+  pending := nextPending
+
+  // Cycles since the batch's first event
+  timer := Mux(acked || !pending.orR, 0.U, timer + 1.U)
+  private val timerFire = io.timeout.orR && pending.orR && !acked &&
+    !(causeCount || causeTimer) && timer === io.timeout - 1.U
+
+  causeCount := (causeCount && !io.ack(0)) ||
+    (io.event && io.thresh.orR && nextPending >= io.thresh)
+  causeTimer := (causeTimer && !io.ack(1)) || timerFire
+
+  io.pending := pending
+  io.cause   := Cat(causeTimer, causeCount)
+}
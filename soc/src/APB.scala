@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: Unlicense
+// APB segment building blocks: address decoder and a generic memory slave
+
+package org.chipsalliance.soc
+
+import chisel3._
+import chisel3.util._
+import org.chipsalliance.qspi.APBSlaveIO
+
+// ═══════════════════════════════════════════════════════════════════
+// Decoder
+// ═══════════════════════════════════════════════════════════════════
+
+/** APB decoder: one bridge-side port fanned out to `n` slaves.
+  *
+  * The address space is cut into slots of `2^slotBits` bytes; slot `i`
+  * (`paddr[31:slotBits] == i`) goes to slave `i`, which sees the offset
+  * within its slot on `paddr`. There is only one transfer at a time, so a
+  * slave holding `pready` low stalls the whole segment. An access to any
+  * other slot completes at once with `pslverr`.
+  */
+class APBDecoder(n: Int, slotBits: Int) extends Module {
+  require(n >= 1 && slotBits < 32 && log2Ceil(n) <= 32 - slotBits, "slots must fit the address space")
+
+  val io = IO(new Bundle {
+    val in  = new APBSlaveIO
+    val out = Vec(n, Flipped(new APBSlaveIO))
+  })
+
+  private val slot   = io.in.paddr(31, slotBits)
+  private val hit    = VecInit((0 until n).map(i => slot === i.U))
+  private val offset = io.in.paddr(slotBits - 1, 0)
+
+  io.out.zip(hit).foreach { case (o, h) =>
+    o.paddr   := offset
+    o.psel    := io.in.psel && h
+    o.penable := io.in.penable
+    o.pwrite  := io.in.pwrite
+    o.pstrb   := io.in.pstrb
+    o.pwdata  := io.in.pwdata
+  }
+
+  io.in.prdata  := Mux1H(hit, io.out.map(_.prdata))
+  io.in.pready  := Mux(hit.asUInt.orR, Mux1H(hit, io.out.map(_.pready)), true.B)
+  io.in.pslverr := Mux(hit.asUInt.orR, Mux1H(hit, io.out.map(_.pslverr)), true.B)
+}
+
+// ═══════════════════════════════════════════════════════════════════
+// Generic slave
+// ═══════════════════════════════════════════════════════════════════
+
+object APBMemSlaveParameter {
+  implicit def rwP: upickle.default.ReadWriter[APBMemSlaveParameter] =
+    upickle.default.macroRW
+}
+
+/** Parameter of [[APBMemSlave]].
+  *
+  * @param words
+  *   32-bit words of memory (power of 2), mirrored across the slot.
+  * @param waitStates
+  *   Cycles `pready` stays low in the ACCESS phase of every transfer.
+  */
+case class APBMemSlaveParameter(
+  words:      Int = 256,
+  waitStates: Int = 2) {
+  require(isPow2(words) && words >= 2, "words must be a power of 2")
+  require(waitStates >= 0 && waitStates < 256, "waitStates must be in 0..255")
+
+  val addrBits: Int = log2Ceil(words) + 2
+}
+
+/** Word-addressed memory behind APB with a fixed number of wait states,
+  * standing in for the other slaves of a segment (timers, GPIO, a mailbox).
+  */
+class APBMemSlave(parameter: APBMemSlaveParameter) extends Module {
+  val io = IO(new APBSlaveIO)
+
+  private val mem     = Mem(parameter.words, Vec(4, UInt(8.W)))
+  private val idx     = io.paddr(parameter.addrBits - 1, 2)
+  private val waitCnt = RegInit(0.U(8.W))
+
+  private val access = io.psel && io.penable
+  private val ready  = waitCnt === parameter.waitStates.U
+  waitCnt := Mux(access && !ready, waitCnt + 1.U, 0.U)
+
+  when(access && ready && io.pwrite) {
+    mem.write(idx, VecInit((0 until 4).map(i => io.pwdata(8 * i + 7, 8 * i))), io.pstrb.asBools)
+  }
+
+  io.prdata  := mem.read(idx).asUInt
+  io.pready  := ready
+  io.pslverr := false.B
+}
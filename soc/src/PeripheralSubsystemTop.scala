@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: Unlicense
+// SPI, QSPI + PSRAM and a generic slave sharing one APB segment
+
+package org.chipsalliance.soc
+
+import chisel3._
+import chisel3.experimental.hierarchy.instantiable
+import chisel3.experimental.{SerializableModule, SerializableModuleParameter}
+import org.chipsalliance.qspi.{QSPIPSRAMTop, QSPIPSRAMTopParameter}
+import org.chipsalliance.spi.{SPI, SPIParameter}
+
+object PeripheralSubsystemTopParameter {
+  implicit def rwP: upickle.default.ReadWriter[PeripheralSubsystemTopParameter] =
+    upickle.default.macroRW
+}
+
+/** Parameter of [[PeripheralSubsystemTop]]. All three slaves share the
+  * segment's reset type.
+  */
+case class PeripheralSubsystemTopParameter(
+  spi:   SPIParameter          = SPIParameter(),
+  qspi:  QSPIPSRAMTopParameter = QSPIPSRAMTopParameter(),
+  slave: APBMemSlaveParameter  = APBMemSlaveParameter()
+) extends SerializableModuleParameter {
+  require(spi.useAsyncReset == qspi.qspi.useAsyncReset, "spi and qspi must use the same reset type")
+
+  // ─── Address map ───────────────────────────────────────────
+  // One slot per slave; QSPI needs 25 address bits (PSRAM below
+  // paddr[24], its CSR window above).
+
+  /** Address bits of a slot. */
+  val slotBits: Int = 25
+
+  /** Slot of each slave. */
+  val qspiSlot:  Int = 0
+  val spiSlot:   Int = 1
+  val slaveSlot: Int = 2
+
+  def base(slot: Int): BigInt = BigInt(slot) << slotBits
+}
+
+class PeripheralSubsystemInterface(parameter: PeripheralSubsystemTopParameter) extends Bundle {
+  val clock = Input(Clock())
+  val reset = Input(if (parameter.spi.useAsyncReset) AsyncReset() else Bool())
+
+  // APB from the bridge
+  val paddr   = Input(UInt(32.W))
+  val psel    = Input(Bool())
+  val penable = Input(Bool())
+  val pwrite  = Input(Bool())
+  val pstrb   = Input(UInt(4.W))
+  val pwdata  = Input(UInt(32.W))
+  val prdata  = Output(UInt(32.W))
+  val pready  = Output(Bool())
+  val pslverr = Output(Bool())
+
+  val spiIntO  = Output(Bool())
+  val qspiIntO = Output(Bool())
+
+  // Debug outputs
+  val spi_ss    = Output(UInt(parameter.spi.ssNb.W))
+  val spi_sclk  = Output(Bool())
+  val spi_mosi  = Output(Bool())
+  val qspi_sck  = Output(Bool())
+  val qspi_ce_n = Output(Bool())
+  val qspi_dio  = Output(UInt(4.W))
+}
+
+/** A peripheral APB segment: [[SPI]] (MOSI looped back to MISO),
+  * [[QSPIPSRAMTop]] and an [[APBMemSlave]] behind one [[APBDecoder]].
+  *
+  * Address map (see [[PeripheralSubsystemTopParameter.slotBits]]):
+  *   - 0x0000_0000  QSPI: PSRAM, CSR window at + 0x0100_0000
+  *   - 0x0200_0000  SPI registers
+  *   - 0x0400_0000  generic slave
+  *
+  * APB carries one transfer at a time, so while one slave holds `pready`
+  * low (an SPI write during a transfer, a QSPI access waiting for the
+  * wire) every other slave's accesses wait behind it.
+  */
+@instantiable
+class PeripheralSubsystemTop(val parameter: PeripheralSubsystemTopParameter)
+    extends FixedIORawModule(new PeripheralSubsystemInterface(parameter))
+    with SerializableModule[PeripheralSubsystemTopParameter]
+    with ImplicitClock
+    with ImplicitReset {
+  override protected def implicitClock: Clock = io.clock
+  override protected def implicitReset: Reset = io.reset
+
+  private val P = parameter
+
+  val decoder = Module(new APBDecoder(3, P.slotBits))
+  val spi     = Module(new SPI(P.spi))
+  val qspi    = Module(new QSPIPSRAMTop(P.qspi))
+  val slave   = Module(new APBMemSlave(P.slave))
+
+  // Bridge side
+  decoder.io.in.paddr   := io.paddr
+  decoder.io.in.psel    := io.psel
+  decoder.io.in.penable := io.penable
+  decoder.io.in.pwrite  := io.pwrite
+  decoder.io.in.pstrb   := io.pstrb
+  decoder.io.in.pwdata  := io.pwdata
+  io.prdata             := decoder.io.in.prdata
+  io.pready             := decoder.io.in.pready
+  io.pslverr            := decoder.io.in.pslverr
+
+  // SPI
+  private val spiPort = decoder.io.out(P.spiSlot)
+  spi.io.clock     := io.clock
+  spi.io.reset     := io.reset
+  spi.io.paddr     := spiPort.paddr(P.spi.addrBits - 1, 0)
+  spi.io.psel      := spiPort.psel
+  spi.io.penable   := spiPort.penable
+  spi.io.pwrite    := spiPort.pwrite
+  spi.io.pstrb     := spiPort.pstrb
+  spi.io.pwdata    := spiPort.pwdata
+  spiPort.prdata   := spi.io.prdata
+  spiPort.pready   := spi.io.pready
+  spiPort.pslverr  := spi.io.pslverr
+  spi.io.misoPadI  := spi.io.mosiPadO
+  spi.io.trigI     := false.B
+  io.spiIntO       := spi.io.intO
+  io.spi_ss        := spi.io.ssPadO
+  io.spi_sclk      := spi.io.sclkPadO
+  io.spi_mosi      := spi.io.mosiPadO
+
+  // QSPI + PSRAM
+  private val qspiPort = decoder.io.out(P.qspiSlot)
+  qspi.io.clock     := io.clock
+  qspi.io.reset     := io.reset
+  qspi.io.paddr     := qspiPort.paddr
+  qspi.io.psel      := qspiPort.psel
+  qspi.io.penable   := qspiPort.penable
+  qspi.io.pwrite    := qspiPort.pwrite
+  qspi.io.pstrb     := qspiPort.pstrb
+  qspi.io.pwdata    := qspiPort.pwdata
+  qspiPort.prdata   := qspi.io.prdata
+  qspiPort.pready   := qspi.io.pready
+  qspiPort.pslverr  := qspi.io.pslverr
+  io.qspiIntO       := qspi.io.intO
+  io.qspi_sck       := qspi.io.qspi_sck
+  io.qspi_ce_n      := qspi.io.qspi_ce_n
+  io.qspi_dio       := qspi.io.qspi_dio
+
+  // Generic slave
+  slave.io <> decoder.io.out(P.slaveSlot)
+}
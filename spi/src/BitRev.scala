@@ -11,30 +11,26 @@ class SPIIO(ssNb: Int) extends Bundle {
   val ss   = Output(UInt(ssNb.W))
 }
 
-class BitRev extends RawModule {
-  val io = IO(Flipped(new SPIIO(1)))
-
-  val reset = io.ss.asBool.asAsyncReset
-  val clock = io.sck.asClock
-  val clockN = ( !io.sck ).asClock
-
-  val impl = withClockAndReset(clock, reset) { Module(new Impl) }
-  val miso = withClockAndReset(clockN, reset) { RegNext(impl.io.miso) }
+/** Bit-reverse slave logic: shifts in 8 bits, then shifts them back out
+  * LSB first. Advances one bit per cycle with `step` high; [[BitRev]]
+  * clocks it with SCK, [[BitRevSync]] with the system clock.
+  */
+class BitRevCore extends Module {
+  val io = IO(new Bundle {
+    val step = Input(Bool())
+    val miso = Output(Bool())
+    val mosi = Input(Bool())
+  })
 
-  class Impl extends Module with RequireAsyncReset {
-    val io = IO(new Bundle {
-      val miso = Output(Bool())
-      val mosi = Input(Bool())
-    })
-
-    object State extends ChiselEnum {
-      val Read, Write = Value
-    }
+  object State extends ChiselEnum {
+    val Read, Write = Value
+  }
 
-    val state   = RegInit(State.Read)
-    val counter = Counter(8)
-    val data    = RegInit(0.U(8.W))
+  val state   = RegInit(State.Read)
+  val counter = Counter(8)
+  val data    = RegInit(0.U(8.W))
 
+  when(io.step) {
     switch(state) {
       is(State.Read) {
         when(counter.inc()) {
@@ -49,10 +45,45 @@ class BitRev extends RawModule {
     }.otherwise {
       data := Cat(0.U(1.W), data(7, 1))
     }
-
-    io.miso := data(0)
   }
 
+  io.miso := data(0)
+}
+
+class BitRev extends RawModule {
+  val io = IO(Flipped(new SPIIO(1)))
+
+  val reset = io.ss.asBool.asAsyncReset
+  val clock = io.sck.asClock
+  val clockN = ( !io.sck ).asClock
+
+  val impl = withClockAndReset(clock, reset) { Module(new BitRevCore) }
+  val miso = withClockAndReset(clockN, reset) { RegNext(impl.io.miso) }
+
+  io.miso := Mux(io.ss.asBool, true.B, miso)
+  impl.io.step := true.B
+  impl.io.mosi := io.mosi
+}
+
+/** [[BitRev]] oversampled in the system clock domain.
+  *
+  * SCK and SS come from a master clocked by the same system clock, so they
+  * are edge-detected rather than used as clock and asynchronous reset.
+  * MISO is registered on the detected falling edge, which the master still
+  * samples in time for any divider >= 1.
+  */
+class BitRevSync extends Module {
+  val io = IO(Flipped(new SPIIO(1)))
+
+  val sckPrev  = RegNext(io.sck, false.B)
+  val rise     = io.sck && !sckPrev
+  val fall     = !io.sck && sckPrev
+  val deselect = reset.asBool || io.ss.asBool
+
+  val impl = withReset(deselect) { Module(new BitRevCore) }
+  val miso = RegEnable(impl.io.miso, fall)
+
   io.miso := Mux(io.ss.asBool, true.B, miso)
+  impl.io.step := rise
   impl.io.mosi := io.mosi
 }
@@ -9,6 +9,7 @@ import chisel3.experimental.hierarchy.{instantiable, public, Instance, Instantia
 import chisel3.experimental.{SerializableModule, SerializableModuleParameter}
 import chisel3.probe.{define, Probe, ProbeValue}
 import chisel3.properties.{AnyClassType, Class, Property}
+import org.chipsalliance.shared.{DataTransform, IntCoalesce}
 
 // ═══════════════════════════════════════════════════════════════════
 // Parameter
@@ -30,25 +31,111 @@ object SPIParameter {
   *   Number of slave-select lines (1–32).
   * @param useAsyncReset
   *   Use asynchronous reset when true.
+  * @param fixedCharLen
+  *   Pin CTRL.CHAR_LEN. `maxChar` must then be the smallest supported
+  *   width whose CHAR_LEN field encodes it, so the shift register
+  *   carries no more bits than needed.
+  * @param fixedMode
+  *   Pin CTRL[10:9] (RX_NEGEDGE, TX_NEGEDGE) to this 2-bit value.
+  * @param fixedLsb
+  *   Pin CTRL.LSB.
+  * @param fixedDivider
+  *   Pin DIVIDER, so the clock generator compares against a constant.
+  *
+  * A pinned field resets to its value, ignores writes and reads back
+  * the pinned value, so its flops only ever hold a constant that
+  * firtool may fold. `make report_spi_area` compares the two builds.
   */
 case class SPIParameter(
-  dividerLen:    Int     = 16,
-  maxChar:       Int     = 128,
-  ssNb:          Int     = 8,
-  useAsyncReset: Boolean = false
+  dividerLen:    Int             = 16,
+  maxChar:       Int             = 128,
+  ssNb:          Int             = 8,
+  useAsyncReset: Boolean         = false,
+  fixedCharLen:  Option[Int]     = None,
+  fixedMode:     Option[Int]     = None,
+  fixedLsb:      Option[Boolean] = None,
+  fixedDivider:  Option[Int]     = None
 ) extends SerializableModuleParameter {
   require(Seq(8, 16, 24, 32).contains(dividerLen), "dividerLen must be 8, 16, 24, or 32")
   require(Seq(8, 16, 24, 32, 64, 128).contains(maxChar), "maxChar must be 8, 16, 24, 32, 64, or 128")
   require(ssNb >= 1 && ssNb <= 32, "ssNb must be in 1..32")
+  fixedCharLen.foreach { l =>
+    val width = Seq(8, 16, 24, 32, 64, 128).find(w => l <= w && l < (1 << log2Ceil(w)))
+    require(l >= 1 && width.isDefined, "fixedCharLen must be in 1..127")
+    require(maxChar == width.get, s"fixedCharLen $l needs maxChar = ${width.get}")
+  }
+  require(fixedMode.forall(m => m >= 0 && m <= 3), "fixedMode must be in 0..3")
+  require(fixedDivider.forall(d => d >= 0 && d < (1L << dividerLen)), s"fixedDivider must fit in $dividerLen bits")
 
   /** Number of bits needed to encode the character length field. */
   val charLenBits: Int = log2Ceil(maxChar) // 7 for 128
 
+  /** Longest transfer CHAR_LEN can encode (0 means no transfer). */
+  val maxPayloadBits: Int = math.min(maxChar, (1 << charLenBits) - 1) // 127 for 128
+
   /** Number of 32-bit TX/RX data words. */
   val nTxWords: Int = (maxChar + 31) / 32 // 4 for 128
 
   /** Width of the control register. */
   val ctrlBitNb: Int = 14
+
+  /** CTRL bits pinned at elaboration time, and their values. */
+  val ctrlPinMask: BigInt =
+    fixedCharLen.fold(BigInt(0))(_ => (BigInt(1) << charLenBits) - 1) |
+      fixedMode.fold(BigInt(0))(_ => BigInt(3) << 9) |
+      fixedLsb.fold(BigInt(0))(_ => BigInt(1) << 11)
+  val ctrlPinValue: BigInt =
+    fixedCharLen.fold(BigInt(0))(BigInt(_)) |
+      fixedMode.fold(BigInt(0))(m => BigInt(m) << 9) |
+      fixedLsb.fold(BigInt(0))(b => BigInt(if (b) 1 else 0) << 11)
+
+  /** DIVIDER reset value: the pinned divider, or the slowest one. */
+  val dividerInit: BigInt = fixedDivider.fold((BigInt(1) << dividerLen) - 1)(BigInt(_))
+
+  /** Width of the APB byte address (`paddr[6:2]` selects one of 32 words). */
+  val addrBits: Int = 7
+
+  /** Width of INT_CTRL.THRESH and INT_STATUS.PENDING. */
+  val intCountBits: Int = 8
+
+  /** Width of INT_CTRL.TIMEOUT (cycles). */
+  val intTimerBits: Int = 16
+
+  /** Width of TRIG_PERIOD (cycles). */
+  val trigPeriodBits: Int = 32
+
+  /** Synchronizer stages on `trigI`. */
+  val trigSyncStages: Int = 2
+
+  /** Entries (RX_0 words) in the receive buffer of triggered transfers. */
+  val rxBufDepth: Int = 8
+
+  // ─── Timing model (exported through [[SPIOM]]) ──────────────
+  // One SCK half period lasts `divider + 1` system cycles. A transfer of
+  // `n` bits spans `2n` half periods plus the closing low phase before
+  // `tip` drops, and starts one cycle after the CTRL write that sets GO.
+
+  /** Cycles from the CTRL write that sets GO until `tip` rises. */
+  val goLatency: Int = 1
+
+  /** SCK half periods per transferred bit. */
+  val halfPeriodsPerBit: Int = 2
+
+  /** Trailing half periods after the last bit. */
+  val tailHalfPeriods: Int = 1
+
+  /** Cycles from `tip` falling to `intO` rising (same edge). */
+  val interruptLatency: Int = 0
+
+  /** Cycles from a rising edge on `trigI` until `tip` rises: the
+    * synchronizer, the edge detector setting GO, then [[goLatency]].
+    * A timer trigger skips the synchronizer.
+    */
+  val trigLatency: Int = trigSyncStages + 1 + goLatency
+
+  /** Cycles from the GO write until the end of a `bits`-bit transfer. */
+  def transferCycles(divider: Int, bits: Int): Int =
+    goLatency + (halfPeriodsPerBit * bits + tailHalfPeriods) * (divider + 1)
 }
 
 // ═══════════════════════════════════════════════════════════════════
@@ -65,7 +152,16 @@ class SPIProbe(parameter: SPIParameter) extends Bundle {
 // used to export metadata to downstream toolchains
 // ═══════════════════════════════════════════════════════════════════
 
-/** Metadata of [[SPI]]. */
+/** Metadata of [[SPI]].
+  *
+  * Besides the raw parameters, exports the timing model so integration
+  * tools can compute transfer cost without simulating:
+  * {{{
+  * cycles(divider, bits) = goLatency
+  *                       + (halfPeriodsPerBit * bits + tailHalfPeriods) * (divider + 1)
+  * }}}
+  * `sim_chisel_spi.cpp` checks measured cycles against this formula.
+  */
 @instantiable
 class SPIOM(parameter: SPIParameter) extends Class {
   val dividerLen:    Property[Int]     = IO(Output(Property[Int]()))
@@ -76,6 +172,33 @@ class SPIOM(parameter: SPIParameter) extends Class {
   maxChar       := Property(parameter.maxChar)
   ssNb          := Property(parameter.ssNb)
   useAsyncReset := Property(parameter.useAsyncReset)
+
+  // Derived performance characteristics
+  val maxPayloadBits:       Property[Int] = IO(Output(Property[Int]()))
+  val goLatency:            Property[Int] = IO(Output(Property[Int]()))
+  val halfPeriodsPerBit:    Property[Int] = IO(Output(Property[Int]()))
+  val tailHalfPeriods:      Property[Int] = IO(Output(Property[Int]()))
+  val interruptLatency:     Property[Int] = IO(Output(Property[Int]()))
+  val minCyclesPerTransfer: Property[Int] = IO(Output(Property[Int]()))
+  val maxIntThresh:         Property[Int] = IO(Output(Property[Int]()))
+  val maxIntTimeout:        Property[Int] = IO(Output(Property[Int]()))
+  val trigLatency:          Property[Int] = IO(Output(Property[Int]()))
+  val rxBufDepth:           Property[Int] = IO(Output(Property[Int]()))
+  maxPayloadBits       := Property(parameter.maxPayloadBits)
+  goLatency            := Property(parameter.goLatency)
+  halfPeriodsPerBit    := Property(parameter.halfPeriodsPerBit)
+  tailHalfPeriods      := Property(parameter.tailHalfPeriods)
+  interruptLatency     := Property(parameter.interruptLatency)
+  // Longest transfer at divider 0, or at the pinned length / divider
+  minCyclesPerTransfer := Property(
+    parameter.transferCycles(parameter.fixedDivider.getOrElse(0), parameter.fixedCharLen.getOrElse(parameter.maxPayloadBits))
+  )
+  // Interrupt moderation limits (INT_CTRL)
+  maxIntThresh         := Property((1 << parameter.intCountBits) - 1)
+  maxIntTimeout        := Property((1 << parameter.intTimerBits) - 1)
+  // Triggered transfers (TRIG_CTRL)
+  trigLatency          := Property(parameter.trigLatency)
+  rxBufDepth           := Property(parameter.rxBufDepth)
 }
 
 // ═══════════════════════════════════════════════════════════════════
@@ -88,7 +211,7 @@ class SPIInterface(parameter: SPIParameter) extends Bundle {
   val reset = Input(if (parameter.useAsyncReset) AsyncReset() else Bool())
 
   // APB slave
-  val paddr   = Input(UInt(5.W))
+  val paddr   = Input(UInt(parameter.addrBits.W))
   val psel    = Input(Bool())
   val penable = Input(Bool())
   val pwrite  = Input(Bool())
@@ -105,6 +228,9 @@ class SPIInterface(parameter: SPIParameter) extends Bundle {
   val mosiPadO = Output(Bool())
   val misoPadI = Input(Bool())
 
+  // Transfer trigger (asynchronous, rising edge, see TRIG_CTRL)
+  val trigI = Input(Bool())
+
   // Verification & metadata
   val probe = Output(Probe(new SPIProbe(parameter), layers.Verification))
   val om    = Output(Property[AnyClassType]())
@@ -119,12 +245,17 @@ class SPIInterface(parameter: SPIParameter) extends Bundle {
   * Divides the system clock by `2*(divider+1)` to produce `clkOut`.
   * Also generates single-cycle `posEdge` / `negEdge` strobes one
   * system-clock cycle before the corresponding edge of `clkOut`.
+  *
+  * `pause` stops SCK mid-transfer: a high phase in progress completes,
+  * then the generator freezes with `clkOut` low and issues no strobes
+  * until `pause` drops, and carries on exactly where it stopped.
   */
 class SPIClgen(dividerLen: Int) extends Module {
   val io = IO(new Bundle {
     val go      = Input(Bool())
     val tip  = Input(Bool())
     val lastClk = Input(Bool())
+    val pause   = Input(Bool())
     val divider = Input(UInt(dividerLen.W))
     val clkOut  = Output(Bool())
     val posEdge = Output(Bool())
@@ -139,8 +270,14 @@ class SPIClgen(dividerLen: Int) extends Module {
   val cntOne  = cnt === 1.U
   val divZero = !io.divider.orR
 
+  // Pause only takes hold while SCK is low; the strobe registers keep
+  // their value so the edge that was due is issued on resume
+  val stall = io.tip && io.pause && !clkOut
+
   // Counter counts half period
-  when(!io.tip || cntZero) {
+  when(stall) {
+    // hold
+  }.elsewhen(!io.tip || cntZero) {
     cnt := io.divider
   }.otherwise {
     cnt := cnt - 1.U
@@ -149,24 +286,29 @@ class SPIClgen(dividerLen: Int) extends Module {
   // clk_out toggles every other half period
   // ( !io.lastCLK || clkOut ) <=> ( io.lastClk -> clkOut )
   // 如果是最后一次, 那么只有当 clkOut = 1 时, 才翻转, 这意味着最后一次永远是 1->0
-  when(io.tip && cntZero && (!io.lastClk || clkOut)) {
+  when(!stall && io.tip && cntZero && (!io.lastClk || clkOut)) {
     clkOut := ~clkOut
   }
 
   // Positive-edge / negative-edge strobes (registered)
-  io.posEdge := RegNext(
+  val posEdge = RegEnable(
     (io.tip && !clkOut && cntOne) ||
       (divZero && clkOut) ||
       (divZero && io.go && !io.tip),
-    false.B
+    false.B,
+    !stall
   )
 
-  io.negEdge := RegNext(
+  val negEdge = RegEnable(
     (io.tip && clkOut && cntOne) ||
       (divZero && !clkOut && io.tip),
-    false.B
+    false.B,
+    !stall
   )
 
+  io.posEdge := posEdge && !stall
+  io.negEdge := negEdge && !stall
+
   io.clkOut := clkOut
 }
 
@@ -188,6 +330,7 @@ class SPIShift(parameter: SPIParameter) extends Module {
     val latch     = Input(UInt(4.W)) // per-word load enable
     val byteSel   = Input(UInt(4.W)) // byte-lane strobes
     val len       = Input(UInt(cBits.W)) // charLen (0 = no transfer)
+    val txXform   = Input(UInt(DataTransform.width.W)) // applied at transfer start
     val go        = Input(Bool())
     val posEdge   = Input(Bool())
     val negEdge   = Input(Bool())
@@ -202,7 +345,7 @@ class SPIShift(parameter: SPIParameter) extends Module {
 
   // ─── State ──────────────────────────────────────────────────
   val cnt  = RegInit(0.U(cBits.W)) // bit counter
-  val data = RegInit(VecInit(Seq.fill(mChar)(false.B))) // shift register
+  val data = RegInit(0.U(mChar.W)) // shift register
   val sOut = RegInit(false.B)
   val tip  = RegInit(false.B)
 
@@ -218,6 +361,11 @@ class SPIShift(parameter: SPIParameter) extends Module {
   val txClk = io.negEdge && !last
   dontTouch(txClk)
 
+  // TX transform: the register holds the data as written until the
+  // transfer starts, then the transformed image is shifted out
+  val start  = io.go && !tip && io.len.orR
+  val txView = DataTransform(data, io.txXform)
+
   // ─── Bit counter ────────────────────────────────────────────
   when(tip) {
     when(io.posEdge) { cnt := cnt - 1.U }
@@ -226,7 +374,7 @@ class SPIShift(parameter: SPIParameter) extends Module {
   }
 
   // ─── Transfer in progress ──────────────────────────────────
-  when(io.go && !tip && io.len.orR) {
+  when(start) {
     tip := true.B
   }.elsewhen(tip && last && io.posEdge) {
     tip := false.B
@@ -234,7 +382,7 @@ class SPIShift(parameter: SPIParameter) extends Module {
 
   // ─── TX: send bits to line ─────────────────────────────────
   when(txClk || !tip) {
-    sOut := data(txBitPos)
+    sOut := Mux(tip, data(txBitPos), txView(txBitPos))
   }
 
   // ─── Data register: parallel load / serial receive ─────────
@@ -242,31 +390,31 @@ class SPIShift(parameter: SPIParameter) extends Module {
   // CTRL 放到了 SPI(Top) 中, 而 data 放到了 SPIShift 中, Rxx/Txx 是 data 的两种访问方式
   // io.latch 是 word mask, 因为 apb 一次只能传输 32bit, 所以 io.latch 是 one-hot 的
   // io.byteSel 是 byte mask
+  // 整个寄存器按 word / byte 掩码更新, 而不是逐 bit 赋值
+  private val byteMask = FillInterleaved(8, io.byteSel)
+  private val loaded = Cat((0 until parameter.nTxWords).reverse.map { wordIdx =>
+    // maxChar is whole bytes, so a short last word only has whole lanes
+    val lo   = wordIdx * 32
+    val hi   = math.min(mChar, lo + 32)
+    val mask = Mux(io.latch(wordIdx), byteMask(hi - lo - 1, 0), 0.U)
+    (data(hi - 1, lo) & ~mask) | (io.pIn(hi - lo - 1, 0) & mask)
+  })
+  private val rxBit = UIntToOH(rxBitPos, mChar)
+
   when(!tip && io.latch.orR) {
     // Parallel load from bus (byte-lane writes to each 32-bit word)
-    for (wordIdx <- 0 until parameter.nTxWords) { // 0,1,2,3
-      when(io.latch(wordIdx)) {
-        for (byteIdx <- 0 until 4) { // 0,1,2,3. each word is 32 bits, so 4 bytes
-          // Guard: only generate logic for bytes within data width
-          if ((wordIdx * 32 + (byteIdx + 1) * 8) <= mChar) {
-            when(io.byteSel(byteIdx)) {
-              for (bitIdx <- 0 until 8) { // 逐 bit 写入
-                data(wordIdx * 32 + byteIdx * 8 + bitIdx) := io.pIn(byteIdx * 8 + bitIdx)
-              }
-            }
-          }
-        }
-      }
-    }
+    data := loaded
+  }.elsewhen(start) {
+    data := txView
   }.otherwise {
     // Serial receive: sample MISO at rxBitPos
     when(rxClk) {
-      data(rxBitPos) := io.sIn
+      data := (data & ~rxBit) | Mux(io.sIn, rxBit, 0.U)
     }
   }
 
   // ─── Outputs ────────────────────────────────────────────────
-  io.pOut := data.asUInt
+  io.pOut := data
   io.tip  := tip
   io.last := last
   io.sOut := sOut
@@ -278,7 +426,7 @@ class SPIShift(parameter: SPIParameter) extends Module {
 
 /** Hardware Implementation of SPI Master with APB slave interface.
   *
-  * Register map (byte address → word offset via `paddr[4:2]`):
+  * Register map (byte address → word offset via `paddr[6:2]`):
   *   - 0: TX_0 / RX_0  (bits  31:0   of shift register)
   *   - 1: TX_1 / RX_1  (bits  63:32)
   *   - 2: TX_2 / RX_2  (bits  95:64)
@@ -286,6 +434,18 @@ class SPIShift(parameter: SPIParameter) extends Module {
   *   - 4: CTRL
   *   - 5: DIVIDER
   *   - 6: SS
+  *   - 7: INT_CTRL
+  *   - 8: INT_STATUS
+  *   - 9: XFORM
+  *   - 10: SHADOW
+  *   - 11: TRIG_CTRL
+  *   - 12: TRIG_PERIOD
+  *   - 13: TRIG_TX
+  *   - 14: RX_BUF
+  *   - 15: CMP_CTRL
+  *   - 16: CMP_EXP
+  *   - 17: CMP_MASK
+  *   - 18: CMP_STAT
   *
   * CTRL register layout:
   *   - [charLenBits-1:0]  CHAR_LEN   character length (0 = no transfer)
@@ -296,6 +456,76 @@ class SPIShift(parameter: SPIParameter) extends Module {
   *   - [11]               LSB        send LSB first
   *   - [12]               IE         interrupt enable
   *   - [13]               ASS        automatic slave select
+  *
+  * INT_CTRL register layout (interrupt moderation, see [[IntCoalesce]]):
+  *   - [7:0]    THRESH   completed transfers per interrupt. 0 keeps the
+  *                       original behaviour: one interrupt per transfer,
+  *                       cleared by any APB access
+  *   - [31:16]  TIMEOUT  raise the interrupt this many cycles after the
+  *                       first unacknowledged completion even if THRESH
+  *                       is not reached (0 = off)
+  *
+  * INT_STATUS register layout (THRESH != 0; intO = CNT | TMO):
+  *   - [0]      CNT      THRESH completions reached (write 1 to clear)
+  *   - [1]      TMO      TIMEOUT expired (write 1 to clear)
+  *   - [15:8]   PENDING  completions since the last acknowledge; writing
+  *                       1 to CNT or TMO restarts it from 0
+  *
+  * Completions are only counted while CTRL.IE is set.
+  *
+  * XFORM register layout (see [[DataTransform]] for the 4-bit fields):
+  *   - [3:0]    TX  applied to the whole shift register when GO starts a
+  *                  transfer, so TX_x reads back the transformed data
+  *   - [11:8]   RX  applied when RX_x is read
+  * Byte swaps work on shift register bytes, so CHAR_LEN should be a
+  * multiple of the swap granularity.
+  *
+  * SHADOW register layout (locked during tip):
+  *   - [0]  EN       CTRL/DIVIDER/SS writes go to shadow copies and never
+  *                   stall. The shadows commit together at the next CTRL
+  *                   write that sets GO while idle, or when the running
+  *                   transfer completes. Reads return the active values.
+  *                   Clearing EN drops uncommitted values.
+  *   - [1]  AUTO_GO  a GO written during a transfer starts the next one
+  *                   right after the commit (the shift register keeps
+  *                   the received data); without it the GO is dropped
+  *   - [8]  PENDING  read-only, the shadows hold uncommitted values
+  *
+  * Triggered transfers: the period timer (every TRIG_PERIOD cycles, 0
+  * behaves as 1) or a rising edge on `trigI` starts the transfer set up
+  * in CTRL without a GO write. TX_0 is reloaded from TRIG_TX first and
+  * RX_0 (after XFORM) is pushed into RX_BUF at the end, so sampling runs
+  * without the CPU; combine with CTRL.IE and INT_CTRL.THRESH for one
+  * interrupt per batch. The start latency is fixed (see
+  * [[SPIParameter.trigLatency]]). TRIG_* and RX_BUF are accessible
+  * during a transfer; TX_0 writes while triggers are enabled may be lost.
+  *
+  * TRIG_CTRL register layout:
+  *   - [0]      TIMER_EN  start a transfer every TRIG_PERIOD cycles
+  *   - [1]      EXT_EN    start a transfer on a `trigI` rising edge
+  *   - [8]      MISS      trigger while busy, dropped (write 1 to clear)
+  *   - [9]      OVF       result while RX_BUF was full, dropped (write 1
+  *                        to clear)
+  *   - [23:16]  RX_LEVEL  words in RX_BUF
+  *
+  * RX_BUF: a read pops the oldest result (0 when empty).
+  *
+  * RX compare: at the end of every transfer the received CHAR_LEN bits
+  * (after XFORM.RX) are checked against CMP_EXP under CMP_MASK, both
+  * repeated over every 32-bit word of the shift register, so a verify
+  * pass needs no RX reads. CMP_EXP is taken when the transfer starts
+  * and may be rewritten for the next one while it runs. While
+  * CMP_CTRL.EN is set, intO means FAIL only; completions do not
+  * interrupt. CMP_* are accessible during a transfer.
+  *
+  * CMP_CTRL register layout:
+  *   - [0]  EN    compare received data
+  *   - [1]  FAIL  a compared transfer mismatched (write 1 to clear)
+  *
+  * CMP_STAT register layout (read-only, kept until FAIL is cleared):
+  *   - [7:0]    BIT   lowest mismatching bit of the failing transfer
+  *   - [31:16]  XFER  index of the failing transfer, counted from the
+  *                    write that set EN
   */
 @instantiable
 class SPI(val parameter: SPIParameter)
@@ -309,11 +539,31 @@ class SPI(val parameter: SPIParameter)
   private val P = parameter
 
   // ─── Registers ──────────────────────────────────────────────
-  val divider = RegInit(((1L << P.dividerLen) - 1).U(P.dividerLen.W))
-  val ctrl    = RegInit(0.U(P.ctrlBitNb.W))
+  val divider = RegInit(P.dividerInit.U(P.dividerLen.W))
+  val ctrl    = RegInit(P.ctrlPinValue.U(P.ctrlBitNb.W))
   val ss      = RegInit(0.U(P.ssNb.W))
   val intReg  = RegInit(false.B)
 
+  val intThresh  = RegInit(0.U(P.intCountBits.W))
+  val intTimeout = RegInit(0.U(P.intTimerBits.W))
+
+  val txXform = RegInit(0.U(DataTransform.width.W))
+  val rxXform = RegInit(0.U(DataTransform.width.W))
+
+  val shadowEn   = RegInit(false.B)
+  val autoGo     = RegInit(false.B)
+  val staged     = RegInit(false.B) // shadows differ from the active registers
+  val divShadow  = RegInit(P.dividerInit.U(P.dividerLen.W))
+  val ctrlShadow = RegInit(P.ctrlPinValue.U(P.ctrlBitNb.W))
+  val ssShadow   = RegInit(0.U(P.ssNb.W))
+
+  // Every write of bus data into CTRL / DIVIDER (and their shadows) goes
+  // through these, so pinned bits never leave their reset value
+  private def pinCtrl(x: UInt): UInt =
+    if (P.ctrlPinMask == 0) x
+    else (x & (~P.ctrlPinMask & ((BigInt(1) << P.ctrlBitNb) - 1)).U(P.ctrlBitNb.W)) | P.ctrlPinValue.U(P.ctrlBitNb.W)
+  private def pinDivider(x: UInt): UInt = P.fixedDivider.fold(x)(_.U(P.dividerLen.W))
+
   // ─── Ctrl field extraction ─────────────────────────────────
   val charLen   = ctrl(P.charLenBits - 1, 0)
   val go        = ctrl(8)
@@ -321,7 +571,7 @@ class SPI(val parameter: SPIParameter)
   val ass       = ctrl(13)
 
   // ─── APB decode ─────────────────────────────────────────────
-  val regAddr  = io.paddr(4, 2) // byte address → word offset
+  val regAddr  = io.paddr(P.addrBits - 1, 2) // byte address → word offset
   val regWrite = io.psel & io.penable & io.pwrite
 
   io.pslverr := false.B
@@ -330,6 +580,17 @@ class SPI(val parameter: SPIParameter)
   val spiDividerSel = io.psel & (regAddr === 5.U)
   val spiCtrlSel    = io.psel & (regAddr === 4.U)
   val spiSsSel      = io.psel & (regAddr === 6.U)
+  val intCtrlSel    = io.psel & (regAddr === 7.U)
+  val intStatusSel  = io.psel & (regAddr === 8.U)
+  val xformSel      = io.psel & (regAddr === 9.U)
+  val shadowSel     = io.psel & (regAddr === 10.U)
+  val trigCtrlSel   = io.psel & (regAddr === 11.U)
+  val trigPeriodSel = io.psel & (regAddr === 12.U)
+  val trigTxSel     = io.psel & (regAddr === 13.U)
+  val rxBufSel      = io.psel & (regAddr === 14.U)
+  val cmpCtrlSel    = io.psel & (regAddr === 15.U)
+  val cmpExpSel     = io.psel & (regAddr === 16.U)
+  val cmpMaskSel    = io.psel & (regAddr === 17.U)
   val spiTxSel      = VecInit((0 until 4).map(i => io.psel & (regAddr === i.U)))
 
   // ─── Sub-modules ────────────────────────────────────────────
@@ -340,34 +601,161 @@ class SPI(val parameter: SPIParameter)
   val lastBit = shift.io.last
   val posEdge = clgen.io.posEdge
   val negEdge = clgen.io.negEdge
-  val rx      = shift.io.pOut // maxChar-bit receive data
+  val rx      = DataTransform(shift.io.pOut, rxXform) // maxChar-bit receive data
 
   // Flow control during SPI transfer (tip=1):
   //   - Writes to any register:  blocked (pready=0), otherwise silently dropped.
   //   - Reads of TX/RX data (addr 0-3): blocked (pready=0), shift register
   //     is actively changing and would return torn/inconsistent data.
-  //   - Reads of CTRL/DIVIDER/SS (addr 4-6): allowed (pready=1),
+  //   - Reads of CTRL/DIVIDER/SS/XFORM (addr 4-6, 9): allowed (pready=1),
   //     so software can poll CTRL GO bit to know when transfer finishes.
-  val isTxAddr = regAddr < 4.U
-  io.pready := !tip || (!io.pwrite && !isTxAddr)
+  //   - INT_CTRL/INT_STATUS (addr 7-8): always allowed, they do not affect
+  //     the transfer and an interrupt handler may run during one.
+  //   - CTRL/DIVIDER/SS writes with SHADOW.EN: allowed, they are staged.
+  //   - TRIG_*/RX_BUF/CMP_* (addr 11-18): always allowed, triggered
+  //     transfers keep the shift register busy most of the time.
+  val isTxAddr   = regAddr < 4.U
+  val isIntReg   = regAddr === 7.U || regAddr === 8.U
+  val isCfgAddr  = regAddr >= 4.U && regAddr <= 6.U
+  val isTrigAddr = regAddr >= 11.U && regAddr <= 18.U
+  io.pready := !tip || (!io.pwrite && !isTxAddr) || isIntReg || isTrigAddr || (shadowEn && isCfgAddr)
+
+  // ─── Triggered transfers ───────────────────────────────────
+  val timerEn    = RegInit(false.B)
+  val extEn      = RegInit(false.B)
+  val trigMiss   = RegInit(false.B)
+  val trigOvf    = RegInit(false.B)
+  val trigPeriod = RegInit(0.U(P.trigPeriodBits.W))
+  val trigTx     = RegInit(0.U(32.W))
+  val trigXfer   = RegInit(false.B) // the running transfer was triggered
+
+  val timerCnt  = RegInit(0.U(P.trigPeriodBits.W))
+  val timerFire = timerEn && !timerCnt.orR
+  when(!timerEn || timerFire) {
+    timerCnt := Mux(trigPeriod.orR, trigPeriod - 1.U, 0.U)
+  }.otherwise {
+    timerCnt := timerCnt - 1.U
+  }
+
+  val trigSync  = ShiftRegister(io.trigI, P.trigSyncStages, false.B, true.B)
+  val trigPrev  = RegNext(trigSync, false.B)
+  val trigEvent = timerFire || (extEn && trigSync && !trigPrev)
+  // A CTRL write in the same cycle wins; the trigger counts as missed
+  val trigFire  = trigEvent && !tip && !go && !(regWrite && spiCtrlSel)
+  when(trigFire) {
+    ctrl     := ctrl | (1 << 8).U(P.ctrlBitNb.W)
+    trigXfer := true.B
+  }
+  when(trigEvent && !trigFire) {
+    trigMiss := true.B
+  }.elsewhen(regWrite && trigCtrlSel && io.pstrb(1) && io.pwdata(8)) {
+    trigMiss := false.B
+  }
 
   // Clgen connections
   clgen.io.go      := go
   clgen.io.tip  := tip
   clgen.io.lastClk := lastBit
+  clgen.io.pause   := false.B // the shift register holds the whole transfer
   clgen.io.divider := divider
 
   // Shift connections
   shift.io.len       := charLen
-  shift.io.latch     := spiTxSel.asUInt & Fill(4, io.penable & io.pwrite)
-  shift.io.byteSel   := io.pstrb
+  shift.io.txXform   := txXform
+  shift.io.latch     := Mux(trigFire, 1.U, spiTxSel.asUInt & Fill(4, io.penable & io.pwrite))
+  shift.io.byteSel   := Mux(trigFire, 0xf.U, io.pstrb)
   shift.io.go        := go
   shift.io.posEdge   := posEdge
   shift.io.negEdge   := negEdge
-  shift.io.pIn       := io.pwdata
+  shift.io.pIn       := Mux(trigFire, trigTx, io.pwdata)
   shift.io.sClk      := clgen.io.clkOut
   shift.io.sIn       := io.misoPadI
 
+  // ─── Interrupt ──────────────────────────────────────────────
+  val xferDone  = tip && lastBit && posEdge
+  val legacyInt = !intThresh.orR
+
+  when(ie && xferDone) {
+    intReg := true.B
+  }.elsewhen(io.psel && io.penable) { // reset
+    intReg := false.B
+  }
+
+  val coalesce = Module(new IntCoalesce(P.intCountBits, P.intTimerBits))
+  coalesce.io.event   := ie && xferDone && !legacyInt
+  coalesce.io.thresh  := intThresh
+  coalesce.io.timeout := intTimeout
+  coalesce.io.ack     := Mux(regWrite && intStatusSel && io.pstrb(0), io.pwdata(1, 0), 0.U)
+
+  // ─── RX compare ─────────────────────────────────────────────
+  val cmpEn   = RegInit(false.B)
+  val cmpFail = RegInit(false.B)
+  val cmpExp  = RegInit(0.U(32.W))
+  val cmpMask = RegInit("hffffffff".U(32.W))
+  val cmpCur  = RegInit(0.U(32.W))  // CMP_EXP of the running transfer
+  val cmpCnt  = RegInit(0.U(16.W))  // transfers compared since EN was set
+  val cmpBit  = RegInit(0.U(8.W))
+  val cmpXfer = RegInit(0.U(16.W))
+
+  when(go && !tip) { cmpCur := cmpExp }
+  val lenMask = Mux(charLen.orR, ((1.U << charLen) - 1.U)(P.maxChar - 1, 0), Fill(P.maxChar, 1.U(1.W)))
+  val cmpDiff = (rx ^ Fill(P.nTxWords, cmpCur)(P.maxChar - 1, 0)) &
+    Fill(P.nTxWords, cmpMask)(P.maxChar - 1, 0) & lenMask
+  when(cmpEn && xferDone) {
+    cmpCnt := cmpCnt + 1.U
+    when(cmpDiff.orR && !cmpFail) {
+      cmpFail := true.B
+      cmpBit  := PriorityEncoder(cmpDiff)
+      cmpXfer := cmpCnt
+    }
+  }
+  when(regWrite && cmpCtrlSel && io.pstrb(0)) {
+    when(io.pwdata(0) && !cmpEn) { cmpCnt := 0.U }
+    cmpEn := io.pwdata(0)
+    when(io.pwdata(1)) { cmpFail := false.B }
+  }
+  when(regWrite && cmpExpSel) {
+    val mask = Cat((0 until 4).reverse.map(j => Fill(8, io.pstrb(j))))
+    cmpExp := (io.pwdata & mask) | (cmpExp & ~mask)
+  }
+  when(regWrite && cmpMaskSel) {
+    val mask = Cat((0 until 4).reverse.map(j => Fill(8, io.pstrb(j))))
+    cmpMask := (io.pwdata & mask) | (cmpMask & ~mask)
+  }
+
+  io.intO := Mux(cmpEn, cmpFail, Mux(legacyInt, intReg, coalesce.io.cause.orR))
+
+  // ─── Receive buffer (triggered transfers) ──────────────────
+  val rxBuf = Module(new Queue(UInt(32.W), P.rxBufDepth))
+  rxBuf.io.enq.valid := xferDone && trigXfer
+  rxBuf.io.enq.bits  := rx.pad(32)(31, 0)
+  rxBuf.io.deq.ready := io.psel && io.penable && !io.pwrite && rxBufSel
+  when(xferDone) { trigXfer := false.B }
+
+  when(rxBuf.io.enq.valid && !rxBuf.io.enq.ready) {
+    trigOvf := true.B
+  }.elsewhen(regWrite && trigCtrlSel && io.pstrb(1) && io.pwdata(9)) {
+    trigOvf := false.B
+  }
+  when(regWrite && trigCtrlSel && io.pstrb(0)) {
+    timerEn := io.pwdata(0)
+    extEn   := io.pwdata(1)
+  }
+  when(regWrite && trigPeriodSel) {
+    val mask = Cat((0 until 4).reverse.map(j => Fill(8, io.pstrb(j))))
+    trigPeriod := (io.pwdata & mask) | (trigPeriod & ~mask)
+  }
+  when(regWrite && trigTxSel) {
+    val mask = Cat((0 until 4).reverse.map(j => Fill(8, io.pstrb(j))))
+    trigTx := (io.pwdata & mask) | (trigTx & ~mask)
+  }
+
+  when(regWrite && intCtrlSel) {
+    when(io.pstrb(0)) { intThresh := io.pwdata(7, 0) }
+    val mask = Cat(Fill(8, io.pstrb(3)), Fill(8, io.pstrb(2)))
+    intTimeout := (io.pwdata(31, 16) & mask) | (intTimeout & ~mask)
+  }
+
   // ─── Read mux (combinational) ──────────────────────────────
   val prdataMux = WireDefault(0.U(32.W))
   for (i <- 0 until P.nTxWords) { // 0,1,2,3
@@ -384,38 +772,92 @@ class SPI(val parameter: SPIParameter)
   when(regAddr === 4.U) { prdataMux := ctrl.pad(32) }
   when(regAddr === 5.U) { prdataMux := divider.pad(32) }
   when(regAddr === 6.U) { prdataMux := ss.pad(32) }
-  io.prdata := prdataMux
-
-  // ─── Interrupt ──────────────────────────────────────────────
-  when(ie && tip && lastBit && posEdge) {
-    intReg := true.B
-  }.elsewhen(io.psel && io.penable) { // reset
-    intReg := false.B
+  when(regAddr === 7.U) { prdataMux := Cat(intTimeout, 0.U(8.W), intThresh) }
+  when(regAddr === 8.U) { prdataMux := Cat(0.U(16.W), coalesce.io.pending, 0.U(6.W), coalesce.io.cause) }
+  when(regAddr === 9.U) { prdataMux := Cat(rxXform, 0.U(4.W), txXform).pad(32) }
+  when(regAddr === 10.U) { prdataMux := Cat(staged, 0.U(6.W), autoGo, shadowEn).pad(32) }
+  when(regAddr === 11.U) {
+    prdataMux := Cat(rxBuf.io.count.pad(8), 0.U(6.W), trigOvf, trigMiss, 0.U(6.W), extEn, timerEn).pad(32)
   }
-  io.intO := intReg
+  when(regAddr === 12.U) { prdataMux := trigPeriod }
+  when(regAddr === 13.U) { prdataMux := trigTx }
+  when(regAddr === 14.U) { prdataMux := Mux(rxBuf.io.deq.valid, rxBuf.io.deq.bits, 0.U) }
+  when(regAddr === 15.U) { prdataMux := Cat(cmpFail, cmpEn).pad(32) }
+  when(regAddr === 16.U) { prdataMux := cmpExp }
+  when(regAddr === 17.U) { prdataMux := cmpMask }
+  when(regAddr === 18.U) { prdataMux := Cat(cmpXfer, 0.U(8.W), cmpBit) }
+  io.prdata := prdataMux
 
   // ─── Divider register (byte-lane write, locked during tip) ─
-  when(regWrite && spiDividerSel && !tip) {
-    val nBytes = P.dividerLen / 8 // 2
-    val mask   = Cat((0 until nBytes).reverse/*1,0*/.map(j => Fill(8, io.pstrb(j))))
-    divider := (io.pwdata(P.dividerLen - 1, 0) & mask) | (divider & ~mask)
+  val nBytes  = P.dividerLen / 8 // 2
+  val divMask = Cat((0 until nBytes).reverse/*1,0*/.map(j => Fill(8, io.pstrb(j))))
+  when(regWrite && spiDividerSel && !tip && !shadowEn) {
+    divider := pinDivider((io.pwdata(P.dividerLen - 1, 0) & divMask) | (divider & ~divMask))
   }
 
   // ─── Ctrl register ─────────────────────────────────────────
-  when(regWrite && spiCtrlSel && !tip) {
-    val fullMask = Cat(Fill(8, io.pstrb(1)), Fill(8, io.pstrb(0)))
-    val mask     = fullMask(P.ctrlBitNb - 1, 0)
-    ctrl := (io.pwdata(P.ctrlBitNb - 1, 0) & mask) | (ctrl & ~mask)
+  val goMask   = (1 << 8).U(P.ctrlBitNb.W)
+  val ctrlMask = Cat(Fill(8, io.pstrb(1)), Fill(8, io.pstrb(0)))(P.ctrlBitNb - 1, 0)
+  when(regWrite && spiCtrlSel && !tip && !shadowEn) {
+    ctrl := pinCtrl((io.pwdata(P.ctrlBitNb - 1, 0) & ctrlMask) | (ctrl & ~ctrlMask))
   }.elsewhen(tip && lastBit && posEdge) {
     // Auto-clear GO bit at end of transfer
-    ctrl := ctrl & ~(1 << 8).U(P.ctrlBitNb.W)
+    ctrl := ctrl & ~goMask
+  }
+
+  // ─── Transform register (locked during tip) ────────────────
+  when(regWrite && xformSel && !tip) {
+    when(io.pstrb(0)) { txXform := io.pwdata(3, 0) }
+    when(io.pstrb(1)) { rxXform := io.pwdata(11, 8) }
   }
 
   // ─── Slave select register (single-byte write) ─────────────
-  when(regWrite && spiSsSel && !tip) {
+  when(regWrite && spiSsSel && !tip && !shadowEn) {
     when(io.pstrb(0)) { ss := io.pwdata(P.ssNb - 1, 0) }
   }
 
+  // ─── Shadow registers ──────────────────────────────────────
+  // Writes merge into the staged value, or into the active one when
+  // nothing is staged (GO is never inherited from the active CTRL).
+  val divBase  = Mux(staged, divShadow, divider)
+  val ctrlBase = Mux(staged, ctrlShadow, ctrl & ~goMask)
+  val ssBase   = Mux(staged, ssShadow, ss)
+  val divNext  = WireDefault(divBase)
+  val ctrlNext = WireDefault(ctrlBase)
+  val ssNext   = WireDefault(ssBase)
+
+  val shadowWr = regWrite && shadowEn
+  when(shadowWr && spiDividerSel) {
+    divNext := pinDivider((io.pwdata(P.dividerLen - 1, 0) & divMask) | (divBase & ~divMask))
+  }
+  when(shadowWr && spiCtrlSel) {
+    ctrlNext := pinCtrl((io.pwdata(P.ctrlBitNb - 1, 0) & ctrlMask) | (ctrlBase & ~ctrlMask))
+  }
+  when(shadowWr && spiSsSel && io.pstrb(0)) {
+    ssNext := io.pwdata(P.ssNb - 1, 0)
+  }
+  divShadow  := divNext
+  ctrlShadow := ctrlNext
+  ssShadow   := ssNext
+
+  val cfgWrite   = shadowWr && (spiDividerSel || spiCtrlSel || spiSsSel)
+  val commitGo   = shadowWr && spiCtrlSel && !tip && ctrlNext(8)
+  val commitDone = xferDone && (staged || cfgWrite)
+  when(commitGo || commitDone) {
+    divider := divNext
+    ss      := ssNext
+    ctrl    := Mux(commitGo || autoGo, ctrlNext, ctrlNext & ~goMask)
+    staged  := false.B
+  }.elsewhen(cfgWrite) {
+    staged := true.B
+  }
+
+  when(regWrite && shadowSel && !tip && io.pstrb(0)) {
+    shadowEn := io.pwdata(0)
+    autoGo   := io.pwdata(1)
+    when(!io.pwdata(0)) { staged := false.B }
+  }
+
   // ─── SPI outputs ────────────────────────────────────────────
   io.sclkPadO := clgen.io.clkOut
   io.mosiPadO := shift.io.sOut
@@ -427,6 +869,20 @@ class SPI(val parameter: SPIParameter)
   define(io.probe, ProbeValue(probeWire))
   probeWire.tip := tip
 
+  // ─── Latency bound (performance regression guard) ──────────
+  // A transfer must not outlast the timing model published by [[SPIOM]]:
+  // (2 * charLen + 1) SCK half periods of (divider + 1) cycles each.
+  layer.block(layers.Verification) {
+    val tipCycles = RegInit(0.U(32.W))
+    tipCycles := Mux(tip, tipCycles + 1.U, 0.U)
+
+    val measured = tipCycles + 1.U
+    val allowed  = (P.halfPeriodsPerBit.U * charLen + P.tailHalfPeriods.U) * (divider +& 1.U)
+    when(tip && lastBit && posEdge) {
+      assert(measured <= allowed, cf"SPI transfer latency bound exceeded: measured $measured cycles, allowed $allowed")
+    }
+  }
+
   // ─── Object Model ──────────────────────────────────────────
   val omInstance: Instance[SPIOM] = Instantiate(new SPIOM(parameter))
   io.om := omInstance.getPropertyReference.asAnyClassType
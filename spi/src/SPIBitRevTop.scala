@@ -3,12 +3,30 @@ package org.chipsalliance.spi
 
 import chisel3._
 import chisel3.experimental.hierarchy.instantiable
-import chisel3.experimental.SerializableModule
+import chisel3.experimental.{SerializableModule, SerializableModuleParameter}
 
-class SPIBitRevInterface(parameter: SPIParameter) extends Bundle {
+object SPIBitRevTopParameter {
+  implicit def rwP: upickle.default.ReadWriter[SPIBitRevTopParameter] =
+    upickle.default.macroRW
+}
+
+/** Parameter of [[SPIBitRevTop]].
+  *
+  * @param spi
+  *   The SPI master.
+  * @param oversample
+  *   Use [[BitRevSync]] (SCK / SS edge-detected in the system clock)
+  *   instead of the SCK-clocked [[BitRev]].
+  */
+case class SPIBitRevTopParameter(
+  spi:        SPIParameter = SPIParameter(),
+  oversample: Boolean      = false
+) extends SerializableModuleParameter
+
+class SPIBitRevInterface(parameter: SPIBitRevTopParameter) extends Bundle {
   val clock = Input(Clock())
-  val reset = Input(if (parameter.useAsyncReset) AsyncReset() else Bool())
-  val paddr   = Input(UInt(5.W))
+  val reset = Input(if (parameter.spi.useAsyncReset) AsyncReset() else Bool())
+  val paddr   = Input(UInt(parameter.spi.addrBits.W))
   val psel    = Input(Bool())
   val penable = Input(Bool())
   val pwrite  = Input(Bool())
@@ -18,23 +36,23 @@ class SPIBitRevInterface(parameter: SPIParameter) extends Bundle {
   val pready  = Output(Bool())
   val pslverr = Output(Bool())
   val intO    = Output(Bool())
-  val ssPadO   = Output(UInt(parameter.ssNb.W))
+  val ssPadO   = Output(UInt(parameter.spi.ssNb.W))
   val sclkPadO = Output(Bool())
   val mosiPadO = Output(Bool())
   val misoPadO = Output(Bool())
 }
 
 @instantiable
-class SPIBitRevTop(val parameter: SPIParameter)
+class SPIBitRevTop(val parameter: SPIBitRevTopParameter)
     extends FixedIORawModule(new SPIBitRevInterface(parameter))
-    with SerializableModule[SPIParameter]
+    with SerializableModule[SPIBitRevTopParameter]
     with ImplicitClock
     with ImplicitReset {
   override protected def implicitClock: Clock = io.clock
   override protected def implicitReset: Reset = io.reset
 
-  val spi    = Module(new SPI(parameter))
-  val bitrev = Module(new BitRev)
+  val spi    = Module(new SPI(parameter.spi))
+  val bitrev = if (parameter.oversample) Module(new BitRevSync).io else Module(new BitRev).io
 
   spi.io.clock := io.clock
   spi.io.reset := io.reset
@@ -50,13 +68,14 @@ class SPIBitRevTop(val parameter: SPIParameter)
   io.pslverr     := spi.io.pslverr
   io.intO        := spi.io.intO
 
-  bitrev.io.sck  := spi.io.sclkPadO
-  bitrev.io.mosi := spi.io.mosiPadO
-  bitrev.io.ss   := spi.io.ssPadO(0)
-  spi.io.misoPadI := bitrev.io.miso
+  bitrev.sck  := spi.io.sclkPadO
+  bitrev.mosi := spi.io.mosiPadO
+  bitrev.ss   := spi.io.ssPadO(0)
+  spi.io.misoPadI := bitrev.miso
+  spi.io.trigI    := false.B
 
   io.ssPadO   := spi.io.ssPadO
   io.sclkPadO := spi.io.sclkPadO
   io.mosiPadO := spi.io.mosiPadO
-  io.misoPadO := bitrev.io.miso
+  io.misoPadO := bitrev.miso
 }
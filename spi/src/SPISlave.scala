@@ -0,0 +1,295 @@
+// SPDX-License-Identifier: Unlicense
+// SPI slave (device) controller with APB register interface and FIFOs
+
+package org.chipsalliance.spi
+
+import chisel3._
+import chisel3.util._
+import chisel3.experimental.hierarchy.{instantiable, Instance, Instantiate}
+import chisel3.experimental.{SerializableModule, SerializableModuleParameter}
+import chisel3.properties.{AnyClassType, Class, Property}
+
+// ═══════════════════════════════════════════════════════════════════
+// Parameter
+// ═══════════════════════════════════════════════════════════════════
+
+object SPISlaveParameter {
+  implicit def rwP: upickle.default.ReadWriter[SPISlaveParameter] =
+    upickle.default.macroRW
+}
+
+/** Parameter of [[SPISlave]].
+  *
+  * @param fifoDepth
+  *   Entries (bytes) in each of the TX and RX FIFOs (2–128).
+  * @param useAsyncReset
+  *   Use asynchronous reset when true.
+  */
+case class SPISlaveParameter(
+  fifoDepth:     Int     = 16,
+  useAsyncReset: Boolean = false
+) extends SerializableModuleParameter {
+  require(fifoDepth >= 2 && fifoDepth <= 128, "fifoDepth must be in 2..128")
+
+  /** Synchronizer stages on SCK / CS_N / MOSI. */
+  val syncStages: Int = 2
+
+  /** Smallest master divider (SCK = clk / (2 * (divider + 1))) the slave
+    * keeps up with. Every SCK level must last at least two system cycles
+    * for the edge detector, and MISO is advanced within one SCK period.
+    */
+  val minSckDivider: Int = 1
+}
+
+// ═══════════════════════════════════════════════════════════════════
+// Object Model (metadata)
+// ═══════════════════════════════════════════════════════════════════
+
+/** Metadata of [[SPISlave]]. */
+@instantiable
+class SPISlaveOM(parameter: SPISlaveParameter) extends Class {
+  val fifoDepth:     Property[Int]     = IO(Output(Property[Int]()))
+  val useAsyncReset: Property[Boolean] = IO(Output(Property[Boolean]()))
+  val syncStages:    Property[Int]     = IO(Output(Property[Int]()))
+  val minSckDivider: Property[Int]     = IO(Output(Property[Int]()))
+  fifoDepth     := Property(parameter.fifoDepth)
+  useAsyncReset := Property(parameter.useAsyncReset)
+  syncStages    := Property(parameter.syncStages)
+  minSckDivider := Property(parameter.minSckDivider)
+}
+
+// ═══════════════════════════════════════════════════════════════════
+// Interface
+// ═══════════════════════════════════════════════════════════════════
+
+/** APB slave port of [[SPISlave]]. */
+class SPISlaveAPB extends Bundle {
+  val paddr   = Input(UInt(5.W))
+  val psel    = Input(Bool())
+  val penable = Input(Bool())
+  val pwrite  = Input(Bool())
+  val pstrb   = Input(UInt(4.W))
+  val pwdata  = Input(UInt(32.W))
+  val prdata  = Output(UInt(32.W))
+  val pready  = Output(Bool())
+  val pslverr = Output(Bool())
+}
+
+/** Interface of [[SPISlave]]. */
+class SPISlaveInterface(parameter: SPISlaveParameter) extends Bundle {
+  val clock = Input(Clock())
+  val reset = Input(if (parameter.useAsyncReset) AsyncReset() else Bool())
+
+  val apb  = new SPISlaveAPB
+  val intO = Output(Bool())
+
+  // DMA handshake (level, dropped by the FIFO accesses that serve it)
+  val txDmaReq = Output(Bool())
+  val rxDmaReq = Output(Bool())
+
+  // SPI device pins (asynchronous to `clock`)
+  val sckPadI  = Input(Bool())
+  val csNPadI  = Input(Bool())
+  val mosiPadI = Input(Bool())
+  val misoPadO = Output(Bool())
+  val misoOeO  = Output(Bool())
+
+  val om = Output(Property[AnyClassType]())
+}
+
+// ═══════════════════════════════════════════════════════════════════
+// SPI Slave
+// ═══════════════════════════════════════════════════════════════════
+
+/** SPI slave controller, mode 0 (CPOL=0, CPHA=0), 8-bit frames, MSB first.
+  *
+  * The pins are oversampled by the system clock: SCK, CS_N and MOSI go
+  * through the same two-stage synchronizer, so MOSI is sampled exactly as
+  * it was at the SCK rising edge. MISO is advanced right after a rising
+  * edge is detected (instead of waiting for the falling edge), which gives
+  * the master a full SCK period of setup and lets the slave run with the
+  * master divider at [[SPISlaveParameter.minSckDivider]].
+  *
+  * Register map (byte address → word offset via `paddr[4:2]`):
+  *   - 0: DATA    W: push TX byte (pready stalls while TX is full)
+  *                R: pop RX byte; bit 8 set (and no pop) when RX is empty
+  *   - 1: STATUS  see below; RX_OVF / TX_UDR are write-1-to-clear
+  *   - 2: CTRL
+  *   - 3: THRESH
+  *
+  * STATUS register layout:
+  *   - [0]      TX_FULL
+  *   - [1]      TX_EMPTY
+  *   - [2]      RX_FULL
+  *   - [3]      RX_EMPTY
+  *   - [4]      CS_ACTIVE  (synchronized)
+  *   - [8]      RX_OVF     byte received while RX was full (dropped)
+  *   - [9]      TX_UDR     byte started with nothing loaded (sent 0x00)
+  *   - [23:16]  TX_LEVEL
+  *   - [31:24]  RX_LEVEL
+  *
+  * CTRL register layout:
+  *   - [0]  RX_IE      interrupt while RX_LEVEL >= RX_THRESH
+  *   - [1]  TX_IE      interrupt while TX_LEVEL <= TX_THRESH
+  *   - [2]  ERR_IE     interrupt while RX_OVF or TX_UDR
+  *   - [3]  RX_DMA_EN  drive `rxDmaReq` with the RX condition
+  *   - [4]  TX_DMA_EN  drive `txDmaReq` with the TX condition
+  *
+  * THRESH register layout:
+  *   - [7:0]   RX_THRESH (0 behaves as 1)
+  *   - [15:8]  TX_THRESH
+  */
+@instantiable
+class SPISlave(val parameter: SPISlaveParameter)
+    extends FixedIORawModule(new SPISlaveInterface(parameter))
+    with SerializableModule[SPISlaveParameter]
+    with ImplicitClock
+    with ImplicitReset {
+  override protected def implicitClock: Clock = io.clock
+  override protected def implicitReset: Reset = io.reset
+
+  private val P   = parameter
+  private val apb = io.apb
+
+  // ─── Registers ──────────────────────────────────────────────
+  val ctrl     = RegInit(0.U(5.W))
+  val rxThresh = RegInit(1.U(8.W))
+  val txThresh = RegInit(0.U(8.W))
+  val rxOvf    = RegInit(false.B)
+  val txUdr    = RegInit(false.B)
+
+  val rxIe    = ctrl(0)
+  val txIe    = ctrl(1)
+  val errIe   = ctrl(2)
+  val rxDmaEn = ctrl(3)
+  val txDmaEn = ctrl(4)
+
+  val txFifo = Module(new Queue(UInt(8.W), P.fifoDepth))
+  val rxFifo = Module(new Queue(UInt(8.W), P.fifoDepth))
+
+  // ─── Pin synchronizers ─────────────────────────────────────
+  val sck  = ShiftRegister(io.sckPadI, P.syncStages, false.B, true.B)
+  val csN  = ShiftRegister(io.csNPadI, P.syncStages, true.B, true.B)
+  val mosi = ShiftRegister(io.mosiPadI, P.syncStages, false.B, true.B)
+
+  val sckPrev  = RegNext(sck, false.B)
+  val csActive = !csN
+  val rise     = csActive && sck && !sckPrev
+
+  // ─── Serial engine ─────────────────────────────────────────
+  val bitCnt   = RegInit(0.U(3.W))
+  val rxShift  = RegInit(0.U(7.W))
+  val txShift  = RegInit(0.U(8.W))
+  val txLoaded = RegInit(false.B) // txShift holds a byte not yet started
+
+  val byteDone = rise && bitCnt === 7.U
+  val rxByte   = Cat(rxShift, mosi)
+
+  // Fill txShift between bytes; at a byte boundary the next byte must be
+  // in place before the following rising edge, so it is taken on the same
+  // edge that completes the current one.
+  val loadGap = !rise && bitCnt === 0.U && !txLoaded
+  txFifo.io.deq.ready := loadGap || byteDone
+
+  when(!csActive) {
+    bitCnt := 0.U
+  }.elsewhen(rise) {
+    bitCnt  := bitCnt + 1.U
+    rxShift := rxByte(6, 0)
+  }
+
+  when(txFifo.io.deq.fire) {
+    txShift  := txFifo.io.deq.bits
+    txLoaded := true.B
+  }.elsewhen(byteDone) {
+    txShift  := 0.U
+    txLoaded := false.B
+  }.elsewhen(rise) {
+    txShift  := (txShift << 1)(7, 0)
+    txLoaded := false.B
+  }
+
+  rxFifo.io.enq.valid := byteDone
+  rxFifo.io.enq.bits  := rxByte
+
+  // ─── APB decode ─────────────────────────────────────────────
+  val regAddr  = apb.paddr(4, 2)
+  val access   = apb.psel && apb.penable
+  val regWrite = access && apb.pwrite
+  val regRead  = access && !apb.pwrite
+
+  val dataSel   = regAddr === 0.U
+  val statusSel = regAddr === 1.U
+  val ctrlSel   = regAddr === 2.U
+  val threshSel = regAddr === 3.U
+
+  txFifo.io.enq.valid := regWrite && dataSel
+  txFifo.io.enq.bits  := apb.pwdata(7, 0)
+  rxFifo.io.deq.ready := regRead && dataSel
+
+  apb.pready  := !(dataSel && apb.pwrite && !txFifo.io.enq.ready)
+  apb.pslverr := false.B
+
+  // ─── Status / error flags ──────────────────────────────────
+  when(byteDone && !rxFifo.io.enq.ready) {
+    rxOvf := true.B
+  }.elsewhen(regWrite && statusSel && apb.pstrb(1) && apb.pwdata(8)) {
+    rxOvf := false.B
+  }
+  when(rise && bitCnt === 0.U && !txLoaded) {
+    txUdr := true.B
+  }.elsewhen(regWrite && statusSel && apb.pstrb(1) && apb.pwdata(9)) {
+    txUdr := false.B
+  }
+
+  val txLevel = txFifo.io.count
+  val rxLevel = rxFifo.io.count
+  val status = Cat(
+    rxLevel.pad(8),
+    txLevel.pad(8),
+    0.U(6.W),
+    txUdr,
+    rxOvf,
+    0.U(3.W),
+    csActive,
+    !rxFifo.io.deq.valid,
+    !rxFifo.io.enq.ready,
+    !txFifo.io.deq.valid,
+    !txFifo.io.enq.ready
+  )
+
+  // ─── Control registers ─────────────────────────────────────
+  when(regWrite && ctrlSel && apb.pstrb(0)) {
+    ctrl := apb.pwdata(4, 0)
+  }
+  when(regWrite && threshSel) {
+    when(apb.pstrb(0)) { rxThresh := apb.pwdata(7, 0) }
+    when(apb.pstrb(1)) { txThresh := apb.pwdata(15, 8) }
+  }
+
+  // ─── Read mux ──────────────────────────────────────────────
+  val prdataMux = WireDefault(0.U(32.W))
+  when(dataSel) {
+    prdataMux := Mux(rxFifo.io.deq.valid, rxFifo.io.deq.bits.pad(32), 0x100.U)
+  }
+  when(statusSel) { prdataMux := status }
+  when(ctrlSel) { prdataMux := ctrl.pad(32) }
+  when(threshSel) { prdataMux := Cat(txThresh, rxThresh).pad(32) }
+  apb.prdata := prdataMux
+
+  // ─── Interrupt / DMA requests ──────────────────────────────
+  val rxReady = rxLevel >= Mux(rxThresh.orR, rxThresh, 1.U)
+  val txSpace = txLevel <= txThresh
+
+  io.rxDmaReq := rxDmaEn && rxReady
+  io.txDmaReq := txDmaEn && txSpace
+  io.intO     := (rxIe && rxReady) || (txIe && txSpace) || (errIe && (rxOvf || txUdr))
+
+  // ─── SPI outputs ────────────────────────────────────────────
+  io.misoPadO := txShift(7)
+  io.misoOeO  := csActive
+
+  // ─── Object Model ──────────────────────────────────────────
+  val omInstance: Instance[SPISlaveOM] = Instantiate(new SPISlaveOM(parameter))
+  io.om := omInstance.getPropertyReference.asAnyClassType
+}
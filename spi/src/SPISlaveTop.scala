@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: Unlicense
+package org.chipsalliance.spi
+
+import chisel3._
+import chisel3.experimental.hierarchy.instantiable
+import chisel3.experimental.{SerializableModule, SerializableModuleParameter}
+
+object SPISlaveTopParameter {
+  implicit def rwP: upickle.default.ReadWriter[SPISlaveTopParameter] =
+    upickle.default.macroRW
+}
+
+/** Parameter of [[SPISlaveTop]]: the master plus the slave FIFO depth
+  * (the slave shares the master's reset type).
+  */
+case class SPISlaveTopParameter(
+  spi:       SPIParameter = SPIParameter(),
+  fifoDepth: Int          = 16
+) extends SerializableModuleParameter {
+  val slave: SPISlaveParameter = SPISlaveParameter(fifoDepth, spi.useAsyncReset)
+}
+
+class SPISlaveTopInterface(parameter: SPISlaveTopParameter) extends Bundle {
+  val clock = Input(Clock())
+  val reset = Input(if (parameter.spi.useAsyncReset) AsyncReset() else Bool())
+
+  // APB of the SPI master
+  val paddr   = Input(UInt(parameter.spi.addrBits.W))
+  val psel    = Input(Bool())
+  val penable = Input(Bool())
+  val pwrite  = Input(Bool())
+  val pstrb   = Input(UInt(4.W))
+  val pwdata  = Input(UInt(32.W))
+  val prdata  = Output(UInt(32.W))
+  val pready  = Output(Bool())
+  val pslverr = Output(Bool())
+  val intO    = Output(Bool())
+
+  // APB of the SPI slave
+  val slave         = new SPISlaveAPB
+  val slaveIntO     = Output(Bool())
+  val slaveTxDmaReq = Output(Bool())
+  val slaveRxDmaReq = Output(Bool())
+
+  // Debug outputs
+  val ssPadO   = Output(UInt(parameter.spi.ssNb.W))
+  val sclkPadO = Output(Bool())
+  val mosiPadO = Output(Bool())
+  val misoPadO = Output(Bool())
+}
+
+/** [[SPI]] master wired to an [[SPISlave]] on slave select 0. Both sides
+  * are programmed over their own APB port.
+  */
+@instantiable
+class SPISlaveTop(val parameter: SPISlaveTopParameter)
+    extends FixedIORawModule(new SPISlaveTopInterface(parameter))
+    with SerializableModule[SPISlaveTopParameter]
+    with ImplicitClock
+    with ImplicitReset {
+  override protected def implicitClock: Clock = io.clock
+  override protected def implicitReset: Reset = io.reset
+
+  val spi   = Module(new SPI(parameter.spi))
+  val slave = Module(new SPISlave(parameter.slave))
+
+  spi.io.clock   := io.clock
+  spi.io.reset   := io.reset
+  slave.io.clock := io.clock
+  slave.io.reset := io.reset
+
+  spi.io.paddr   := io.paddr
+  spi.io.psel    := io.psel
+  spi.io.penable := io.penable
+  spi.io.pwrite  := io.pwrite
+  spi.io.pstrb   := io.pstrb
+  spi.io.pwdata  := io.pwdata
+  io.prdata      := spi.io.prdata
+  io.pready      := spi.io.pready
+  io.pslverr     := spi.io.pslverr
+  io.intO        := spi.io.intO
+
+  slave.io.apb     <> io.slave
+  io.slaveIntO     := slave.io.intO
+  io.slaveTxDmaReq := slave.io.txDmaReq
+  io.slaveRxDmaReq := slave.io.rxDmaReq
+
+  slave.io.sckPadI  := spi.io.sclkPadO
+  slave.io.csNPadI  := spi.io.ssPadO(0)
+  slave.io.mosiPadI := spi.io.mosiPadO
+  // Pulled up while the slave is deselected
+  val miso = Mux(slave.io.misoOeO, slave.io.misoPadO, true.B)
+  spi.io.misoPadI := miso
+  spi.io.trigI    := false.B
+
+  io.ssPadO   := spi.io.ssPadO
+  io.sclkPadO := spi.io.sclkPadO
+  io.mosiPadO := spi.io.mosiPadO
+  io.misoPadO := miso
+}